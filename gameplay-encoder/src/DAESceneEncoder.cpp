@@ -361,7 +361,7 @@ void DAESceneEncoder::write(const std::string& filepath, const EncoderArguments&
     {
         fprintf(stderr, "Saving binary file: %s\n", outputFilePath.c_str());
         begin();
-        if (!_gamePlayFile.saveBinary(outputFilePath))
+        if (!_gamePlayFile.saveBinary(outputFilePath, arguments.compressedOutputEnabled()))
         {
             fprintf(stderr,"Error writing binary file: %s\n", outputFilePath.c_str());
         }
@@ -15,9 +15,11 @@ static EncoderArguments* __instance;
 
 EncoderArguments::EncoderArguments(size_t argc, const char** argv) :
     _fontSize(0),
+    _quantization(QUANTIZE_NONE),
     _parseError(false),
     _fontPreview(false),
     _textOutput(false),
+    _compressedOutput(false),
     _daeOutput(false),
     _isHeightmapHighP(false)
 {
@@ -185,6 +187,13 @@ void EncoderArguments::printUsage() const
     fprintf(stderr,"COLLADA and FBX file options:\n");
     fprintf(stderr,"  -i <id>\t\tFilter by node ID.\n");
     fprintf(stderr,"  -t\t\t\tWrite text/xml.\n");
+    fprintf(stderr,"  -z\t\t\tCompress the objects of the binary file.\n");
+    fprintf(stderr,"  -q\t\t\tQuantize all vertex attributes below.\n" \
+        "\t\t\tUse -qp, -qn, -qt or -qw to only quantize positions (16-bit),\n" \
+        "\t\t\tnormals, tangents and binormals (8-bit), texture coordinates\n" \
+        "\t\t\t(16-bit, if within [0,1]) or blend weights (8-bit).\n" \
+        "\t\t\tQuantized positions only reduce the file size, as they are\n" \
+        "\t\t\texpanded to floats when the bundle is loaded.\n");
     fprintf(stderr,"  -g <node id> <animation id>\n" \
         "\t\t\tGroup all animation channels targeting the nodes into a new animation.\n");
     fprintf(stderr,"  -h \"<node ids>\"\n" \
@@ -209,11 +218,21 @@ bool EncoderArguments::textOutputEnabled() const
     return _textOutput;
 }
 
+bool EncoderArguments::compressedOutputEnabled() const
+{
+    return _compressedOutput;
+}
+
 bool EncoderArguments::DAEOutputEnabled() const
 {
     return _daeOutput;
 }
 
+unsigned int EncoderArguments::getQuantization() const
+{
+    return _quantization;
+}
+
 const char* EncoderArguments::getNodeId() const
 {
     if (_nodeId.length() == 0)
@@ -350,6 +369,18 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
     case 'p':
         _fontPreview = true;
         break;
+    case 'q':
+        if (str.compare("-q") == 0)
+            _quantization = QUANTIZE_ALL;
+        else if (str.compare("-qp") == 0)
+            _quantization |= QUANTIZE_POSITIONS;
+        else if (str.compare("-qn") == 0)
+            _quantization |= QUANTIZE_NORMALS;
+        else if (str.compare("-qt") == 0)
+            _quantization |= QUANTIZE_TEXCOORDS;
+        else if (str.compare("-qw") == 0)
+            _quantization |= QUANTIZE_BLENDWEIGHTS;
+        break;
     case 's':
         // Font Size
 
@@ -380,6 +411,9 @@ void EncoderArguments::readOption(const std::vector<std::string>& options, size_
     case 't':
         _textOutput = true;
         break;
+    case 'z':
+        _compressedOutput = true;
+        break;
     default:
         break;
     }
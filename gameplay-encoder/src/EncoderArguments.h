@@ -20,6 +20,19 @@ public:
         FILEFORMAT_GPB
     };
 
+    /**
+     * The vertex attributes that can be quantized.
+     */
+    enum Quantization
+    {
+        QUANTIZE_NONE = 0,
+        QUANTIZE_POSITIONS = 1,
+        QUANTIZE_NORMALS = 2,
+        QUANTIZE_TEXCOORDS = 4,
+        QUANTIZE_BLENDWEIGHTS = 8,
+        QUANTIZE_ALL = 15
+    };
+
     /**
      * Constructor.
      */
@@ -99,8 +112,18 @@ public:
 
     bool fontPreviewEnabled() const;
     bool textOutputEnabled() const;
+
+    /**
+     * Returns true if the binary file is to be written with compressed data.
+     */
+    bool compressedOutputEnabled() const;
     bool DAEOutputEnabled() const;
 
+    /**
+     * Returns the vertex attributes to quantize, as a combination of Quantization flags.
+     */
+    unsigned int getQuantization() const;
+
     const char* getNodeId() const;
     unsigned int getFontSize() const;
 
@@ -139,10 +162,12 @@ private:
     std::string _daeOutputPath;
 
     unsigned int _fontSize;
+    unsigned int _quantization;
 
     bool _parseError;
     bool _fontPreview;
     bool _textOutput;
+    bool _compressedOutput;
     bool _daeOutput;
     bool _isHeightmapHighP;
 
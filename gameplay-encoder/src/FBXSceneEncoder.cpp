@@ -248,7 +248,7 @@ void FBXSceneEncoder::write(const std::string& filepath, const EncoderArguments&
     else
     {
         fprintf(stderr, "Saving binary file: %s\n", outputFilePath.c_str());
-        if (!_gamePlayFile.saveBinary(outputFilePath))
+        if (!_gamePlayFile.saveBinary(outputFilePath, arguments.compressedOutputEnabled()))
         {
             fprintf(stderr,"Error writing binary file: %s\n", outputFilePath.c_str());
         }
@@ -2,9 +2,14 @@
 #include "GPBFile.h"
 #include "Transform.h"
 #include "StringUtil.h"
+#include "EncoderArguments.h"
+#include <zlib.h>
 
 #define EPSILON 1.2e-7f;
 
+// Chunks of compressed binary files are merged with the following chunk until they reach this size.
+#define GPB_MIN_CHUNK_SIZE 4096
+
 namespace gameplay
 {
 
@@ -50,7 +55,7 @@ GPBFile* GPBFile::getInstance()
     return __instance;
 }
 
-bool GPBFile::saveBinary(const std::string& filepath)
+bool GPBFile::saveBinary(const std::string& filepath, bool compressed)
 {
     _file = fopen(filepath.c_str(), "w+b");
     if (!_file)
@@ -80,6 +85,7 @@ bool GPBFile::saveBinary(const std::string& filepath)
 
     // write refs
     _refTable.writeBinary(_file);
+    long headerSize = ftell(_file);
 
     // meshes
     write(_geometry.size(), _file);
@@ -96,11 +102,109 @@ bool GPBFile::saveBinary(const std::string& filepath)
     }
 
     _refTable.updateOffsets(_file);
+
+    if (compressed)
+    {
+        // The reference offsets are kept as offsets into the uncompressed data.
+        return compressBinary(filepath, headerSize);
+    }
     
     fclose(_file);
     return true;
 }
 
+bool GPBFile::compressBinary(const std::string& filepath, long headerSize)
+{
+    // Read back the uncompressed file.
+    fseek(_file, 0, SEEK_END);
+    long size = ftell(_file);
+    std::vector<unsigned char> data(size);
+    fseek(_file, 0, SEEK_SET);
+    size_t n = fread(&data[0], 1, size, _file);
+    fclose(_file);
+    if (n != (size_t)size || headerSize > size)
+    {
+        return false;
+    }
+
+    // Chunks start at the objects that are loaded on their own.
+    std::vector<unsigned int> starts;
+    for (std::map<std::string, Reference>::iterator i = _refTable.begin(); i != _refTable.end(); ++i)
+    {
+        starts.push_back(i->second.getObj()->getFilePosition());
+    }
+    for (std::list<Mesh*>::const_iterator i = _geometry.begin(); i != _geometry.end(); ++i)
+    {
+        starts.push_back((*i)->getFilePosition());
+    }
+    for (std::list<Object*>::const_iterator i = _objects.begin(); i != _objects.end(); ++i)
+    {
+        starts.push_back((*i)->getFilePosition());
+    }
+    for (unsigned int i = 0; i < _animations.getAnimationCount(); ++i)
+    {
+        starts.push_back(_animations.getAnimation(i)->getFilePosition());
+    }
+    std::sort(starts.begin(), starts.end());
+
+    // Split the data, merging small objects with the ones that follow them.
+    std::vector<unsigned int> chunkOffsets;
+    chunkOffsets.push_back((unsigned int)headerSize);
+    for (size_t i = 0; i < starts.size(); ++i)
+    {
+        if (starts[i] >= chunkOffsets.back() + GPB_MIN_CHUNK_SIZE && starts[i] < (unsigned int)size)
+        {
+            chunkOffsets.push_back(starts[i]);
+        }
+    }
+    chunkOffsets.push_back((unsigned int)size);
+    unsigned int chunkCount = chunkOffsets.size() - 1;
+
+    std::vector<std::vector<unsigned char> > chunks(chunkCount);
+    for (unsigned int i = 0; i < chunkCount; ++i)
+    {
+        uLong chunkSize = chunkOffsets[i + 1] - chunkOffsets[i];
+        uLongf compressedSize = compressBound(chunkSize);
+        chunks[i].resize(compressedSize);
+        if (compress2(&chunks[i][0], &compressedSize, &data[chunkOffsets[i]], chunkSize, Z_BEST_COMPRESSION) != Z_OK)
+        {
+            return false;
+        }
+        chunks[i].resize(compressedSize);
+    }
+
+    _file = fopen(filepath.c_str(), "wb");
+    if (!_file)
+    {
+        return false;
+    }
+
+    // The header is unchanged apart from the version that follows the identifier.
+    memcpy(&data[9], GPB_COMPRESSED_VERSION, sizeof(GPB_COMPRESSED_VERSION));
+    fwrite(&data[0], 1, headerSize, _file);
+
+    // Chunk table: the offset and size of each chunk in the uncompressed data,
+    // followed by its offset and size in this file.
+    write(chunkCount, _file);
+    unsigned int fileOffset = (unsigned int)headerSize + sizeof(unsigned int) + chunkCount * 4 * sizeof(unsigned int);
+    for (unsigned int i = 0; i < chunkCount; ++i)
+    {
+        write(chunkOffsets[i], _file);
+        write(chunkOffsets[i + 1] - chunkOffsets[i], _file);
+        write(fileOffset, _file);
+        write((unsigned int)chunks[i].size(), _file);
+        fileOffset += chunks[i].size();
+    }
+    for (unsigned int i = 0; i < chunkCount; ++i)
+    {
+        fwrite(&chunks[i][0], 1, chunks[i].size(), _file);
+    }
+
+    bool result = ferror(_file) == 0;
+    fclose(_file);
+    return result;
+}
+
 bool GPBFile::saveText(const std::string& filepath)
 {
     _file = fopen(filepath.c_str(), "w");
@@ -303,6 +407,28 @@ void GPBFile::adjust()
         }
     }
 
+    // Heightmaps use the first triangle hit in index order, so meshes that a heightmap
+    // is generated from keep their original order to produce the same heightmap.
+    std::vector<Mesh*> heightmapMeshes;
+    const std::vector<std::string>& heightmapNodes = EncoderArguments::getInstance()->getHeightmapNodeIds();
+    for (std::list<Node*>::const_iterator i = _nodes.begin(); i != _nodes.end(); ++i)
+    {
+        Model* model = (*i)->getModel();
+        if (model && model->getMesh() && std::find(heightmapNodes.begin(), heightmapNodes.end(), (*i)->getId()) != heightmapNodes.end())
+        {
+            heightmapMeshes.push_back(model->getMesh());
+        }
+    }
+
+    // reorder triangles and vertices for the post-transform vertex cache and vertex fetch
+    for (std::list<Mesh*>::const_iterator i = _geometry.begin(); i != _geometry.end(); ++i)
+    {
+        if (std::find(heightmapMeshes.begin(), heightmapMeshes.end(), *i) == heightmapMeshes.end())
+        {
+            (*i)->optimize();
+        }
+    }
+
     for (std::list<Node*>::const_iterator i = _nodes.begin(); i != _nodes.end(); ++i)
     {
         computeBounds(*i);
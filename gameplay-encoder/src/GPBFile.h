@@ -23,6 +23,12 @@ namespace gameplay
  */
 const unsigned char GPB_VERSION[2] = {1, 2};
 
+/**
+ * The version of compressed binary files, whose data is stored as zlib compressed chunks.
+ * Uncompressed, the data is the same as that of a GPB_VERSION file.
+ */
+const unsigned char GPB_COMPRESSED_VERSION[2] = {1, 3};
+
 /**
  * The GamePlay Binary file class handles writing the GamePlay Binary file.
  */
@@ -49,10 +55,11 @@ public:
      * Saves the GPBFile as a binary file at filepath.
      *
      * @param filepath The file name and path to save to.
+     * @param compressed True to store the objects as independently compressed chunks.
      * 
      * @return True if successful, false if error.
      */
-    bool saveBinary(const std::string& filepath);
+    bool saveBinary(const std::string& filepath, bool compressed = false);
 
     /**
      * Saves the GPBFile as a text file at filepath. Useful for debugging.
@@ -116,6 +123,19 @@ public:
     void renameAnimations(std::vector<std::string>& animationIds, const char* newId);
 
 private:
+    /**
+     * Rewrites the binary file that was just written to _file with its data compressed.
+     *
+     * The header and reference table are kept as is. The data that follows is split into
+     * chunks that start at referenced objects, and each chunk is compressed on its own.
+     *
+     * @param filepath The file name and path of the binary file.
+     * @param headerSize The size of the header, including the reference table.
+     * 
+     * @return True if successful, false if error.
+     */
+    bool compressBinary(const std::string& filepath, long headerSize);
+
     /**
      * Computes the bounds of all meshes in the node hierarchy.
      */
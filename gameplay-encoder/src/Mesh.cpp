@@ -1,6 +1,25 @@
 #include "Base.h"
 #include "Mesh.h"
 #include "Model.h"
+#include "EncoderArguments.h"
+
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// Margin added around the triangles binned into the heightmap grid, so that rays
+// that hit a triangle's edge within rounding error still find it.
+#define HEIGHTMAP_GRID_MARGIN 0.01f
+
+// Upper bound on the number of threads that generate heightmaps.
+#define HEIGHTMAP_MAX_THREADS 16
 
 namespace gameplay
 {
@@ -27,13 +46,22 @@ void Mesh::writeBinary(FILE* file)
 {
     Object::writeBinary(file);
     // vertex formats
-    write(_vertexFormat.size(), file);
-    for (std::vector<VertexElement>::iterator i = _vertexFormat.begin(); i != _vertexFormat.end(); i++)
+    std::vector<VertexElement> format;
+    Vector3 positionMin, positionMax;
+    quantizeVertexFormat(&format, &positionMin, &positionMax);
+    write(format.size(), file);
+    for (std::vector<VertexElement>::iterator i = format.begin(); i != format.end(); i++)
     {
         i->writeBinary(file);
+        // Quantized positions are followed by the range they map to.
+        if (i->usage == POSITION && i->type != VertexElement::FLOAT)
+        {
+            write(&positionMin.x, 3, file);
+            write(&positionMax.x, 3, file);
+        }
     }
     // vertices
-    writeBinaryVertices(file);
+    writeBinaryVertices(file, format, positionMin, positionMax);
     // parts
     writeBinaryObjects(parts, file);
 }
@@ -104,49 +132,207 @@ intersect_triangle(const float orig[3], const float dir[3],
    return 1;
 }
 
-// Performs an intersection test between a ray and the given mesh part
-// and stores the result in "point".
-bool intersect(const Vector3& rayOrigin, const Vector3& rayDirection, const std::vector<Vertex>& vertices, const std::vector<MeshPart*>& parts, Vector3* point)
+// A uniform grid over the heightmap samples (the integer x and z coordinates
+// within the mesh bounds) that lists the triangles that may cover each cell.
+// Each cell lists its triangles in the order of the mesh parts, so the first
+// triangle hit in a cell is the first one hit among all triangles of the mesh.
+struct HeightmapGrid
 {
-    const float* orig = &rayOrigin.x;
-    const float* dir = &rayDirection.x;
+    int minX, minZ;
+    int cellSize;
+    int columns, rows;
+    std::vector<const float*> triangles; // 3 vertex positions per triangle
+    std::vector<unsigned int> cellOffsets;
+    std::vector<unsigned int> cellTriangles;
+
+    void build(const std::vector<Vertex>& vertices, const std::vector<MeshPart*>& parts, int minX, int maxX, int minZ, int maxZ);
+
+    // Returns the range of cells covered by the samples within [min, max].
+    bool cellRange(float min, float max, int sampleMin, int cellCount, int* first, int* last) const;
+};
+
+bool HeightmapGrid::cellRange(float min, float max, int sampleMin, int cellCount, int* first, int* last) const
+{
+    int firstSample = (int)ceil(min - HEIGHTMAP_GRID_MARGIN) - sampleMin;
+    int lastSample = (int)floor(max + HEIGHTMAP_GRID_MARGIN) - sampleMin;
+    if (lastSample < 0 || firstSample > lastSample)
+    {
+        return false;
+    }
+    *first = std::max(firstSample, 0) / cellSize;
+    *last = lastSample / cellSize;
+    if (*first >= cellCount)
+    {
+        return false;
+    }
+    *last = std::min(*last, cellCount - 1);
+    return true;
+}
+
+void HeightmapGrid::build(const std::vector<Vertex>& vertices, const std::vector<MeshPart*>& parts, int minX, int maxX, int minZ, int maxZ)
+{
+    this->minX = minX;
+    this->minZ = minZ;
 
     for (unsigned int i = 0, partCount = parts.size(); i < partCount; ++i)
     {
         MeshPart* part = parts[i];
-
-        for (unsigned int j = 0, indexCount = part->getIndicesCount(); j < indexCount; j += 3)
+        for (unsigned int j = 0, indexCount = part->getIndicesCount(); j + 2 < indexCount; j += 3)
         {
-            const float* v0 = &vertices[part->getIndex( j )].position.x;
-            const float* v1 = &vertices[part->getIndex(j+1)].position.x;
-            const float* v2 = &vertices[part->getIndex(j+2)].position.x;
+            triangles.push_back(&vertices[part->getIndex( j )].position.x);
+            triangles.push_back(&vertices[part->getIndex(j+1)].position.x);
+            triangles.push_back(&vertices[part->getIndex(j+2)].position.x);
+        }
+    }
+    unsigned int triangleCount = triangles.size() / 3;
+
+    // Size the cells so that there are about as many cells as triangles.
+    int width = maxX - minX + 1;
+    int height = maxZ - minZ + 1;
+    cellSize = std::max(1, (int)sqrt((double)width * height / std::max(triangleCount, 1u)));
+    columns = (width + cellSize - 1) / cellSize;
+    rows = (height + cellSize - 1) / cellSize;
 
-            float t, u, v;
-            if (intersect_triangle(orig, dir, v0, v1, v2, &t, &u, &v))
+    // Count the triangles of each cell, then fill the cells in triangle order.
+    cellOffsets.assign(columns * rows + 1, 0);
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (unsigned int i = 0; i < triangleCount; ++i)
+        {
+            const float* const* v = &triangles[i * 3];
+            int firstColumn, lastColumn, firstRow, lastRow;
+            if (!cellRange(std::min(v[0][0], std::min(v[1][0], v[2][0])), std::max(v[0][0], std::max(v[1][0], v[2][0])), minX, columns, &firstColumn, &lastColumn) ||
+                !cellRange(std::min(v[0][2], std::min(v[1][2], v[2][2])), std::max(v[0][2], std::max(v[1][2], v[2][2])), minZ, rows, &firstRow, &lastRow))
+            {
+                continue;
+            }
+            for (int row = firstRow; row <= lastRow; ++row)
             {
-                // Found an intersection!
-                if (point)
+                for (int column = firstColumn; column <= lastColumn; ++column)
                 {
-                    Vector3 rd(rayDirection);
-                    rd.scale(t);
-                    Vector3::add(rayOrigin, rd, point);
+                    unsigned int cell = row * columns + column;
+                    if (pass == 0)
+                        ++cellOffsets[cell + 1];
+                    else
+                        cellTriangles[cellOffsets[cell]++] = i;
                 }
-                return true;
             }
         }
+
+        if (pass == 0)
+        {
+            for (unsigned int cell = 1; cell < cellOffsets.size(); ++cell)
+            {
+                cellOffsets[cell] += cellOffsets[cell - 1];
+            }
+            cellTriangles.resize(cellOffsets.back());
+        }
+        else
+        {
+            // Filling moved each offset to the start of the next cell.
+            for (unsigned int cell = cellOffsets.size() - 1; cell > 0; --cell)
+            {
+                cellOffsets[cell] = cellOffsets[cell - 1];
+            }
+            cellOffsets[0] = 0;
+        }
+    }
+}
+
+// Performs an intersection test between a ray cast down at the given heightmap
+// sample and the triangles of the mesh, and stores the result in "point".
+static bool intersect(const Vector3& rayOrigin, const Vector3& rayDirection, const HeightmapGrid& grid, int x, int z, Vector3* point)
+{
+    const float* orig = &rayOrigin.x;
+    const float* dir = &rayDirection.x;
+
+    unsigned int cell = ((z - grid.minZ) / grid.cellSize) * grid.columns + (x - grid.minX) / grid.cellSize;
+    for (unsigned int i = grid.cellOffsets[cell], end = grid.cellOffsets[cell + 1]; i < end; ++i)
+    {
+        const float* const* triangle = &grid.triangles[grid.cellTriangles[i] * 3];
+
+        float t, u, v;
+        if (intersect_triangle(orig, dir, triangle[0], triangle[1], triangle[2], &t, &u, &v))
+        {
+            // Found an intersection!
+            if (point)
+            {
+                Vector3 rd(rayDirection);
+                rd.scale(t);
+                Vector3::add(rayOrigin, rd, point);
+            }
+            return true;
+        }
     }
 
     return false;
 }
 
+// The rows of a heightmap generated by one thread.
+struct HeightmapRows
+{
+    const HeightmapGrid* grid;
+    float rayHeight;
+    int minX, maxX, minZ, maxZ;
+    float* heights;
+    char* hits;
+    int firstRow, rowStep;
+};
+
+static void generateHeightmapRows(HeightmapRows* rows)
+{
+    Vector3 rayOrigin(0, rows->rayHeight, 0);
+    Vector3 rayDirection(0, -1, 0);
+    Vector3 intersectionPoint;
+    int width = rows->maxX - rows->minX + 1;
+    for (int z = rows->minZ + rows->firstRow; z <= rows->maxZ; z += rows->rowStep)
+    {
+        rayOrigin.z = (float)z;
+        int index = (z - rows->minZ) * width;
+        for (int x = rows->minX; x <= rows->maxX; x++, index++)
+        {
+            rayOrigin.x = (float)x;
+            if (intersect(rayOrigin, rayDirection, *rows->grid, x, z, &intersectionPoint))
+            {
+                rows->heights[index] = intersectionPoint.y;
+                rows->hits[index] = 1;
+            }
+            else
+            {
+                rows->heights[index] = 0;
+                rows->hits[index] = 0;
+            }
+        }
+    }
+}
+
+#ifdef WIN32
+static unsigned int __stdcall heightmapThread(void* rows)
+#else
+static void* heightmapThread(void* rows)
+#endif
+{
+    generateHeightmapRows(static_cast<HeightmapRows*>(rows));
+    return 0;
+}
+
+static unsigned int getHardwareThreadCount()
+{
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long count = (long)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count > 1 ? (unsigned int)count : 1;
+}
+
 void Mesh::generateHeightmap(const char* filename, bool highP)
 {
     // Shoot rays down from a point just above the max Y position of the mesh.
     // Compute ray-triangle intersection tests against the ray and this mesh to 
     // generate heightmap data.
-    Vector3 rayOrigin(0, bounds.max.y + 10, 0);
-    Vector3 rayDirection(0, -1, 0);
-    Vector3 intersectionPoint;
     int minX = (int)ceil(bounds.min.x);
     int maxX = (int)floor(bounds.max.x);
     int minZ = (int)ceil(bounds.min.z);
@@ -154,30 +340,79 @@ void Mesh::generateHeightmap(const char* filename, bool highP)
     int width = maxX - minX + 1;
     int height = maxZ - minZ + 1;
     float* heights = new float[width * height];
-    int index = 0;
+    std::vector<char> hits(width * height);
     float minHeight = FLT_MAX;
     float maxHeight = -FLT_MAX;
-    for (int z = minZ; z <= maxZ; z++)
+
+    // Only the triangles near each sample are tested, and the rows are interleaved
+    // between threads.
+    HeightmapGrid grid;
+    grid.build(vertices, parts, minX, maxX, minZ, maxZ);
+
+    unsigned int threadCount = std::min(std::min(getHardwareThreadCount(), (unsigned int)HEIGHTMAP_MAX_THREADS), (unsigned int)height);
+    std::vector<HeightmapRows> rows(threadCount);
+    for (unsigned int i = 0; i < threadCount; ++i)
     {
-        rayOrigin.z = (float)z;
-        for (int x = minX; x <= maxX; x++)
+        HeightmapRows& r = rows[i];
+        r.grid = &grid;
+        r.rayHeight = bounds.max.y + 10;
+        r.minX = minX;
+        r.maxX = maxX;
+        r.minZ = minZ;
+        r.maxZ = maxZ;
+        r.heights = heights;
+        r.hits = &hits[0];
+        r.firstRow = i;
+        r.rowStep = threadCount;
+    }
+
+#ifdef WIN32
+    std::vector<HANDLE> threads;
+#else
+    std::vector<pthread_t> threads;
+#endif
+    for (unsigned int i = 1; i < threadCount; ++i)
+    {
+#ifdef WIN32
+        HANDLE thread = (HANDLE)_beginthreadex(NULL, 0, heightmapThread, &rows[i], 0, NULL);
+        if (thread != 0)
+#else
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, heightmapThread, &rows[i]) == 0)
+#endif
         {
-            float h;
-            rayOrigin.x = (float)x;
-            if (intersect(rayOrigin, rayDirection, vertices, parts, &intersectionPoint))
-            {
-                h = intersectionPoint.y;
-            }
-            else
+            threads.push_back(thread);
+        }
+        else
+        {
+            // Generate these rows on this thread instead.
+            generateHeightmapRows(&rows[i]);
+        }
+    }
+    generateHeightmapRows(&rows[0]);
+    for (unsigned int i = 0; i < threads.size(); ++i)
+    {
+#ifdef WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+
+    for (int z = minZ, index = 0; z <= maxZ; z++)
+    {
+        for (int x = minX; x <= maxX; x++, index++)
+        {
+            float h = heights[index];
+            if (!hits[index])
             {
-                h = 0;
                 fprintf(stderr, "Warning: Heightmap triangle intersection failed for (%d, %d).\n", x, z);
             }
             if (h < minHeight)
                 minHeight = h;
             if (h > maxHeight)
                 maxHeight = h;
-            heights[index++] = h;
         }
     }
     
@@ -265,19 +500,50 @@ error:
 }
 
 void Mesh::writeBinaryVertices(FILE* file)
+{
+    writeBinaryVertices(file, _vertexFormat, Vector3::zero(), Vector3::zero());
+}
+
+void Mesh::writeBinaryVertices(FILE* file, const std::vector<VertexElement>& format, const Vector3& positionMin, const Vector3& positionMax)
 {
     if (vertices.size() > 0)
     {
-        // Assumes that all vertices are the same size.
-        // Write the number of bytes for the vertex data
-        const Vertex& vertex = vertices.front();
-        write(vertices.size() * vertex.byteSize(), file); // (vertex count) * (vertex size)
+        bool quantized = false;
+        for (std::vector<VertexElement>::const_iterator i = format.begin(); i != format.end(); ++i)
+        {
+            if (i->type != VertexElement::FLOAT)
+            {
+                quantized = true;
+            }
+        }
 
-        // for each vertex
-        for (std::vector<Vertex>::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
+        if (!quantized)
         {
-            // Write this vertex
-            i->writeBinary(file);
+            // Assumes that all vertices are the same size.
+            // Write the number of bytes for the vertex data
+            const Vertex& vertex = vertices.front();
+            write(vertices.size() * vertex.byteSize(), file); // (vertex count) * (vertex size)
+
+            // for each vertex
+            for (std::vector<Vertex>::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
+            {
+                // Write this vertex
+                i->writeBinary(file);
+            }
+        }
+        else
+        {
+            unsigned int vertexSize = 0;
+            for (std::vector<VertexElement>::const_iterator i = format.begin(); i != format.end(); ++i)
+            {
+                vertexSize += i->byteSize();
+            }
+            write(vertices.size() * vertexSize, file);
+
+            for (std::vector<Vertex>::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
+            {
+                writeBinaryQuantizedVertex(file, *i, format, positionMin, positionMax);
+            }
         }
     }
     else
@@ -293,6 +559,211 @@ void Mesh::writeBinaryVertices(FILE* file)
     write(bounds.radius, file);
 }
 
+// Writes a value in [-1, 1] as a normalized signed byte.
+static void writeSnorm8(float value, FILE* file)
+{
+    value = std::max(-1.0f, std::min(1.0f, value));
+    write((char)floor(value * 127.0f + 0.5f), file);
+}
+
+// Writes a value in [0, 1] as a normalized unsigned short.
+static void writeUnorm16(float value, FILE* file)
+{
+    value = std::max(0.0f, std::min(1.0f, value));
+    write((unsigned short)floor(value * 65535.0f + 0.5f), file);
+}
+
+// Writes the zero bytes that pad an element to the size of the next 4 byte boundary.
+static void writePadding(unsigned int size, FILE* file)
+{
+    for (unsigned int i = size; i & 3; ++i)
+    {
+        write((unsigned char)0, file);
+    }
+}
+
+void Mesh::quantizeVertexFormat(std::vector<VertexElement>* format, Vector3* positionMin, Vector3* positionMax) const
+{
+    *format = _vertexFormat;
+
+    EncoderArguments* arguments = EncoderArguments::getInstance();
+    unsigned int quantization = arguments ? arguments->getQuantization() : (unsigned int)EncoderArguments::QUANTIZE_NONE;
+    if (quantization == EncoderArguments::QUANTIZE_NONE || vertices.empty())
+    {
+        return;
+    }
+
+    // Positions map to the range of this mesh's own vertices, as the bounds of
+    // skinned meshes are those of the skin.
+    if (quantization & EncoderArguments::QUANTIZE_POSITIONS)
+    {
+        *positionMin = *positionMax = vertices.front().position;
+        for (std::vector<Vertex>::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
+        {
+            positionMin->x = std::min(positionMin->x, i->position.x);
+            positionMin->y = std::min(positionMin->y, i->position.y);
+            positionMin->z = std::min(positionMin->z, i->position.z);
+            positionMax->x = std::max(positionMax->x, i->position.x);
+            positionMax->y = std::max(positionMax->y, i->position.y);
+            positionMax->z = std::max(positionMax->z, i->position.z);
+        }
+    }
+
+    // Texture coordinates that wrap or are mirrored cannot be normalized.
+    bool texCoordsNormalized = true;
+    if (quantization & EncoderArguments::QUANTIZE_TEXCOORDS)
+    {
+        for (std::vector<Vertex>::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
+        {
+            if (i->texCoord.x < 0.0f || i->texCoord.x > 1.0f || i->texCoord.y < 0.0f || i->texCoord.y > 1.0f)
+            {
+                texCoordsNormalized = false;
+                break;
+            }
+        }
+    }
+
+    for (std::vector<VertexElement>::iterator i = format->begin(); i != format->end(); ++i)
+    {
+        switch (i->usage)
+        {
+        case POSITION:
+            if (quantization & EncoderArguments::QUANTIZE_POSITIONS)
+            {
+                i->type = VertexElement::UNSIGNED_SHORT;
+                i->normalized = true;
+            }
+            break;
+        case NORMAL:
+        case TANGENT:
+        case BINORMAL:
+            if (quantization & EncoderArguments::QUANTIZE_NORMALS)
+            {
+                i->type = VertexElement::BYTE;
+                i->normalized = true;
+            }
+            break;
+        case TEXCOORD0:
+            if (quantization & EncoderArguments::QUANTIZE_TEXCOORDS)
+            {
+                if (texCoordsNormalized)
+                {
+                    i->type = VertexElement::UNSIGNED_SHORT;
+                    i->normalized = true;
+                }
+                else
+                {
+                    printf("Warning: Texture coordinates of mesh \"%s\" are outside [0,1] and will not be quantized.\n", getId().c_str());
+                }
+            }
+            break;
+        case BLENDWEIGHTS:
+            if (quantization & EncoderArguments::QUANTIZE_BLENDWEIGHTS)
+            {
+                i->type = VertexElement::UNSIGNED_BYTE;
+                i->normalized = true;
+            }
+            break;
+        }
+    }
+}
+
+void Mesh::writeBinaryQuantizedVertex(FILE* file, const Vertex& vertex, const std::vector<VertexElement>& format, const Vector3& positionMin, const Vector3& positionMax) const
+{
+    for (std::vector<VertexElement>::const_iterator i = format.begin(); i != format.end(); ++i)
+    {
+        const float* values = NULL;
+        switch (i->usage)
+        {
+        case POSITION:
+            values = &vertex.position.x;
+            break;
+        case NORMAL:
+            values = &vertex.normal.x;
+            break;
+        case TANGENT:
+            values = &vertex.tangent.x;
+            break;
+        case BINORMAL:
+            values = &vertex.binormal.x;
+            break;
+        case TEXCOORD0:
+            values = &vertex.texCoord.x;
+            break;
+        case COLOR:
+            values = &vertex.diffuse.x;
+            break;
+        case BLENDWEIGHTS:
+            values = &vertex.blendWeights.x;
+            break;
+        case BLENDINDICES:
+            values = &vertex.blendIndices.x;
+            break;
+        default:
+            assert(0);
+            return;
+        }
+
+        if (i->type == VertexElement::FLOAT)
+        {
+            write(values, i->size, file);
+        }
+        else if (i->usage == POSITION)
+        {
+            const float* min = &positionMin.x;
+            const float* max = &positionMax.x;
+            for (unsigned int j = 0; j < i->size; ++j)
+            {
+                float range = max[j] - min[j];
+                writeUnorm16(range > 0.0f ? (values[j] - min[j]) / range : 0.0f, file);
+            }
+            writePadding(i->size * 2, file);
+        }
+        else if (i->usage == BLENDWEIGHTS)
+        {
+            // Round the weights, then give the rounding error to the largest one
+            // so that they still add up to 1.
+            unsigned char weights[Vertex::BLEND_WEIGHTS_COUNT];
+            int sum = 0;
+            unsigned int largest = 0;
+            for (unsigned int j = 0; j < i->size; ++j)
+            {
+                weights[j] = (unsigned char)floor(std::max(0.0f, std::min(1.0f, values[j])) * 255.0f + 0.5f);
+                sum += weights[j];
+                if (values[j] > values[largest])
+                {
+                    largest = j;
+                }
+            }
+            if (sum > 0)
+            {
+                weights[largest] = (unsigned char)std::max(0, std::min(255, weights[largest] + 255 - sum));
+            }
+            for (unsigned int j = 0; j < i->size; ++j)
+            {
+                write(weights[j], file);
+            }
+            writePadding(i->size, file);
+        }
+        else if (i->type == VertexElement::BYTE)
+        {
+            for (unsigned int j = 0; j < i->size; ++j)
+            {
+                writeSnorm8(values[j], file);
+            }
+            writePadding(i->size, file);
+        }
+        else
+        {
+            for (unsigned int j = 0; j < i->size; ++j)
+            {
+                writeUnorm16(values[j], file);
+            }
+            writePadding(i->size * 2, file);
+        }
+    }
+}
+
 void Mesh::writeText(FILE* file)
 {
     fprintElementStart(file);
@@ -392,6 +863,71 @@ unsigned int Mesh::getVertexIndex(const Vertex& vertex)
     return it->second;
 }
 
+void Mesh::optimize()
+{
+    if (vertices.empty() || parts.empty())
+    {
+        return;
+    }
+
+    unsigned int vertexCount = vertices.size();
+    size_t triangleCount = 0;
+    float missesBefore = 0.0f, missesAfter = 0.0f;
+    for (std::vector<MeshPart*>::iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        size_t partTriangleCount = (*i)->getIndicesCount() / 3;
+        missesBefore += (*i)->computeACMR() * partTriangleCount;
+        (*i)->optimizeVertexCache(vertexCount);
+        missesAfter += (*i)->computeACMR() * partTriangleCount;
+        triangleCount += partTriangleCount;
+    }
+
+    // Number the vertices in the order the parts first use them, so that they are
+    // fetched mostly sequentially. Unused vertices go last.
+    std::vector<unsigned int> remap(vertexCount, vertexCount);
+    unsigned int next = 0;
+    for (std::vector<MeshPart*>::iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        MeshPart* part = *i;
+        for (unsigned int j = 0, count = part->getIndicesCount(); j < count; ++j)
+        {
+            unsigned int index = part->getIndex(j);
+            if (remap[index] == vertexCount)
+            {
+                remap[index] = next++;
+            }
+        }
+    }
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        if (remap[i] == vertexCount)
+        {
+            remap[i] = next++;
+        }
+    }
+
+    std::vector<Vertex> remappedVertices(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        remappedVertices[remap[i]] = vertices[i];
+    }
+    vertices.swap(remappedVertices);
+    for (std::vector<MeshPart*>::iterator i = parts.begin(); i != parts.end(); ++i)
+    {
+        (*i)->remapIndices(remap);
+    }
+    for (std::map<Vertex, unsigned int>::iterator i = vertexLookupTable.begin(); i != vertexLookupTable.end(); ++i)
+    {
+        i->second = remap[i->second];
+    }
+
+    if (triangleCount > 0)
+    {
+        printf("Mesh \"%s\": ACMR %.3f before, %.3f after vertex cache optimization.\n",
+            getId().c_str(), missesBefore / triangleCount, missesAfter / triangleCount);
+    }
+}
+
 void Mesh::computeBounds()
 {
     // If we have a Model with a MeshSkin associated with it,
@@ -34,6 +34,12 @@ public:
     virtual void writeBinary(FILE* file);
     void writeBinaryVertices(FILE* file);
 
+    /**
+     * Writes the vertices of this mesh in the given format, which may differ from the
+     * mesh's format by the types of its elements (see quantizeVertexFormat()).
+     */
+    void writeBinaryVertices(FILE* file, const std::vector<VertexElement>& format, const Vector3& positionMin, const Vector3& positionMax);
+
     virtual void writeText(FILE* file);
     void writeText(FILE* file, const Vertex& vertex);
     void writeText(FILE* file, const Vector3& v);
@@ -69,6 +75,13 @@ public:
 
     void computeBounds();
 
+    /**
+     * Reorders the triangles of each part of this mesh for the post-transform vertex
+     * cache, then reorders the vertices in the order they are first used, and prints
+     * the ACMR of the mesh before and after.
+     */
+    void optimize();
+
     Model* model;
     std::vector<Vertex> vertices;
     std::vector<MeshPart*> parts;
@@ -76,6 +89,18 @@ public:
     std::map<Vertex, unsigned int> vertexLookupTable;
 
 private:
+
+    /**
+     * Returns the vertex format of this mesh with the elements selected by the encoder
+     * arguments quantized, and the range that quantized positions map to.
+     */
+    void quantizeVertexFormat(std::vector<VertexElement>* format, Vector3* positionMin, Vector3* positionMax) const;
+
+    /**
+     * Writes a vertex in a format that contains quantized elements.
+     */
+    void writeBinaryQuantizedVertex(FILE* file, const Vertex& vertex, const std::vector<VertexElement>& format, const Vector3& positionMin, const Vector3& positionMax) const;
+
     std::vector<VertexElement> _vertexFormat;
 
 };
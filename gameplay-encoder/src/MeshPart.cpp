@@ -1,6 +1,17 @@
 #include "Base.h"
 #include "MeshPart.h"
 
+// Size of the LRU cache modeled by the vertex cache optimization.
+#define VERTEX_CACHE_SIZE 32
+#define VERTEX_CACHE_DECAY_POWER 1.5f
+#define VERTEX_CACHE_LAST_TRIANGLE_SCORE 0.75f
+#define VERTEX_VALENCE_BOOST_SCALE 2.0f
+#define VERTEX_VALENCE_BOOST_POWER 0.5f
+
+// Size of the FIFO cache simulated to compute the ACMR, which is small enough to be
+// representative of mobile GPUs.
+#define ACMR_CACHE_SIZE 16
+
 namespace gameplay
 {
 
@@ -86,6 +97,219 @@ unsigned int MeshPart::getIndex(unsigned int i) const
     return _indices[i];
 }
 
+float MeshPart::computeACMR() const
+{
+    size_t triangleCount = _indices.size() / 3;
+    if (_primitiveType != TRIANGLES || triangleCount == 0)
+    {
+        return 0.0f;
+    }
+
+    unsigned int cache[ACMR_CACHE_SIZE];
+    unsigned int cacheCount = 0, cacheNext = 0, misses = 0;
+    for (size_t i = 0, count = triangleCount * 3; i < count; ++i)
+    {
+        unsigned int index = _indices[i];
+        bool hit = false;
+        for (unsigned int j = 0; j < cacheCount; ++j)
+        {
+            if (cache[j] == index)
+            {
+                hit = true;
+                break;
+            }
+        }
+        if (!hit)
+        {
+            ++misses;
+            cache[cacheNext] = index;
+            cacheNext = (cacheNext + 1) % ACMR_CACHE_SIZE;
+            cacheCount = std::min(cacheCount + 1, (unsigned int)ACMR_CACHE_SIZE);
+        }
+    }
+    return (float)misses / triangleCount;
+}
+
+// Returns the score of a vertex given its position in the cache (-1 if not cached)
+// and the number of triangles that still use it.
+static float vertexCacheScore(int cachePosition, unsigned int remainingTriangles)
+{
+    if (remainingTriangles == 0)
+    {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // The vertices of the last triangle get a fixed score, so that the next
+        // triangle does not favor any one of its edges.
+        if (cachePosition < 3)
+        {
+            score = VERTEX_CACHE_LAST_TRIANGLE_SCORE;
+        }
+        else
+        {
+            float scale = 1.0f - (float)(cachePosition - 3) / (VERTEX_CACHE_SIZE - 3);
+            score = pow(scale, VERTEX_CACHE_DECAY_POWER);
+        }
+    }
+
+    // Favor vertices with few triangles left, so that they are not left behind.
+    score += VERTEX_VALENCE_BOOST_SCALE * pow((float)remainingTriangles, -VERTEX_VALENCE_BOOST_POWER);
+    return score;
+}
+
+void MeshPart::optimizeVertexCache(unsigned int vertexCount)
+{
+    size_t triangleCount = _indices.size() / 3;
+    if (_primitiveType != TRIANGLES || triangleCount < 2)
+    {
+        return;
+    }
+
+    // The triangles that use each vertex, in ranges of adjacency starting at
+    // adjacencyOffsets[vertex]. Added triangles are swapped out of the ranges.
+    std::vector<unsigned int> remainingTriangles(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        assert(_indices[i] < vertexCount);
+        ++remainingTriangles[_indices[i]];
+    }
+    std::vector<unsigned int> adjacencyOffsets(vertexCount, 0);
+    for (unsigned int i = 1; i < vertexCount; ++i)
+    {
+        adjacencyOffsets[i] = adjacencyOffsets[i - 1] + remainingTriangles[i - 1];
+    }
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    std::vector<unsigned int> adjacencyCounts(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        unsigned int vertex = _indices[i];
+        adjacency[adjacencyOffsets[vertex] + adjacencyCounts[vertex]++] = (unsigned int)(i / 3);
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i)
+    {
+        vertexScores[i] = vertexCacheScore(-1, remainingTriangles[i]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> added(triangleCount, false);
+    int bestTriangle = -1;
+    float bestScore = -1.0f;
+    for (size_t i = 0; i < triangleCount; ++i)
+    {
+        triangleScores[i] = vertexScores[_indices[i * 3]] + vertexScores[_indices[i * 3 + 1]] + vertexScores[_indices[i * 3 + 2]];
+        if (triangleScores[i] > bestScore)
+        {
+            bestScore = triangleScores[i];
+            bestTriangle = (int)i;
+        }
+    }
+
+    std::vector<unsigned int> indices;
+    indices.reserve(triangleCount * 3);
+    std::vector<unsigned int> cache, newCache;
+    cache.reserve(VERTEX_CACHE_SIZE + 3);
+    newCache.reserve(VERTEX_CACHE_SIZE + 3);
+    size_t nextTriangle = 0;
+
+    for (size_t n = 0; n < triangleCount; ++n)
+    {
+        // When no cached vertex has triangles left, continue with the next triangle
+        // in the original order.
+        if (bestTriangle < 0)
+        {
+            while (added[nextTriangle])
+            {
+                ++nextTriangle;
+            }
+            bestTriangle = (int)nextTriangle;
+        }
+
+        added[bestTriangle] = true;
+        const unsigned int* triangle = &_indices[bestTriangle * 3];
+        newCache.clear();
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+            unsigned int vertex = triangle[i];
+            indices.push_back(vertex);
+
+            // Remove the triangle from the triangles of its vertices.
+            unsigned int* begin = &adjacency[adjacencyOffsets[vertex]];
+            unsigned int* end = begin + remainingTriangles[vertex];
+            unsigned int* t = std::find(begin, end, (unsigned int)bestTriangle);
+            if (t != end)
+            {
+                *t = *(end - 1);
+                --remainingTriangles[vertex];
+            }
+
+            if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+            {
+                newCache.push_back(vertex);
+            }
+        }
+        size_t triangleVertexCount = newCache.size();
+        for (std::vector<unsigned int>::const_iterator i = cache.begin(); i != cache.end(); ++i)
+        {
+            if (std::find(newCache.begin(), newCache.begin() + triangleVertexCount, *i) == newCache.begin() + triangleVertexCount)
+            {
+                newCache.push_back(*i);
+            }
+        }
+
+        // Update the scores of the vertices whose cache position changed, including
+        // those that were pushed out of the cache, then of their triangles.
+        for (size_t i = 0; i < newCache.size(); ++i)
+        {
+            unsigned int vertex = newCache[i];
+            cachePositions[vertex] = i < VERTEX_CACHE_SIZE ? (int)i : -1;
+            vertexScores[vertex] = vertexCacheScore(cachePositions[vertex], remainingTriangles[vertex]);
+        }
+        bestTriangle = -1;
+        bestScore = -1.0f;
+        for (size_t i = 0; i < newCache.size(); ++i)
+        {
+            unsigned int vertex = newCache[i];
+            for (unsigned int j = 0; j < remainingTriangles[vertex]; ++j)
+            {
+                unsigned int t = adjacency[adjacencyOffsets[vertex] + j];
+                triangleScores[t] = vertexScores[_indices[t * 3]] + vertexScores[_indices[t * 3 + 1]] + vertexScores[_indices[t * 3 + 2]];
+                if (triangleScores[t] > bestScore)
+                {
+                    bestScore = triangleScores[t];
+                    bestTriangle = (int)t;
+                }
+            }
+        }
+
+        if (newCache.size() > VERTEX_CACHE_SIZE)
+        {
+            newCache.resize(VERTEX_CACHE_SIZE);
+        }
+        cache.swap(newCache);
+    }
+
+    // Indices past the last whole triangle are kept at the end.
+    indices.insert(indices.end(), _indices.begin() + triangleCount * 3, _indices.end());
+    _indices.swap(indices);
+}
+
+void MeshPart::remapIndices(const std::vector<unsigned int>& remap)
+{
+    _indexFormat = INDEX16;
+    for (std::vector<unsigned int>::iterator i = _indices.begin(); i != _indices.end(); ++i)
+    {
+        assert(*i < remap.size());
+        *i = remap[*i];
+        updateIndexFormat(*i);
+    }
+}
+
 void MeshPart::writeBinaryIndex(unsigned int index, FILE* file)
 {
     switch (_indexFormat)
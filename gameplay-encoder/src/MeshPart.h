@@ -62,6 +62,28 @@ public:
      */
     unsigned int getIndex(unsigned int i) const;
 
+    /**
+     * Returns the average number of vertices transformed per triangle (ACMR), simulating
+     * a FIFO post-transform vertex cache. Returns 0 if this part is not a triangle list.
+     */
+    float computeACMR() const;
+
+    /**
+     * Reorders the triangles of this part to improve post-transform vertex cache hits,
+     * using Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" algorithm.
+     * Only triangle lists are reordered.
+     *
+     * @param vertexCount The number of vertices in the mesh.
+     */
+    void optimizeVertexCache(unsigned int vertexCount);
+
+    /**
+     * Replaces each index with the new position of its vertex.
+     *
+     * @param remap The new position of each vertex, indexed by its old position.
+     */
+    void remapIndices(const std::vector<unsigned int>& remap);
+
 private:
 
     /**
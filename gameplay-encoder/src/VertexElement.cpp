@@ -4,9 +4,11 @@
 namespace gameplay
 {
 
-VertexElement::VertexElement(unsigned int t, unsigned int c) :
+VertexElement::VertexElement(unsigned int t, unsigned int c, Type type, bool normalized) :
     usage(t),
-    size(c)
+    size(c),
+    type(type),
+    normalized(normalized)
 {
 }
 
@@ -22,7 +24,8 @@ void VertexElement::writeBinary(FILE* file)
 {
     Object::writeBinary(file);
     write(usage, file);
-    write(size, file);
+    // The type and normalized flag are packed above the number of values.
+    write(size | ((unsigned int)type << 8) | (normalized ? 0x10000 : 0), file);
 }
 void VertexElement::writeText(FILE* file)
 {
@@ -32,6 +35,21 @@ void VertexElement::writeText(FILE* file)
     fprintElementEnd(file);
 }
 
+unsigned int VertexElement::byteSize() const
+{
+    switch (type)
+    {
+    case BYTE:
+    case UNSIGNED_BYTE:
+        return (size + 3) & ~3;
+    case SHORT:
+    case UNSIGNED_SHORT:
+        return (size * 2 + 3) & ~3;
+    default:
+        return size * 4;
+    }
+}
+
 const char* VertexElement::usageStr(unsigned int usage)
 {
     switch (usage)
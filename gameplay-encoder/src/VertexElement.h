@@ -10,10 +10,22 @@ class VertexElement : public Object
 {
 public:
 
+    /**
+     * The types of the values of an element, as encoded in the binary file.
+     */
+    enum Type
+    {
+        FLOAT = 0,
+        BYTE = 1,
+        UNSIGNED_BYTE = 2,
+        SHORT = 3,
+        UNSIGNED_SHORT = 4
+    };
+
     /**
      * Constructor.
      */
-    VertexElement(unsigned int t, unsigned int c);
+    VertexElement(unsigned int t, unsigned int c, Type type = FLOAT, bool normalized = false);
 
     /**
      * Destructor.
@@ -26,8 +38,16 @@ public:
 
     static const char* usageStr(unsigned int usage);
 
+    /**
+     * Returns the number of bytes of the element in a vertex, including the padding
+     * that keeps the next element aligned to 4 bytes.
+     */
+    unsigned int byteSize() const;
+
     unsigned int usage;
     unsigned int size;
+    Type type;
+    bool normalized;
 };
 
 }
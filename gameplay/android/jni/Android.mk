@@ -28,12 +28,14 @@ LOCAL_SRC_FILES := \
     AnimationController.cpp \
     AnimationTarget.cpp \
     AnimationValue.cpp \
+    AssetLoader.cpp \
     AudioBuffer.cpp \
     AudioController.cpp \
     AudioListener.cpp \
     AudioSource.cpp \
     BoundingBox.cpp \
     BoundingSphere.cpp \
+    BoundingVolumeTree.cpp \
     Bundle.cpp \
     Button.cpp \
     Camera.cpp \
@@ -64,11 +66,13 @@ LOCAL_SRC_FILES := \
     Matrix.cpp \
     Mesh.cpp \
     MeshBatch.cpp \
+    InstanceBatch.cpp \
     MeshPart.cpp \
     MeshSkin.cpp \
     Model.cpp \
     Node.cpp \
     ParticleEmitter.cpp \
+    ParticleSystem.cpp \
     Pass.cpp \
     PhysicsCharacter.cpp \
     PhysicsCollisionObject.cpp \
@@ -91,6 +95,7 @@ LOCAL_SRC_FILES := \
     Rectangle.cpp \
     Ref.cpp \
     RenderState.cpp \
+    RenderQueue.cpp \
     RenderTarget.cpp \
     Scene.cpp \
     SceneLoader.cpp \
@@ -104,6 +109,7 @@ LOCAL_SRC_FILES := \
     Texture.cpp \
     Theme.cpp \
     ThemeStyle.cpp \
+    ThreadPool.cpp \
     Transform.cpp \
     Vector2.cpp \
     Vector3.cpp \
@@ -1,17 +1,49 @@
+#if defined(INSTANCED)
+attribute mat4 a_instanceMatrix;							// Per-instance world matrix
+
+vec4 getPosition()
+{
+    return a_instanceMatrix * a_position;
+}
+#else
 vec4 getPosition()
 {
     return a_position;    
 }
+#endif
 
 #if defined(LIGHTING)
 
+#if defined(INSTANCED)
+mat3 getInstanceRotation()
+{
+    return mat3(a_instanceMatrix[0].xyz, a_instanceMatrix[1].xyz, a_instanceMatrix[2].xyz);
+}
+
+vec3 getNormal()
+{
+    return getInstanceRotation() * a_normal;
+}
+#else
 vec3 getNormal()
 {
     return a_normal;
 }
+#endif
 
 #if defined(BUMPED)
 
+#if defined(INSTANCED)
+vec3 getTangent()
+{
+    return getInstanceRotation() * a_tangent;
+}
+
+vec3 getBinormal()
+{
+    return getInstanceRotation() * a_binormal;
+}
+#else
 vec3 getTangent()
 {
     return a_tangent;
@@ -21,6 +53,7 @@ vec3 getBinormal()
 {
     return a_binormal;
 }
+#endif
 
 #endif
 
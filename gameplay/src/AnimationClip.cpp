@@ -13,7 +13,7 @@ AnimationClip::AnimationClip(const char* id, Animation* animation, unsigned long
     : _id(id), _animation(animation), _startTime(startTime), _endTime(endTime), _duration(_endTime - _startTime), 
       _stateBits(0x00), _repeatCount(1.0f), _activeDuration(_duration * _repeatCount), _speed(1.0f), _timeStarted(0), 
       _elapsedTime(0), _crossFadeToClip(NULL), _crossFadeOutElapsed(0), _crossFadeOutDuration(0), _blendWeight(1.0f), 
-      _beginListeners(NULL), _endListeners(NULL), _listeners(NULL), _listenerItr(NULL), _scriptListeners(NULL)
+      _percentComplete(0.0f), _beginPending(false), _beginListeners(NULL), _endListeners(NULL), _listeners(NULL), _listenerItr(NULL), _scriptListeners(NULL)
 {
     GP_ASSERT(_animation);
     GP_ASSERT(0 <= startTime && startTime <= _animation->_duration && 0 <= endTime && endTime <= _animation->_duration);
@@ -25,6 +25,7 @@ AnimationClip::AnimationClip(const char* id, Animation* animation, unsigned long
         GP_ASSERT(_animation->_channels[i]->getCurve());
         _values.push_back(new AnimationValue(_animation->_channels[i]->getCurve()->getComponentCount()));
     }
+    _keyIndices.resize(channelCount, 0);
 }
 
 AnimationClip::~AnimationClip()
@@ -354,17 +355,38 @@ void AnimationClip::addListener(const char* function, unsigned long eventTime)
 }
 
 bool AnimationClip::update(float elapsedTime)
+{
+    UpdateResult result = advance(elapsedTime);
+    if (result == UPDATE_SKIP)
+        return false;
+
+    if (result != UPDATE_END)
+    {
+        sample(0, _values.size());
+        apply();
+        notifyListeners();
+    }
+
+    if (result != UPDATE_SAMPLE)
+    {
+        onEnd();
+        return true;
+    }
+
+    return false;
+}
+
+AnimationClip::UpdateResult AnimationClip::advance(float elapsedTime)
 {
     if (isClipStateBitSet(CLIP_IS_PAUSED_BIT))
     {
-        return false;
+        return UPDATE_SKIP;
     }
     else if (isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT))
     {   // If the marked for removal bit is set, it means stop() was called on the AnimationClip at some point
-        // after the last update call. Reset the flag, and return true so the AnimationClip is removed from the 
+        // after the last update call. Return UPDATE_END so the AnimationClip is ended and removed from the 
         // running clips on the AnimationController.
-        onEnd();
-        return true;
+        return UPDATE_END;
     }
     else if (!isClipStateBitSet(CLIP_IS_STARTED_BIT))
     {
@@ -412,41 +434,10 @@ bool AnimationClip::update(float elapsedTime)
             currentTime = fmodf(_elapsedTime, _duration);
     }
 
-    // Notify any listeners of Animation events.
-    if (_listeners)
-    {
-        GP_ASSERT(_listenerItr);
-
-        if (_speed >= 0.0f)
-        {
-            while (*_listenerItr != _listeners->end() && _elapsedTime >= (long) (**_listenerItr)->_eventTime)
-            {
-                GP_ASSERT(_listenerItr);
-                GP_ASSERT(**_listenerItr);
-                GP_ASSERT((**_listenerItr)->_listener);
-
-                (**_listenerItr)->_listener->animationEvent(this, Listener::TIME);
-                ++*_listenerItr;
-            }
-        }
-        else
-        {
-            while (*_listenerItr != _listeners->begin() && _elapsedTime <= (long) (**_listenerItr)->_eventTime)
-            {
-                GP_ASSERT(_listenerItr);
-                GP_ASSERT(**_listenerItr);
-                GP_ASSERT((**_listenerItr)->_listener);
-
-                (**_listenerItr)->_listener->animationEvent(this, Listener::TIME);
-                --*_listenerItr;
-            }
-        }
-    }
-
     // Add back in start time, and divide by the total animation's duration to get the actual percentage complete
     GP_ASSERT(_animation);
     GP_ASSERT(_animation->_duration > 0);
-    float percentComplete = ((float)_startTime + currentTime) / (float)_animation->_duration;
+    _percentComplete = ((float)_startTime + currentTime) / (float)_animation->_duration;
     
     if (isClipStateBitSet(CLIP_IS_FADING_OUT_BIT))
     {
@@ -494,35 +485,95 @@ bool AnimationClip::update(float elapsedTime)
         }
     }
     
-    // Evaluate this clip.
-    Animation::Channel* channel = NULL;
-    AnimationValue* value = NULL;
-    AnimationTarget* target = NULL;
+    // When ended, the final values are still sampled before the clip is ended.
+    if (isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT) || !isClipStateBitSet(CLIP_IS_STARTED_BIT))
+        return UPDATE_SAMPLE_AND_END;
+
+    return UPDATE_SAMPLE;
+}
+
+void AnimationClip::sample(unsigned int begin, unsigned int end)
+{
+    GP_ASSERT(_animation);
+    GP_ASSERT(end <= _animation->_channels.size());
+
+    for (unsigned int i = begin; i < end; i++)
+    {
+        Animation::Channel* channel = _animation->_channels[i];
+        GP_ASSERT(channel);
+        GP_ASSERT(channel->getCurve());
+        GP_ASSERT(_values[i]);
+
+        // Evaluate the point on Curve, starting from the key used last time.
+        channel->getCurve()->evaluate(_percentComplete, _values[i]->_value, &_keyIndices[i]);
+    }
+}
+
+void AnimationClip::apply()
+{
+    GP_ASSERT(_animation);
+
     unsigned int channelCount = _animation->_channels.size();
     for (unsigned int i = 0; i < channelCount; i++)
     {
-        channel = _animation->_channels[i];
+        Animation::Channel* channel = _animation->_channels[i];
         GP_ASSERT(channel);
-        target = channel->_target;
-        GP_ASSERT(target);
-        value = _values[i];
-        GP_ASSERT(value);
+        GP_ASSERT(channel->_target);
+        GP_ASSERT(_values[i]);
 
-        // Evaluate the point on Curve
-        GP_ASSERT(channel->getCurve());
-        channel->getCurve()->evaluate(percentComplete, value->_value);
         // Set the animation value on the target property.
-        target->setAnimationPropertyValue(channel->_propertyId, value, _blendWeight);
+        channel->_target->setAnimationPropertyValue(channel->_propertyId, _values[i], _blendWeight);
     }
+}
 
-    // When ended. Probably should move to it's own method so we can call it when the clip is ended early.
-    if (isClipStateBitSet(CLIP_IS_MARKED_FOR_REMOVAL_BIT) || !isClipStateBitSet(CLIP_IS_STARTED_BIT))
+void AnimationClip::notifyListeners()
+{
+    // Notify begin listeners if the clip began in the last advance.
+    if (_beginPending)
     {
-        onEnd();
-        return true;
+        _beginPending = false;
+        if (_beginListeners)
+        {
+            std::vector<Listener*>::iterator listener = _beginListeners->begin();
+            while (listener != _beginListeners->end())
+            {
+                GP_ASSERT(*listener);
+                (*listener)->animationEvent(this, Listener::BEGIN);
+                listener++;
+            }
+        }
     }
 
-    return false;
+    // Notify any listeners of Animation events.
+    if (_listeners)
+    {
+        GP_ASSERT(_listenerItr);
+
+        if (_speed >= 0.0f)
+        {
+            while (*_listenerItr != _listeners->end() && _elapsedTime >= (long) (**_listenerItr)->_eventTime)
+            {
+                GP_ASSERT(_listenerItr);
+                GP_ASSERT(**_listenerItr);
+                GP_ASSERT((**_listenerItr)->_listener);
+
+                (**_listenerItr)->_listener->animationEvent(this, Listener::TIME);
+                ++*_listenerItr;
+            }
+        }
+        else
+        {
+            while (*_listenerItr != _listeners->begin() && _elapsedTime <= (long) (**_listenerItr)->_eventTime)
+            {
+                GP_ASSERT(_listenerItr);
+                GP_ASSERT(**_listenerItr);
+                GP_ASSERT((**_listenerItr)->_listener);
+
+                (**_listenerItr)->_listener->animationEvent(this, Listener::TIME);
+                --*_listenerItr;
+            }
+        }
+    }
 }
 
 void AnimationClip::onBegin()
@@ -544,22 +595,14 @@ void AnimationClip::onBegin()
             *_listenerItr = _listeners->end();
     }
     
-    // Notify begin listeners if any.
-    if (_beginListeners)
-    {
-        std::vector<Listener*>::iterator listener = _beginListeners->begin();
-        while (listener != _beginListeners->end())
-        {
-            GP_ASSERT(*listener);
-            (*listener)->animationEvent(this, Listener::BEGIN);
-            listener++;
-        }
-    }
+    // Begin listeners are notified once the first values have been applied.
+    _beginPending = true;
 }
 
 void AnimationClip::onEnd()
 {
     _blendWeight = 1.0f;
+    _beginPending = false;
     resetClipStateBit(CLIP_ALL_BITS);
 
     // Notify end listeners if any.
@@ -276,6 +276,17 @@ private:
     static const unsigned char CLIP_IS_PAUSED_BIT = 0x80;              // Bit representing if the clip is currently paused.
     static const unsigned char CLIP_ALL_BITS = 0xFF;                   // Bit mask for all the state bits.
 
+    /**
+     * Defines what remains to be done for a clip after it has been advanced.
+     */
+    enum UpdateResult
+    {
+        UPDATE_SKIP,            // The clip is paused; nothing to sample.
+        UPDATE_SAMPLE,          // The clip must be sampled and applied.
+        UPDATE_SAMPLE_AND_END,  // The clip must be sampled and applied, then ended.
+        UPDATE_END              // The clip must be ended without sampling.
+    };
+
     /**
      * ListenerEvent.
      *
@@ -351,6 +362,31 @@ private:
      */
     bool update(float elapsedTime);
 
+    /**
+     * Advances the clip's time and blend weights by the elapsed time.
+     * This is the first phase of update(); it must run on the main thread.
+     * No listeners are notified, they are notified by notifyListeners().
+     */
+    UpdateResult advance(float elapsedTime);
+
+    /**
+     * Evaluates the curves of the channels in [begin, end) at the clip's current time.
+     * Only this clip's values are written, so different clips (and disjoint channel
+     * ranges of one clip) may be sampled concurrently.
+     */
+    void sample(unsigned int begin, unsigned int end);
+
+    /**
+     * Sets the sampled values on the animation targets, weighted by the blend weight.
+     */
+    void apply();
+
+    /**
+     * Notifies the begin and time event listeners of the events reached by the last advance.
+     * This is called after the sampled values have been applied.
+     */
+    void notifyListeners();
+
     /**
      * Handles when the AnimationClip begins.
      */
@@ -401,6 +437,9 @@ private:
     unsigned long _crossFadeOutDuration;                // The duration of the cross fade.
     float _blendWeight;                                 // The clip's blendweight.
     std::vector<AnimationValue*> _values;               // AnimationValue holder.
+    std::vector<unsigned int> _keyIndices;              // The key index last sampled for each channel.
+    float _percentComplete;                             // The position on the curves sampled by the last update.
+    bool _beginPending;                                 // Whether the begin listeners are still to be notified.
     std::vector<Listener*>* _beginListeners;            // Collection of begin listeners on the clip.
     std::vector<Listener*>* _endListeners;              // Collection of end listeners on the clip.
     std::list<ListenerEvent*>* _listeners;              // Ordered collection of listeners on the clip.
@@ -2,12 +2,16 @@
 #include "AnimationController.h"
 #include "Game.h"
 #include "Curve.h"
+#include "ThreadPool.h"
+
+// The maximum number of channels sampled by one task of the batched sampling pass.
+#define ANIMATION_SAMPLE_CHANNELS_PER_TASK 32
 
 namespace gameplay
 {
 
 AnimationController::AnimationController()
-    : _state(STOPPED)
+    : _state(STOPPED), _updating(false)
 {
 }
 
@@ -21,8 +25,8 @@ void AnimationController::stopAllAnimations()
     while (clipIter != _runningClips.end())
     {
         AnimationClip* clip = *clipIter;
-        GP_ASSERT(clip);
-        clip->stop();
+        if (clip)
+            clip->stop();
         clipIter++;
     }
 }
@@ -82,8 +86,17 @@ void AnimationController::unschedule(AnimationClip* clip)
         AnimationClip* rClip = (*clipItr);
         if (rClip == clip)
         {
-            _runningClips.erase(clipItr);
-            SAFE_RELEASE(clip);
+            if (_updating)
+            {
+                // Keep the entry and the clip until update() ends, it may still refer to them.
+                *clipItr = NULL;
+                _unscheduledClips.push_back(clip);
+            }
+            else
+            {
+                _runningClips.erase(clipItr);
+                SAFE_RELEASE(clip);
+            }
             break;
         }
         clipItr++;
@@ -93,6 +106,16 @@ void AnimationController::unschedule(AnimationClip* clip)
         _state = IDLE;
 }
 
+void AnimationController::sampleTasks(unsigned int begin, unsigned int end, void* tasks)
+{
+    const SampleTask* t = static_cast<const SampleTask*>(tasks);
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        GP_ASSERT(t[i].clip);
+        t[i].clip->sample(t[i].begin, t[i].end);
+    }
+}
+
 void AnimationController::update(float elapsedTime)
 {
     if (_state != RUNNING)
@@ -100,31 +123,112 @@ void AnimationController::update(float elapsedTime)
 
     Transform::suspendTransformChanged();
 
-    // Loop through running clips and call update() on them.
+    // Clips are updated in three passes: they are first advanced in order (which updates
+    // their time and cross fade weights), then the channels of all advanced clips are sampled
+    // in one batched pass spread over the thread pool, and finally the sampled values are
+    // applied to their targets in order, followed by the clip's listener events.
+    //
+    // Listeners may unschedule clips (by releasing their Animation) while the clips are being
+    // updated. Until the update ends, unscheduled and ended clips are only cleared from the
+    // running clips list, so that the iterators kept in _sampledClips stay valid.
+    _sampledClips.clear();
+    _sampleTasks.clear();
+    _updating = true;
+
     std::list<AnimationClip*>::iterator clipIter = _runningClips.begin();
     while (clipIter != _runningClips.end())
     {
         AnimationClip* clip = (*clipIter);
-        GP_ASSERT(clip);
+        if (!clip)
+        {
+            clipIter++;
+            continue;
+        }
+
         if (clip->isClipStateBitSet(AnimationClip::CLIP_IS_RESTARTED_BIT))
         {   // If the CLIP_IS_RESTARTED_BIT is set, we should end the clip and 
             // move it from where it is in the running clips list to the back.
             clip->onEnd();
-            clip->setClipStateBit(AnimationClip::CLIP_IS_PLAYING_BIT);
-            _runningClips.push_back(clip);
-            clipIter = _runningClips.erase(clipIter);
+            if (*clipIter == clip)
+            {
+                clip->setClipStateBit(AnimationClip::CLIP_IS_PLAYING_BIT);
+                _runningClips.push_back(clip);
+                *clipIter = NULL;
+            }
         }
-        else if (clip->update(elapsedTime))
+        else
         {
-            SAFE_RELEASE(clip);
-            clipIter = _runningClips.erase(clipIter);
+            AnimationClip::UpdateResult result = clip->advance(elapsedTime);
+            if (result == AnimationClip::UPDATE_END)
+            {
+                clip->onEnd();
+                if (*clipIter == clip)
+                {
+                    *clipIter = NULL;
+                    SAFE_RELEASE(clip);
+                }
+            }
+            else if (result != AnimationClip::UPDATE_SKIP)
+            {
+                SampledClip sampled;
+                sampled.iterator = clipIter;
+                sampled.end = (result == AnimationClip::UPDATE_SAMPLE_AND_END);
+                _sampledClips.push_back(sampled);
+
+                for (unsigned int begin = 0, channelCount = clip->_values.size(); begin < channelCount; begin += ANIMATION_SAMPLE_CHANNELS_PER_TASK)
+                {
+                    SampleTask task;
+                    task.clip = clip;
+                    task.begin = begin;
+                    task.end = std::min(begin + ANIMATION_SAMPLE_CHANNELS_PER_TASK, channelCount);
+                    _sampleTasks.push_back(task);
+                }
+            }
         }
+        clipIter++;
+    }
+
+    // Sample the channels of all advanced clips.
+    if (!_sampleTasks.empty())
+    {
+        ThreadPool* pool = Game::getInstance()->getThreadPool();
+        if (pool)
+            pool->parallelFor(_sampleTasks.size(), sampleTasks, &_sampleTasks[0]);
         else
+            sampleTasks(0, _sampleTasks.size(), &_sampleTasks[0]);
+    }
+
+    // Apply the sampled values, notify the listeners and end the clips that completed.
+    for (unsigned int i = 0, count = _sampledClips.size(); i < count; ++i)
+    {
+        std::list<AnimationClip*>::iterator itr = _sampledClips[i].iterator;
+        AnimationClip* clip = *itr;
+        if (!clip)
+            continue;
+
+        clip->apply();
+        clip->notifyListeners();
+
+        if (_sampledClips[i].end && *itr == clip)
         {
-            clipIter++;
+            clip->onEnd();
+            if (*itr == clip)
+            {
+                *itr = NULL;
+                SAFE_RELEASE(clip);
+            }
         }
     }
 
+    // Remove the cleared entries and release the clips unscheduled during the update.
+    _updating = false;
+    _runningClips.remove(NULL);
+    for (unsigned int i = 0, count = _unscheduledClips.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_unscheduledClips[i]);
+    }
+    _unscheduledClips.clear();
+
     Transform::resumeTransformChanged();
 
     if (_runningClips.empty())
@@ -39,6 +39,25 @@ private:
         STOPPED
     };
 
+    /**
+     * A clip that was advanced this frame and has to be applied.
+     */
+    struct SampledClip
+    {
+        std::list<AnimationClip*>::iterator iterator;
+        bool end;
+    };
+
+    /**
+     * A range of channels of a clip, sampled as one task of the batched sampling pass.
+     */
+    struct SampleTask
+    {
+        AnimationClip* clip;
+        unsigned int begin;
+        unsigned int end;
+    };
+
     /**
      * Constructor.
      */
@@ -95,9 +114,18 @@ private:
      * Callback for when the controller receives a frame update event.
      */
     void update(float elapsedTime);
+
+    /**
+     * Samples the given range of sample tasks. Runs on the thread pool.
+     */
+    static void sampleTasks(unsigned int begin, unsigned int end, void* tasks);
     
     State _state;                                 // The current state of the AnimationController.
     std::list<AnimationClip*> _runningClips;      // A list of running AnimationClips.
+    std::vector<SampledClip> _sampledClips;       // The clips advanced in the current update.
+    std::vector<SampleTask> _sampleTasks;         // The sampling work of the current update.
+    std::vector<AnimationClip*> _unscheduledClips; // The clips unscheduled during the current update.
+    bool _updating;                               // Whether update() is in progress.
 };
 
 }
@@ -0,0 +1,453 @@
+#include "Base.h"
+#include "AssetLoader.h"
+#include "Game.h"
+#include "Texture.h"
+#include "Image.h"
+#include "AudioBuffer.h"
+#include "Properties.h"
+#include "Bundle.h"
+#include "Scene.h"
+#include "FileSystem.h"
+#include "ThreadPool.h"
+
+// Default time that update() may spend finalizing requests per frame, in milliseconds.
+#define ASSET_LOADER_DEFAULT_FRAME_BUDGET 4.0f
+
+namespace gameplay
+{
+
+// Returns whether the path names a PNG file, which is decoded in the background.
+static bool isPNG(const char* path)
+{
+    const char* ext = strrchr(FileSystem::resolvePath(path), '.');
+    return ext && strlen(ext) == 4 && tolower(ext[1]) == 'p' && tolower(ext[2]) == 'n' && tolower(ext[3]) == 'g';
+}
+
+AssetLoader::AssetLoader()
+    : _pool(NULL), _frameBudget(ASSET_LOADER_DEFAULT_FRAME_BUDGET)
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+    // Fail the requests whose background step has not started before waiting for any other.
+    std::list<Request*>::iterator itr;
+    for (itr = _requests.begin(); itr != _requests.end(); ++itr)
+    {
+        if (_pool && _pool->cancel(*itr))
+            (*itr)->_state = FAILED;
+    }
+
+    for (itr = _requests.begin(); itr != _requests.end(); ++itr)
+    {
+        Request* request = *itr;
+        if (request->_state == PENDING)
+        {
+            if (_pool)
+                _pool->wait(request);
+
+            if (request->_type == CUSTOM && request->_loaded)
+            {
+                // Hand the data to the finalize function, which owns it.
+                request->_listener = NULL;
+                request->finalize();
+            }
+            else
+            {
+                request->discardData();
+                request->_state = FAILED;
+            }
+        }
+        request->release();
+    }
+    _requests.clear();
+}
+
+AssetLoader* AssetLoader::create(ThreadPool* pool)
+{
+    AssetLoader* loader = new AssetLoader();
+    loader->_pool = pool;
+    return loader;
+}
+
+AssetLoader::Request* AssetLoader::loadTexture(const char* path, bool generateMipmaps, Listener* listener)
+{
+    GP_ASSERT(path);
+
+    Request* request = new Request(TEXTURE, path);
+    request->_generateMipmaps = generateMipmaps;
+    return submit(request, listener);
+}
+
+AssetLoader::Request* AssetLoader::loadAudioBuffer(const char* path, Listener* listener)
+{
+    GP_ASSERT(path);
+
+    return submit(new Request(AUDIO_BUFFER, path), listener);
+}
+
+AssetLoader::Request* AssetLoader::loadProperties(const char* url, Listener* listener)
+{
+    GP_ASSERT(url);
+
+    return submit(new Request(PROPERTIES, url), listener);
+}
+
+AssetLoader::Request* AssetLoader::loadBundle(const char* path, Listener* listener)
+{
+    GP_ASSERT(path);
+
+    return submit(new Request(BUNDLE, path), listener);
+}
+
+AssetLoader::Request* AssetLoader::loadScene(const char* path, const char* id, Listener* listener)
+{
+    GP_ASSERT(path);
+
+    Request* request = new Request(SCENE, path);
+    if (id)
+        request->_sceneId = id;
+    return submit(request, listener);
+}
+
+AssetLoader::Request* AssetLoader::load(const char* path, LoadFunction load, FinalizeFunction finalize, void* cookie, Listener* listener)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(load);
+
+    Request* request = new Request(CUSTOM, path);
+    request->_loadFunction = load;
+    request->_finalizeFunction = finalize;
+    request->_cookie = cookie;
+    return submit(request, listener);
+}
+
+AssetLoader::Request* AssetLoader::submit(Request* request, Listener* listener)
+{
+    GP_ASSERT(request);
+
+    request->_listener = listener;
+
+    // The loader holds its own reference, so that callers may release requests at any time.
+    request->addRef();
+    _requests.push_back(request);
+
+    // Without worker threads the request is loaded here and finalized on the next update.
+    if (_pool)
+        _pool->run(loadRequest, request);
+    else
+        request->load();
+
+    return request;
+}
+
+void AssetLoader::setFrameBudget(float milliseconds)
+{
+    _frameBudget = milliseconds;
+}
+
+float AssetLoader::getFrameBudget() const
+{
+    return _frameBudget;
+}
+
+unsigned int AssetLoader::getPendingCount() const
+{
+    return _requests.size();
+}
+
+void AssetLoader::update()
+{
+    if (!_requests.empty())
+    {
+        finalizeLoaded(Game::getAbsoluteTime() + _frameBudget);
+    }
+}
+
+void AssetLoader::finish()
+{
+    while (!_requests.empty())
+    {
+        Request* request = _requests.front();
+        _requests.pop_front();
+
+        if (_pool)
+            _pool->wait(request);
+        request->finalize();
+        request->release();
+    }
+}
+
+void AssetLoader::finalizeLoaded(double endTime)
+{
+    // Finalize at least one request, then as many as fit in the remaining time, in the
+    // order they were submitted, skipping those whose background step is not done yet.
+    bool first = true;
+    std::list<Request*>::iterator itr = _requests.begin();
+    while (itr != _requests.end() && (first || Game::getAbsoluteTime() < endTime))
+    {
+        Request* request = *itr;
+        if (_pool && _pool->hasTask(request))
+        {
+            ++itr;
+            continue;
+        }
+
+        itr = _requests.erase(itr);
+        request->finalize();
+        request->release();
+        first = false;
+    }
+}
+
+void AssetLoader::loadRequest(void* request)
+{
+    GP_ASSERT(request);
+    static_cast<Request*>(request)->load();
+}
+
+AssetLoader::Request::Request(Type type, const char* path)
+    : _type(type), _path(path), _state(PENDING), _generateMipmaps(false), _compressed(false), _loadFunction(NULL), _finalizeFunction(NULL),
+      _cookie(NULL), _data(NULL), _loaded(false), _result(NULL), _listener(NULL)
+{
+}
+
+AssetLoader::Request::~Request()
+{
+    switch (_type)
+    {
+    case TEXTURE:
+        {
+            Texture* texture = static_cast<Texture*>(_result);
+            SAFE_RELEASE(texture);
+        }
+        break;
+    case AUDIO_BUFFER:
+        {
+            AudioBuffer* buffer = static_cast<AudioBuffer*>(_result);
+            SAFE_RELEASE(buffer);
+        }
+        break;
+    case PROPERTIES:
+        {
+            Properties* properties = static_cast<Properties*>(_result);
+            SAFE_DELETE(properties);
+        }
+        break;
+    case BUNDLE:
+        {
+            Bundle* bundle = static_cast<Bundle*>(_result);
+            SAFE_RELEASE(bundle);
+        }
+        break;
+    case SCENE:
+        {
+            Scene* scene = static_cast<Scene*>(_result);
+            SAFE_RELEASE(scene);
+        }
+        break;
+    default:
+        // Custom results belong to the caller.
+        break;
+    }
+}
+
+AssetLoader::Type AssetLoader::Request::getType() const
+{
+    return _type;
+}
+
+const char* AssetLoader::Request::getPath() const
+{
+    return _path.c_str();
+}
+
+AssetLoader::State AssetLoader::Request::getState() const
+{
+    return _state;
+}
+
+bool AssetLoader::Request::isDone() const
+{
+    return _state != PENDING;
+}
+
+Texture* AssetLoader::Request::getTexture() const
+{
+    return (_type == TEXTURE && _state == COMPLETE) ? static_cast<Texture*>(_result) : NULL;
+}
+
+AudioBuffer* AssetLoader::Request::getAudioBuffer() const
+{
+    return (_type == AUDIO_BUFFER && _state == COMPLETE) ? static_cast<AudioBuffer*>(_result) : NULL;
+}
+
+Properties* AssetLoader::Request::getProperties() const
+{
+    return (_type == PROPERTIES && _state == COMPLETE) ? static_cast<Properties*>(_result) : NULL;
+}
+
+Bundle* AssetLoader::Request::getBundle() const
+{
+    return (_type == BUNDLE && _state == COMPLETE) ? static_cast<Bundle*>(_result) : NULL;
+}
+
+Scene* AssetLoader::Request::getScene() const
+{
+    return (_type == SCENE && _state == COMPLETE) ? static_cast<Scene*>(_result) : NULL;
+}
+
+void* AssetLoader::Request::getResult() const
+{
+    return (_type == CUSTOM && _state == COMPLETE) ? _result : NULL;
+}
+
+void AssetLoader::Request::load()
+{
+    const char* path = _path.c_str();
+    switch (_type)
+    {
+    case TEXTURE:
+        // PNG images are decoded; compressed textures are read as they are uploaded.
+        if (isPNG(path))
+        {
+            _data = Image::create(path);
+        }
+        else
+        {
+            _data = Texture::readCompressed(path);
+            _compressed = true;
+        }
+        _loaded = _data != NULL;
+        break;
+    case AUDIO_BUFFER:
+        {
+            AudioBuffer::Samples* samples = new AudioBuffer::Samples();
+            if (AudioBuffer::decode(path, samples))
+            {
+                _data = samples;
+                _loaded = true;
+            }
+            else
+            {
+                SAFE_DELETE(samples);
+            }
+        }
+        break;
+    case PROPERTIES:
+        _result = Properties::create(path);
+        _loaded = _result != NULL;
+        break;
+    case BUNDLE:
+        // Bundle::create() would look at the bundle cache, which belongs to the main thread.
+        _result = Bundle::open(path);
+        _loaded = _result != NULL;
+        break;
+    case SCENE:
+        {
+            Bundle* bundle = Bundle::open(path);
+            if (bundle && bundle->preloadMeshes())
+            {
+                _data = bundle;
+                _loaded = true;
+            }
+            else
+            {
+                SAFE_RELEASE(bundle);
+            }
+        }
+        break;
+    case CUSTOM:
+        GP_ASSERT(_loadFunction);
+        _data = _loadFunction(path, _cookie);
+        _loaded = _data != NULL;
+        break;
+    }
+}
+
+void AssetLoader::Request::finalize()
+{
+    const char* path = _path.c_str();
+    if (_loaded)
+    {
+        switch (_type)
+        {
+        case TEXTURE:
+            GP_ASSERT(_data);
+            if (_compressed)
+            {
+                _result = Texture::create(path, static_cast<Texture::CompressedData*>(_data), _generateMipmaps);
+            }
+            else
+            {
+                _result = Texture::create(path, static_cast<Image*>(_data), _generateMipmaps);
+            }
+            break;
+        case AUDIO_BUFFER:
+            GP_ASSERT(_data);
+            _result = AudioBuffer::create(path, *static_cast<AudioBuffer::Samples*>(_data));
+            break;
+        case PROPERTIES:
+        case BUNDLE:
+            // Fully loaded in the background.
+            break;
+        case SCENE:
+            GP_ASSERT(_data);
+            _result = static_cast<Bundle*>(_data)->loadScene(_sceneId.empty() ? NULL : _sceneId.c_str());
+            break;
+        case CUSTOM:
+            _result = _finalizeFunction ? _finalizeFunction(_data, _cookie) : _data;
+            _data = NULL;
+            break;
+        }
+    }
+    discardData();
+
+    _state = _result ? COMPLETE : FAILED;
+    if (_state == FAILED)
+    {
+        GP_WARN("Failed to load asset '%s'.", path);
+    }
+
+    if (_listener)
+    {
+        _listener->assetLoaded(this);
+    }
+}
+
+void AssetLoader::Request::discardData()
+{
+    switch (_type)
+    {
+    case TEXTURE:
+        if (_compressed)
+        {
+            Texture::CompressedData* compressedData = static_cast<Texture::CompressedData*>(_data);
+            SAFE_DELETE(compressedData);
+        }
+        else
+        {
+            Image* image = static_cast<Image*>(_data);
+            SAFE_RELEASE(image);
+        }
+        break;
+    case SCENE:
+        {
+            Bundle* bundle = static_cast<Bundle*>(_data);
+            SAFE_RELEASE(bundle);
+        }
+        break;
+    case AUDIO_BUFFER:
+        {
+            AudioBuffer::Samples* samples = static_cast<AudioBuffer::Samples*>(_data);
+            SAFE_DELETE(samples);
+        }
+        break;
+    default:
+        // Custom data that was never finalized belongs to the caller.
+        break;
+    }
+    _data = NULL;
+}
+
+}
@@ -0,0 +1,411 @@
+#ifndef ASSETLOADER_H_
+#define ASSETLOADER_H_
+
+#include "Ref.h"
+
+namespace gameplay
+{
+
+class Texture;
+class AudioBuffer;
+class Properties;
+class Bundle;
+class Scene;
+class ThreadPool;
+
+/**
+ * Defines a service that loads assets in the background.
+ *
+ * Each load is split in two steps. The first step (file I/O, image and audio
+ * decoding, parsing) runs as a background task on a ThreadPool, normally the
+ * game's shared pool. The second step, which creates the engine, OpenGL and
+ * OpenAL objects, runs on the main thread from update(),
+ * which the game calls once per frame and which stops once its time budget for
+ * the frame is spent. Until both steps are done a request is pending; then it is
+ * complete or failed, and its listener (if any) is notified from update().
+ *
+ * Custom loads supply both steps as functions, which also allows the loader to be
+ * driven without a graphics context (for example with a finalize step that only
+ * records its input).
+ *
+ * Loads that share static caches (textures, audio buffers) must be issued from the
+ * main thread, as must all other calls on the loader.
+ */
+class AssetLoader
+{
+public:
+
+    /**
+     * The kinds of assets that can be loaded.
+     */
+    enum Type
+    {
+        TEXTURE,
+        AUDIO_BUFFER,
+        PROPERTIES,
+        BUNDLE,
+        SCENE,
+        CUSTOM
+    };
+
+    /**
+     * The states of a load request.
+     */
+    enum State
+    {
+        PENDING,
+        COMPLETE,
+        FAILED
+    };
+
+    /**
+     * The function type of the background step of a custom load.
+     *
+     * @param path The path passed to load().
+     * @param cookie The user data passed to load().
+     *
+     * @return The loaded data, passed to the finalize function, or NULL if the load failed.
+     */
+    typedef void* (*LoadFunction)(const char* path, void* cookie);
+
+    /**
+     * The function type of the main thread step of a custom load.
+     *
+     * @param data The data returned by the load function.
+     * @param cookie The user data passed to load().
+     *
+     * @return The result of the request, or NULL if the load failed.
+     */
+    typedef void* (*FinalizeFunction)(void* data, void* cookie);
+
+    class Listener;
+
+    /**
+     * Defines a request to load an asset, which acts as its future.
+     *
+     * The result of a request is owned by the request: callers that keep a texture,
+     * audio buffer or bundle beyond the lifetime of the request must add a reference
+     * to it. Properties are deleted with the request.
+     */
+    class Request : public Ref
+    {
+        friend class AssetLoader;
+
+    public:
+
+        /**
+         * Returns the type of asset being loaded.
+         *
+         * @return The type of asset.
+         */
+        Type getType() const;
+
+        /**
+         * Returns the path of the asset being loaded.
+         *
+         * @return The path of the asset.
+         */
+        const char* getPath() const;
+
+        /**
+         * Returns the state of the request.
+         *
+         * @return The state of the request.
+         */
+        State getState() const;
+
+        /**
+         * Determines whether the request has completed or failed.
+         *
+         * @return true if the request is no longer pending.
+         */
+        bool isDone() const;
+
+        /**
+         * Returns the loaded texture.
+         *
+         * @return The texture, or NULL if the request is not a completed texture load.
+         */
+        Texture* getTexture() const;
+
+        /**
+         * Returns the loaded audio buffer.
+         *
+         * @return The audio buffer, or NULL if the request is not a completed audio buffer load.
+         */
+        AudioBuffer* getAudioBuffer() const;
+
+        /**
+         * Returns the loaded properties.
+         *
+         * @return The properties, or NULL if the request is not a completed properties load.
+         */
+        Properties* getProperties() const;
+
+        /**
+         * Returns the loaded bundle.
+         *
+         * @return The bundle, or NULL if the request is not a completed bundle load.
+         */
+        Bundle* getBundle() const;
+
+        /**
+         * Returns the loaded scene.
+         *
+         * @return The scene, or NULL if the request is not a completed scene load.
+         */
+        Scene* getScene() const;
+
+        /**
+         * Returns the result of a custom load, as returned by its finalize function.
+         *
+         * @return The result, or NULL if the request is not a completed custom load.
+         */
+        void* getResult() const;
+
+    private:
+
+        /**
+         * Constructor.
+         */
+        Request(Type type, const char* path);
+
+        /**
+         * Destructor.
+         */
+        ~Request();
+
+        /**
+         * Hidden copy constructor.
+         */
+        Request(const Request& copy);
+
+        /**
+         * Hidden copy assignment operator.
+         */
+        Request& operator=(const Request&);
+
+        /**
+         * Runs the background step of the load. Called on a worker thread.
+         * It must not touch anything shared with the main thread.
+         */
+        void load();
+
+        /**
+         * Runs the main thread step of the load and notifies the listener.
+         */
+        void finalize();
+
+        /**
+         * Frees the data of a background step whose main thread step never ran.
+         */
+        void discardData();
+
+        Type _type;
+        std::string _path;
+        std::string _sceneId;
+        State _state;
+        bool _generateMipmaps;
+        bool _compressed;
+        LoadFunction _loadFunction;
+        FinalizeFunction _finalizeFunction;
+        void* _cookie;
+        void* _data;
+        bool _loaded;
+        void* _result;
+        Listener* _listener;
+    };
+
+    /**
+     * Defines an interface for being notified when a load request completes or fails.
+     */
+    class Listener
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Listener() { }
+
+        /**
+         * Called on the main thread when a request completes or fails.
+         *
+         * @param request The request.
+         */
+        virtual void assetLoaded(Request* request) = 0;
+    };
+
+    /**
+     * Creates a new asset loader.
+     *
+     * @param pool The thread pool that runs the background steps. If NULL, or if the
+     *      pool has no worker threads, the background step of each request runs when
+     *      it is submitted. The pool must outlive the loader.
+     *
+     * @return A new asset loader.
+     */
+    static AssetLoader* create(ThreadPool* pool);
+
+    /**
+     * Destructor. Requests whose background step has not started are failed, and
+     * those whose background step is running are waited for. Then custom requests
+     * that were loaded are finalized, so that their data is handed to the finalize
+     * function, and all other pending requests are failed and their data freed.
+     * Listeners are not notified.
+     */
+    ~AssetLoader();
+
+    /**
+     * Loads a texture, as Texture::create(const char*, bool) does.
+     *
+     * PNG images are decoded and compressed (PVR, DDS) texture files are read in the
+     * background. Only the texture upload happens in the main thread step.
+     *
+     * @param path The path of the texture file.
+     * @param generateMipmaps true to auto-generate a full mipmap chain, false otherwise.
+     * @param listener The listener to notify when the request completes or fails, or NULL.
+     *
+     * @return The request. The caller owns a reference to it.
+     */
+    Request* loadTexture(const char* path, bool generateMipmaps = false, Listener* listener = NULL);
+
+    /**
+     * Loads an audio buffer, decoding the wav or ogg file in the background.
+     *
+     * @param path The path of the audio file.
+     * @param listener The listener to notify when the request completes or fails, or NULL.
+     *
+     * @return The request. The caller owns a reference to it.
+     */
+    Request* loadAudioBuffer(const char* path, Listener* listener = NULL);
+
+    /**
+     * Loads properties, parsing them in the background.
+     *
+     * @param url The URL of the properties, as passed to Properties::create().
+     * @param listener The listener to notify when the request completes or fails, or NULL.
+     *
+     * @return The request. The caller owns a reference to it.
+     */
+    Request* loadProperties(const char* url, Listener* listener = NULL);
+
+    /**
+     * Opens a bundle, reading its header and reference table in the background.
+     *
+     * Objects are then loaded from the bundle on the main thread, as they create
+     * graphics objects.
+     *
+     * @param path The path of the bundle file.
+     * @param listener The listener to notify when the request completes or fails, or NULL.
+     *
+     * @return The request. The caller owns a reference to it.
+     */
+    Request* loadBundle(const char* path, Listener* listener = NULL);
+
+    /**
+     * Loads a scene from a bundle, as Bundle::loadScene() does.
+     *
+     * The bundle is opened and the data of all of its meshes is read and decoded in the
+     * background. The main thread step then builds the scene's nodes, models, cameras,
+     * lights and animations from the bundle, and creates the vertex and index buffers
+     * from the mesh data that was already read. The engine objects are created there
+     * because their construction registers them with state owned by the main thread.
+     *
+     * @param path The path of the bundle file.
+     * @param id The ID of the scene to load, or NULL to load the first scene of the bundle.
+     * @param listener The listener to notify when the request completes or fails, or NULL.
+     *
+     * @return The request. The caller owns a reference to it.
+     */
+    Request* loadScene(const char* path, const char* id = NULL, Listener* listener = NULL);
+
+    /**
+     * Runs a custom load.
+     *
+     * @param path The path of the asset, passed to the load function.
+     * @param load The function to run in the background.
+     * @param finalize The function to run on the main thread, or NULL to use the data
+     *      returned by the load function as the result. If the loader is destroyed after
+     *      the load function returned data, the finalize function is still called, from
+     *      the destructor.
+     * @param cookie User data passed to both functions.
+     * @param listener The listener to notify when the request completes or fails, or NULL.
+     *
+     * @return The request. The caller owns a reference to it.
+     */
+    Request* load(const char* path, LoadFunction load, FinalizeFunction finalize, void* cookie, Listener* listener = NULL);
+
+    /**
+     * Sets the time that update() may spend finalizing requests in a frame.
+     *
+     * @param milliseconds The time budget, in milliseconds.
+     */
+    void setFrameBudget(float milliseconds);
+
+    /**
+     * Returns the time that update() may spend finalizing requests in a frame.
+     *
+     * @return The time budget, in milliseconds.
+     */
+    float getFrameBudget() const;
+
+    /**
+     * Returns the number of requests that are still pending.
+     *
+     * @return The number of pending requests.
+     */
+    unsigned int getPendingCount() const;
+
+    /**
+     * Runs the main thread step of the requests whose background step has finished,
+     * until the frame budget is spent. At least one request is finalized per call.
+     */
+    void update();
+
+    /**
+     * Blocks until all pending requests have completed or failed, finalizing them
+     * regardless of the frame budget.
+     */
+    void finish();
+
+private:
+
+    /**
+     * Constructor.
+     */
+    AssetLoader();
+
+    /**
+     * Hidden copy constructor.
+     */
+    AssetLoader(const AssetLoader& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    AssetLoader& operator=(const AssetLoader&);
+
+    /**
+     * Queues a request for its background step.
+     */
+    Request* submit(Request* request, Listener* listener);
+
+    /**
+     * Finalizes the requests whose background step has finished, until the given absolute time.
+     */
+    void finalizeLoaded(double endTime);
+
+    /**
+     * Runs the background step of a request. Runs on the thread pool.
+     */
+    static void loadRequest(void* request);
+
+    ThreadPool* _pool;
+    std::list<Request*> _requests;
+    float _frameBudget;
+};
+
+}
+
+#endif
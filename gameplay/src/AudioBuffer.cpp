@@ -38,18 +38,26 @@ AudioBuffer* AudioBuffer::create(const char* path)
     GP_ASSERT(path);
 
     // Search the cache for a stream from this file.
-    unsigned int bufferCount = (unsigned int)__buffers.size();
-    AudioBuffer* buffer = NULL;
-    for (unsigned int i = 0; i < bufferCount; i++)
-    {
-        buffer = __buffers[i];
-        GP_ASSERT(buffer);
-        if (buffer->_filePath.compare(path) == 0)
-        {
-            buffer->addRef();
-            return buffer;
-        }
-    }
+    AudioBuffer* buffer = findCached(path);
+    if (buffer)
+        return buffer;
+
+    Samples samples;
+    if (!decode(path, &samples))
+        return NULL;
+
+    return create(path, samples);
+}
+
+AudioBuffer* AudioBuffer::create(const char* path, const Samples& samples)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(samples.data);
+
+    // The file may have been loaded by another request since it was decoded.
+    AudioBuffer* buffer = findCached(path);
+    if (buffer)
+        return buffer;
 
     ALuint alBuffer;
 
@@ -61,65 +69,84 @@ AudioBuffer* AudioBuffer::create(const char* path)
         AL_CHECK( alDeleteBuffers(1, &alBuffer) );
         return NULL;
     }
-    
+
+    AL_CHECK( alBufferData(alBuffer, samples.format, samples.data, samples.size, samples.frequency) );
+
+    buffer = new AudioBuffer(path, alBuffer);
+
+    // Add the buffer to the cache.
+    __buffers.push_back(buffer);
+
+    return buffer;
+}
+
+AudioBuffer* AudioBuffer::findCached(const char* path)
+{
+    for (unsigned int i = 0, bufferCount = (unsigned int)__buffers.size(); i < bufferCount; i++)
+    {
+        AudioBuffer* buffer = __buffers[i];
+        GP_ASSERT(buffer);
+        if (buffer->_filePath.compare(path) == 0)
+        {
+            buffer->addRef();
+            return buffer;
+        }
+    }
+    return NULL;
+}
+
+bool AudioBuffer::decode(const char* path, Samples* samples)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(samples);
+
     // Load sound file.
     FILE* file = FileSystem::openFile(path, "rb");
     if (!file)
     {
         GP_ERROR("Failed to load audio file %s.", path);
-        goto cleanup;
+        return false;
     }
-    
+
     // Read the file header
     char header[12];
     if (fread(header, 1, 12, file) != 12)
     {
         GP_ERROR("Invalid header for audio file %s.", path);
-        goto cleanup;
+        fclose(file);
+        return false;
     }
-    
+
     // Check the file format
     if (memcmp(header, "RIFF", 4) == 0)
     {
-        if (!AudioBuffer::loadWav(file, alBuffer))
+        bool loaded = AudioBuffer::loadWav(file, samples);
+        fclose(file);
+        if (!loaded)
         {
             GP_ERROR("Invalid wave file: %s", path);
-            goto cleanup;
+            return false;
         }
     }
     else if (memcmp(header, "OggS", 4) == 0)
     {
-        if (!AudioBuffer::loadOgg(file, alBuffer))
+        if (!AudioBuffer::loadOgg(file, samples))
         {
             GP_ERROR("Invalid ogg file: %s", path);
-            goto cleanup;
+            return false;
         }
     }
     else
     {
         GP_ERROR("Unsupported audio file: %s", path);
-        goto cleanup;
+        fclose(file);
+        return false;
     }
-    
-    fclose(file);
-
-    buffer = new AudioBuffer(path, alBuffer);
-
-    // Add the buffer to the cache.
-    __buffers.push_back(buffer);
 
-    return buffer;
-    
-cleanup:
-    
-    if (file)
-        fclose(file);
-    if (alBuffer)
-        AL_CHECK( alDeleteBuffers(1, &alBuffer) );
-    return NULL;
+    return true;
 }
 
-bool AudioBuffer::loadWav(FILE* file, ALuint buffer)
+bool AudioBuffer::loadWav(FILE* file, Samples* samples)
 {
     GP_ASSERT(file);
     unsigned char stream[12];
@@ -257,8 +284,10 @@ bool AudioBuffer::loadWav(FILE* file, ALuint buffer)
                 return false;
             }
 
-            AL_CHECK( alBufferData(buffer, format, data, dataSize, frequency) );
-            SAFE_DELETE_ARRAY(data);
+            samples->format = format;
+            samples->frequency = frequency;
+            samples->data = data;
+            samples->size = dataSize;
 
             // We've read the data, so return now.
             return true;
@@ -303,7 +332,7 @@ bool AudioBuffer::loadWav(FILE* file, ALuint buffer)
     }
 }
     
-bool AudioBuffer::loadOgg(FILE* file, ALuint buffer)
+bool AudioBuffer::loadOgg(FILE* file, Samples* samples)
 {
     GP_ASSERT(file);
 
@@ -344,6 +373,7 @@ bool AudioBuffer::loadOgg(FILE* file, ALuint buffer)
         else if (result < 0)
         {
             SAFE_DELETE_ARRAY(data);
+            ov_clear(&ogg_file);
             GP_ERROR("Failed to read ogg file; file is missing data.");
             return false;
         }
@@ -356,19 +386,30 @@ bool AudioBuffer::loadOgg(FILE* file, ALuint buffer)
     if (size == 0)
     {
         SAFE_DELETE_ARRAY(data);
+        ov_clear(&ogg_file);
         GP_ERROR("Filed to read ogg file; unable to read any data.");
         return false;
     }
 
-    AL_CHECK( alBufferData(buffer, format, data, data_size, info->rate) );
-
-    SAFE_DELETE_ARRAY(data);
-    ov_clear(&ogg_file);
+    samples->format = format;
+    samples->frequency = info->rate;
+    samples->data = data;
+    samples->size = data_size;
 
     // ov_clear actually closes the file pointer as well.
-    file = 0;
+    ov_clear(&ogg_file);
 
     return true;
 }
 
+AudioBuffer::Samples::Samples()
+    : format(0), frequency(0), data(NULL), size(0)
+{
+}
+
+AudioBuffer::Samples::~Samples()
+{
+    SAFE_DELETE_ARRAY(data);
+}
+
 }
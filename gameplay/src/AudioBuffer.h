@@ -16,8 +16,23 @@ class AudioSource;
 class AudioBuffer : public Ref
 {
     friend class AudioSource;
+    friend class AssetLoader;
 
 private:
+
+    /**
+     * Decoded audio samples, ready to be copied into an OpenAL buffer.
+     */
+    struct Samples
+    {
+        Samples();
+        ~Samples();
+
+        ALenum format;
+        ALsizei frequency;
+        char* data;
+        unsigned int size;
+    };
     
     /**
      * Constructor.
@@ -42,10 +57,39 @@ private:
      * @return The buffer from a file.
      */
     static AudioBuffer* create(const char* path);
-    
-    static bool loadWav(FILE* file, ALuint buffer);
-    
-    static bool loadOgg(FILE* file, ALuint buffer);
+
+    /**
+     * Creates an audio buffer for a file from its already decoded samples,
+     * or returns the cached buffer for the file.
+     *
+     * @param path The path to the audio file the samples were decoded from.
+     * @param samples The decoded samples.
+     *
+     * @return The buffer for the file.
+     */
+    static AudioBuffer* create(const char* path, const Samples& samples);
+
+    /**
+     * Reads and decodes an audio file. Makes no OpenAL calls, so it may run on any thread.
+     *
+     * @param path The path to the audio file.
+     * @param samples Populated with the decoded samples.
+     *
+     * @return true if the file was decoded, false otherwise.
+     */
+    static bool decode(const char* path, Samples* samples);
+
+    /**
+     * Returns the cached buffer for the file, with a reference added, or NULL if there is none.
+     */
+    static AudioBuffer* findCached(const char* path);
+
+    static bool loadWav(FILE* file, Samples* samples);
+
+    /**
+     * Decodes an ogg file. The file is always closed, whether decoding succeeds or not.
+     */
+    static bool loadOgg(FILE* file, Samples* samples);
 
     std::string _filePath;
     ALuint _alBuffer;
@@ -0,0 +1,466 @@
+#include "Base.h"
+#include "BoundingVolumeTree.h"
+
+// Fraction of an object's size that its fat box is enlarged by on every side.
+#define FAT_BOX_MARGIN 0.1f
+
+namespace gameplay
+{
+
+static float surfaceArea(const BoundingBox& box)
+{
+    float x = box.max.x - box.min.x;
+    float y = box.max.y - box.min.y;
+    float z = box.max.z - box.min.z;
+    return 2.0f * (x * y + y * z + z * x);
+}
+
+static void combine(const BoundingBox& a, const BoundingBox& b, BoundingBox* dst)
+{
+    dst->min.set(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z));
+    dst->max.set(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z));
+}
+
+static bool contains(const BoundingBox& outer, const BoundingBox& inner)
+{
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+           outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+static void fatten(const BoundingBox& box, BoundingBox* dst)
+{
+    float margin = std::max(std::max(box.max.x - box.min.x, box.max.y - box.min.y), box.max.z - box.min.z) * FAT_BOX_MARGIN;
+    dst->min.set(box.min.x - margin, box.min.y - margin, box.min.z - margin);
+    dst->max.set(box.max.x + margin, box.max.y + margin, box.max.z + margin);
+}
+
+static bool overlaps(const BoundingBox& box, const Frustum& frustum)
+{
+    return frustum.intersects(box);
+}
+
+static bool overlaps(const BoundingBox& box, const BoundingSphere& sphere)
+{
+    return sphere.intersects(box);
+}
+
+static bool overlaps(const BoundingBox& box, const Ray& ray)
+{
+    return ray.intersects(box) != Ray::INTERSECTS_NONE;
+}
+
+BoundingVolumeTree::BoundingVolumeTree()
+    : _root(NULL_PROXY), _freeList(NULL_PROXY), _proxyCount(0)
+{
+}
+
+BoundingVolumeTree::~BoundingVolumeTree()
+{
+}
+
+int BoundingVolumeTree::createProxy(const BoundingBox& box, void* userData)
+{
+    int proxy = allocateNode();
+    TreeNode& node = _nodes[proxy];
+    fatten(box, &node.box);
+    node.userData = userData;
+    node.height = 0;
+
+    insertLeaf(proxy);
+    ++_proxyCount;
+
+    return proxy;
+}
+
+void BoundingVolumeTree::destroyProxy(int proxy)
+{
+    GP_ASSERT(isProxy(proxy));
+
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --_proxyCount;
+}
+
+bool BoundingVolumeTree::moveProxy(int proxy, const BoundingBox& box)
+{
+    GP_ASSERT(isProxy(proxy));
+
+    if (contains(_nodes[proxy].box, box))
+        return false;
+
+    removeLeaf(proxy);
+    fatten(box, &_nodes[proxy].box);
+    insertLeaf(proxy);
+
+    return true;
+}
+
+bool BoundingVolumeTree::isProxy(int proxy) const
+{
+    return proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].height == 0;
+}
+
+void* BoundingVolumeTree::getUserData(int proxy) const
+{
+    GP_ASSERT(isProxy(proxy));
+    return _nodes[proxy].userData;
+}
+
+const BoundingBox& BoundingVolumeTree::getFatBox(int proxy) const
+{
+    GP_ASSERT(isProxy(proxy));
+    return _nodes[proxy].box;
+}
+
+unsigned int BoundingVolumeTree::getProxyCount() const
+{
+    return _proxyCount;
+}
+
+int BoundingVolumeTree::getHeight() const
+{
+    return _root == NULL_PROXY ? 0 : _nodes[_root].height;
+}
+
+void BoundingVolumeTree::clear()
+{
+    _nodes.clear();
+    _root = NULL_PROXY;
+    _freeList = NULL_PROXY;
+    _proxyCount = 0;
+}
+
+void BoundingVolumeTree::query(const Frustum& frustum, std::vector<int>& proxies) const
+{
+    queryVolume(frustum, proxies);
+}
+
+void BoundingVolumeTree::query(const BoundingSphere& sphere, std::vector<int>& proxies) const
+{
+    queryVolume(sphere, proxies);
+}
+
+void BoundingVolumeTree::query(const Ray& ray, std::vector<int>& proxies) const
+{
+    queryVolume(ray, proxies);
+}
+
+template <class T>
+void BoundingVolumeTree::queryVolume(const T& volume, std::vector<int>& proxies) const
+{
+    if (_root == NULL_PROXY)
+        return;
+
+    // The tree is kept balanced, so its height bounds the size of the traversal stack.
+    std::vector<int> stack;
+    stack.reserve(_nodes[_root].height + 1);
+    stack.push_back(_root);
+
+    while (!stack.empty())
+    {
+        int index = stack.back();
+        stack.pop_back();
+
+        const TreeNode& node = _nodes[index];
+        if (!overlaps(node.box, volume))
+            continue;
+
+        if (node.height == 0)
+        {
+            proxies.push_back(index);
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+int BoundingVolumeTree::allocateNode()
+{
+    int index;
+    if (_freeList != NULL_PROXY)
+    {
+        index = _freeList;
+        _freeList = _nodes[index].parent;
+    }
+    else
+    {
+        index = (int)_nodes.size();
+        _nodes.push_back(TreeNode());
+    }
+
+    TreeNode& node = _nodes[index];
+    node.userData = NULL;
+    node.parent = NULL_PROXY;
+    node.child1 = NULL_PROXY;
+    node.child2 = NULL_PROXY;
+    node.height = 0;
+
+    return index;
+}
+
+void BoundingVolumeTree::freeNode(int index)
+{
+    // Free nodes are chained through their parent index and flagged with a negative height.
+    TreeNode& node = _nodes[index];
+    node.userData = NULL;
+    node.parent = _freeList;
+    node.height = -1;
+    _freeList = index;
+}
+
+void BoundingVolumeTree::insertLeaf(int leaf)
+{
+    if (_root == NULL_PROXY)
+    {
+        _root = leaf;
+        _nodes[leaf].parent = NULL_PROXY;
+        return;
+    }
+
+    // Find the best sibling for the new leaf by descending towards the child with
+    // the lowest increase in surface area.
+    BoundingBox leafBox = _nodes[leaf].box;
+    BoundingBox combined;
+    int index = _root;
+    while (_nodes[index].height > 0)
+    {
+        const TreeNode& node = _nodes[index];
+        const TreeNode& child1 = _nodes[node.child1];
+        const TreeNode& child2 = _nodes[node.child2];
+
+        float area = surfaceArea(node.box);
+        combine(node.box, leafBox, &combined);
+        float combinedArea = surfaceArea(combined);
+
+        // Cost of creating a new parent for this node and the new leaf.
+        float cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree.
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        combine(child1.box, leafBox, &combined);
+        float cost1 = surfaceArea(combined) + inheritanceCost;
+        if (child1.height > 0)
+            cost1 -= surfaceArea(child1.box);
+
+        combine(child2.box, leafBox, &combined);
+        float cost2 = surfaceArea(combined) + inheritanceCost;
+        if (child2.height > 0)
+            cost2 -= surfaceArea(child2.box);
+
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    // Create a new parent for the sibling and the leaf.
+    int sibling = index;
+    int newParent = allocateNode();
+    int oldParent = _nodes[sibling].parent;
+    TreeNode& parent = _nodes[newParent];
+    parent.parent = oldParent;
+    combine(leafBox, _nodes[sibling].box, &parent.box);
+    parent.height = _nodes[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_PROXY)
+    {
+        if (_nodes[oldParent].child1 == sibling)
+            _nodes[oldParent].child1 = newParent;
+        else
+            _nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        _root = newParent;
+    }
+
+    // Walk back up the tree fixing heights and boxes.
+    index = _nodes[leaf].parent;
+    while (index != NULL_PROXY)
+    {
+        index = balance(index);
+
+        TreeNode& node = _nodes[index];
+        const TreeNode& child1 = _nodes[node.child1];
+        const TreeNode& child2 = _nodes[node.child2];
+        node.height = 1 + std::max(child1.height, child2.height);
+        combine(child1.box, child2.box, &node.box);
+
+        index = node.parent;
+    }
+}
+
+void BoundingVolumeTree::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = NULL_PROXY;
+        return;
+    }
+
+    int parent = _nodes[leaf].parent;
+    int grandParent = _nodes[parent].parent;
+    int sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+    if (grandParent != NULL_PROXY)
+    {
+        // Replace the parent with the sibling and free the parent.
+        if (_nodes[grandParent].child1 == parent)
+            _nodes[grandParent].child1 = sibling;
+        else
+            _nodes[grandParent].child2 = sibling;
+        _nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        // Walk back up the tree fixing heights and boxes.
+        int index = grandParent;
+        while (index != NULL_PROXY)
+        {
+            index = balance(index);
+
+            TreeNode& node = _nodes[index];
+            const TreeNode& child1 = _nodes[node.child1];
+            const TreeNode& child2 = _nodes[node.child2];
+            node.height = 1 + std::max(child1.height, child2.height);
+            combine(child1.box, child2.box, &node.box);
+
+            index = node.parent;
+        }
+    }
+    else
+    {
+        _root = sibling;
+        _nodes[sibling].parent = NULL_PROXY;
+        freeNode(parent);
+    }
+}
+
+int BoundingVolumeTree::balance(int indexA)
+{
+    // Performs a left or right rotation if the subtree rooted at A is imbalanced
+    // and returns the index of the new subtree root.
+    TreeNode& a = _nodes[indexA];
+    if (a.height < 2)
+        return indexA;
+
+    int indexB = a.child1;
+    int indexC = a.child2;
+    TreeNode& b = _nodes[indexB];
+    TreeNode& c = _nodes[indexC];
+
+    int difference = c.height - b.height;
+
+    // Rotate C up.
+    if (difference > 1)
+    {
+        int indexF = c.child1;
+        int indexG = c.child2;
+        TreeNode& f = _nodes[indexF];
+        TreeNode& g = _nodes[indexG];
+
+        // Swap A and C.
+        c.child1 = indexA;
+        c.parent = a.parent;
+        a.parent = indexC;
+
+        // A's old parent should point to C.
+        if (c.parent != NULL_PROXY)
+        {
+            if (_nodes[c.parent].child1 == indexA)
+                _nodes[c.parent].child1 = indexC;
+            else
+                _nodes[c.parent].child2 = indexC;
+        }
+        else
+        {
+            _root = indexC;
+        }
+
+        // Keep the taller of C's children under C.
+        if (f.height > g.height)
+        {
+            c.child2 = indexF;
+            a.child2 = indexG;
+            g.parent = indexA;
+            combine(b.box, g.box, &a.box);
+            combine(a.box, f.box, &c.box);
+            a.height = 1 + std::max(b.height, g.height);
+            c.height = 1 + std::max(a.height, f.height);
+        }
+        else
+        {
+            c.child2 = indexG;
+            a.child2 = indexF;
+            f.parent = indexA;
+            combine(b.box, f.box, &a.box);
+            combine(a.box, g.box, &c.box);
+            a.height = 1 + std::max(b.height, f.height);
+            c.height = 1 + std::max(a.height, g.height);
+        }
+
+        return indexC;
+    }
+
+    // Rotate B up.
+    if (difference < -1)
+    {
+        int indexD = b.child1;
+        int indexE = b.child2;
+        TreeNode& d = _nodes[indexD];
+        TreeNode& e = _nodes[indexE];
+
+        // Swap A and B.
+        b.child1 = indexA;
+        b.parent = a.parent;
+        a.parent = indexB;
+
+        // A's old parent should point to B.
+        if (b.parent != NULL_PROXY)
+        {
+            if (_nodes[b.parent].child1 == indexA)
+                _nodes[b.parent].child1 = indexB;
+            else
+                _nodes[b.parent].child2 = indexB;
+        }
+        else
+        {
+            _root = indexB;
+        }
+
+        // Keep the taller of B's children under B.
+        if (d.height > e.height)
+        {
+            b.child2 = indexD;
+            a.child1 = indexE;
+            e.parent = indexA;
+            combine(c.box, e.box, &a.box);
+            combine(a.box, d.box, &b.box);
+            a.height = 1 + std::max(c.height, e.height);
+            b.height = 1 + std::max(a.height, d.height);
+        }
+        else
+        {
+            b.child2 = indexE;
+            a.child1 = indexD;
+            d.parent = indexA;
+            combine(c.box, d.box, &a.box);
+            combine(a.box, e.box, &b.box);
+            a.height = 1 + std::max(c.height, d.height);
+            b.height = 1 + std::max(a.height, e.height);
+        }
+
+        return indexB;
+    }
+
+    return indexA;
+}
+
+}
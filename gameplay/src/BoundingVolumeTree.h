@@ -0,0 +1,187 @@
+#ifndef BOUNDINGVOLUMETREE_H_
+#define BOUNDINGVOLUMETREE_H_
+
+#include "BoundingBox.h"
+#include "BoundingSphere.h"
+#include "Frustum.h"
+#include "Ray.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a dynamic bounding volume hierarchy of axis-aligned bounding boxes.
+ *
+ * Each object stored in the tree is represented by a proxy: a leaf holding a
+ * slightly enlarged ("fat") box around the object's bounds plus a user pointer.
+ * Moving a proxy is cheap as long as its new bounds stay inside the fat box;
+ * otherwise the leaf is re-inserted. The tree is kept balanced with tree
+ * rotations, so queries only visit the subtrees whose boxes overlap the query
+ * volume.
+ */
+class BoundingVolumeTree
+{
+public:
+
+    /**
+     * Value used to represent an invalid (unassigned) proxy.
+     */
+    static const int NULL_PROXY = -1;
+
+    /**
+     * Constructor.
+     */
+    BoundingVolumeTree();
+
+    /**
+     * Destructor.
+     */
+    ~BoundingVolumeTree();
+
+    /**
+     * Creates a proxy for an object with the given bounds.
+     *
+     * @param box The bounds of the object.
+     * @param userData The user pointer to associate with the proxy.
+     *
+     * @return The new proxy.
+     */
+    int createProxy(const BoundingBox& box, void* userData);
+
+    /**
+     * Destroys the specified proxy.
+     *
+     * @param proxy The proxy to destroy.
+     */
+    void destroyProxy(int proxy);
+
+    /**
+     * Updates the bounds of the specified proxy.
+     *
+     * The proxy is only re-inserted into the tree if the new bounds are no
+     * longer contained in its fat box.
+     *
+     * @param proxy The proxy to update.
+     * @param box The new bounds of the object.
+     *
+     * @return true if the proxy was re-inserted; false otherwise.
+     */
+    bool moveProxy(int proxy, const BoundingBox& box);
+
+    /**
+     * Determines whether the specified value refers to a live proxy in this tree.
+     *
+     * @param proxy The proxy to test.
+     *
+     * @return true if the proxy is valid; false otherwise.
+     */
+    bool isProxy(int proxy) const;
+
+    /**
+     * Returns the user pointer associated with the specified proxy.
+     *
+     * @param proxy The proxy.
+     *
+     * @return The user pointer.
+     */
+    void* getUserData(int proxy) const;
+
+    /**
+     * Returns the fat box stored for the specified proxy.
+     *
+     * @param proxy The proxy.
+     *
+     * @return The fat box of the proxy.
+     */
+    const BoundingBox& getFatBox(int proxy) const;
+
+    /**
+     * Returns the number of proxies in the tree.
+     *
+     * @return The number of proxies.
+     */
+    unsigned int getProxyCount() const;
+
+    /**
+     * Returns the height of the tree (zero for an empty tree or a single proxy).
+     *
+     * @return The height of the tree.
+     */
+    int getHeight() const;
+
+    /**
+     * Destroys all proxies.
+     */
+    void clear();
+
+    /**
+     * Appends to the specified list the proxies whose fat box intersects the given frustum.
+     *
+     * @param frustum The frustum to test against.
+     * @param proxies The list to append the intersecting proxies to.
+     */
+    void query(const Frustum& frustum, std::vector<int>& proxies) const;
+
+    /**
+     * Appends to the specified list the proxies whose fat box intersects the given sphere.
+     *
+     * @param sphere The sphere to test against.
+     * @param proxies The list to append the intersecting proxies to.
+     */
+    void query(const BoundingSphere& sphere, std::vector<int>& proxies) const;
+
+    /**
+     * Appends to the specified list the proxies whose fat box intersects the given ray.
+     *
+     * @param ray The ray to test against.
+     * @param proxies The list to append the intersecting proxies to.
+     */
+    void query(const Ray& ray, std::vector<int>& proxies) const;
+
+private:
+
+    /**
+     * A node in the tree. Leaves hold proxies; internal nodes always have two children.
+     */
+    struct TreeNode
+    {
+        BoundingBox box;
+        void* userData;
+        int parent;
+        int child1;
+        int child2;
+        int height;
+    };
+
+    /**
+     * Hidden copy constructor.
+     */
+    BoundingVolumeTree(const BoundingVolumeTree& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    BoundingVolumeTree& operator=(const BoundingVolumeTree&);
+
+    int allocateNode();
+
+    void freeNode(int index);
+
+    void insertLeaf(int leaf);
+
+    void removeLeaf(int leaf);
+
+    int balance(int index);
+
+    template <class T>
+    void queryVolume(const T& volume, std::vector<int>& proxies) const;
+
+    std::vector<TreeNode> _nodes;
+    int _root;
+    int _freeList;
+    unsigned int _proxyCount;
+};
+
+}
+
+#endif
@@ -4,9 +4,11 @@
 #include "MeshPart.h"
 #include "Scene.h"
 #include "Joint.h"
+#include <zlib.h>
 
 #define BUNDLE_VERSION_MAJOR            1
 #define BUNDLE_VERSION_MINOR            2
+#define BUNDLE_VERSION_MINOR_COMPRESSED 3
 
 #define BUNDLE_TYPE_SCENE               1
 #define BUNDLE_TYPE_NODE                2
@@ -26,13 +28,120 @@
 // For sanity checking string reads
 #define BUNDLE_MAX_STRING_LENGTH        5000
 
+// Number of decompressed chunks of a compressed bundle kept in memory
+#define BUNDLE_CHUNK_CACHE_SIZE         4
+
+// Vertex element sizes hold the number of values in their low byte, the type of
+// the values in the next byte and the normalized flag above them.
+#define BUNDLE_VERTEX_SIZE_MASK         0xFF
+#define BUNDLE_VERTEX_TYPE_SHIFT        8
+#define BUNDLE_VERTEX_TYPE_MASK         0xFF
+#define BUNDLE_VERTEX_NORMALIZED        0x10000
+
+#define BUNDLE_VERTEX_TYPE_FLOAT            0
+#define BUNDLE_VERTEX_TYPE_BYTE             1
+#define BUNDLE_VERTEX_TYPE_UNSIGNED_BYTE    2
+#define BUNDLE_VERTEX_TYPE_SHORT            3
+#define BUNDLE_VERTEX_TYPE_UNSIGNED_SHORT   4
+
 namespace gameplay
 {
 
 static std::vector<Bundle*> __bundleCache;
 
+// Converts a vertex element value from the given type to float, normalizing integers if requested.
+static float decodeVertexValue(const unsigned char* value, VertexFormat::Type type, bool normalized)
+{
+    switch (type)
+    {
+    case VertexFormat::BYTE:
+        return normalized ? std::max(*(const signed char*)value / 127.0f, -1.0f) : *(const signed char*)value;
+    case VertexFormat::UNSIGNED_BYTE:
+        return normalized ? *value / 255.0f : *value;
+    case VertexFormat::SHORT:
+        return normalized ? std::max(*(const short*)value / 32767.0f, -1.0f) : *(const short*)value;
+    case VertexFormat::UNSIGNED_SHORT:
+        return normalized ? *(const unsigned short*)value / 65535.0f : *(const unsigned short*)value;
+    default:
+        return *(const float*)value;
+    }
+}
+
+// Expands the quantized positions of the given vertices to floats. Normalized positions
+// map [0, 1] (unsigned types) or [-1, 1] (signed types) to the range [min, max].
+// Returns the new vertex data and changes the format accordingly.
+static unsigned char* decodePositions(VertexFormat* format, const unsigned char* vertices, unsigned int vertexCount, const Vector3& min, const Vector3& max)
+{
+    GP_ASSERT(format);
+    GP_ASSERT(vertices);
+
+    std::vector<VertexFormat::Element> elements;
+    unsigned int positionOffset = 0, offset = 0;
+    VertexFormat::Element position;
+    for (unsigned int i = 0, count = format->getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& e = format->getElement(i);
+        if (e.usage == VertexFormat::POSITION)
+        {
+            position = e;
+            positionOffset = offset;
+            elements.push_back(VertexFormat::Element(VertexFormat::POSITION, e.size));
+        }
+        else
+        {
+            elements.push_back(e);
+        }
+        offset += e.getByteSize();
+    }
+    VertexFormat decodedFormat(&elements[0], elements.size());
+
+    unsigned int vertexSize = format->getVertexSize();
+    unsigned int decodedVertexSize = decodedFormat.getVertexSize();
+    unsigned int positionSize = position.getByteSize();
+    unsigned int valueSize = position.type == VertexFormat::BYTE || position.type == VertexFormat::UNSIGNED_BYTE ? 1 : 2;
+    bool isSigned = position.type == VertexFormat::BYTE || position.type == VertexFormat::SHORT;
+    const float* minValues = &min.x;
+    const float* maxValues = &max.x;
+
+    unsigned char* decoded = new unsigned char[decodedVertexSize * vertexCount];
+    const unsigned char* src = vertices;
+    unsigned char* dst = decoded;
+    for (unsigned int i = 0; i < vertexCount; ++i, src += vertexSize, dst += decodedVertexSize)
+    {
+        memcpy(dst, src, positionOffset);
+        float* p = (float*)(dst + positionOffset);
+        for (unsigned int j = 0; j < position.size; ++j)
+        {
+            float value = decodeVertexValue(src + positionOffset + j * valueSize, position.type, position.normalized);
+            if (position.normalized && j < 3)
+            {
+                float t = isSigned ? (value + 1.0f) * 0.5f : value;
+                value = minValues[j] + t * (maxValues[j] - minValues[j]);
+            }
+            p[j] = value;
+        }
+        memcpy(dst + positionOffset + position.size * sizeof(float), src + positionOffset + positionSize, vertexSize - positionOffset - positionSize);
+    }
+
+    *format = decodedFormat;
+    return decoded;
+}
+
+// FNV-1a hash of a reference ID.
+static unsigned int hashId(const char* id)
+{
+    unsigned int hash = 2166136261u;
+    for (const unsigned char* c = (const unsigned char*)id; *c; ++c)
+    {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
 Bundle::Bundle(const char* path) :
-    _path(path), _referenceCount(0), _references(NULL), _file(NULL), _trackedNodes(NULL)
+    _path(path), _referenceCount(0), _references(NULL), _file(NULL), _mappedData(NULL), _mappedSize(0), _position(0),
+    _currentChunk(0), _chunkUseCount(0), _trackedNodes(NULL)
 {
 }
 
@@ -49,6 +158,22 @@ Bundle::~Bundle()
 
     SAFE_DELETE_ARRAY(_references);
 
+    for (unsigned int i = 0, count = _preloadedMeshes.size(); i < count; ++i)
+    {
+        SAFE_DELETE(_preloadedMeshes[i]);
+    }
+
+    for (unsigned int i = 0, count = _chunks.size(); i < count; ++i)
+    {
+        SAFE_DELETE_ARRAY(_chunks[i].data);
+    }
+
+    if (_mappedData)
+    {
+        FileSystem::unmapFile(_mappedData, _mappedSize);
+        _mappedData = NULL;
+    }
+
     if (_file)
     {
         fclose(_file);
@@ -71,7 +196,7 @@ bool Bundle::readArray(unsigned int* length, T** ptr)
     if (*length > 0)
     {
         *ptr = new T[*length];
-        if (fread(*ptr, sizeof(T), *length, _file) != *length)
+        if (read(*ptr, sizeof(T), *length) != *length)
         {
             GP_ERROR("Failed to read an array of data from bundle (into an array).");
             SAFE_DELETE_ARRAY(*ptr);
@@ -95,7 +220,7 @@ bool Bundle::readArray(unsigned int* length, std::vector<T>* values)
     if (*length > 0 && values)
     {
         values->resize(*length);
-        if (fread(&(*values)[0], sizeof(T), *length, _file) != *length)
+        if (read(&(*values)[0], sizeof(T), *length) != *length)
         {
             GP_ERROR("Failed to read an array of data from bundle (into a std::vector).");
             return false;
@@ -119,7 +244,7 @@ bool Bundle::readArray(unsigned int* length, std::vector<T>* values, unsigned in
     if (*length > 0 && values)
     {
         values->resize(*length);
-        if (fread(&(*values)[0], readSize, *length, _file) != *length)
+        if (read(&(*values)[0], readSize, *length) != *length)
         {
             GP_ERROR("Failed to read an array of data from bundle (into a std::vector with a specified single element read size).");
             return false;
@@ -128,12 +253,10 @@ bool Bundle::readArray(unsigned int* length, std::vector<T>* values, unsigned in
     return true;
 }
 
-static std::string readString(FILE* fp)
+std::string Bundle::readString()
 {
-    GP_ASSERT(fp);
-
     unsigned int length;
-    if (fread(&length, 4, 1, fp) != 1)
+    if (read(&length, 4, 1) != 1)
     {
         GP_ERROR("Failed to read the length of a string from a bundle.");
         return std::string();
@@ -146,7 +269,7 @@ static std::string readString(FILE* fp)
     if (length > 0)
     {
         str.resize(length);
-        if (fread(&str[0], 1, length, fp) != length)
+        if (read(&str[0], 1, length) != length)
         {
             GP_ERROR("Failed to read string from bundle.");
             return std::string();
@@ -172,6 +295,13 @@ Bundle* Bundle::create(const char* path)
         }
     }
 
+    return open(path);
+}
+
+Bundle* Bundle::open(const char* path)
+{
+    GP_ASSERT(path);
+
     // Open the bundle.
     FILE* fp = FileSystem::openFile(path, "rb");
     if (!fp)
@@ -180,48 +310,43 @@ Bundle* Bundle::create(const char* path)
         return NULL;
     }
 
+    // Map the whole file when possible, so that headers are parsed and mesh data is
+    // uploaded straight from the mapping; otherwise everything is read from the file.
+    // The file is kept open for faster reading later either way.
+    Bundle* bundle = new Bundle(path);
+    bundle->_file = fp;
+    bundle->_mappedData = static_cast<const unsigned char*>(FileSystem::mapFile(fp, &bundle->_mappedSize));
+
     // Read the GPB header info.
     char sig[9];
-    if (fread(sig, 1, 9, fp) != 9 || memcmp(sig, "\xABGPB\xBB\r\n\x1A\n", 9) != 0)
+    if (bundle->read(sig, 1, 9) != 9 || memcmp(sig, "\xABGPB\xBB\r\n\x1A\n", 9) != 0)
     {
         GP_ERROR("Invalid GPB header for bundle '%s'.", path);
-        if (fclose(fp) != 0)
-        {
-            GP_ERROR("Failed to close file '%s'.", path);
-        }
+        SAFE_RELEASE(bundle);
         return NULL;
     }
 
     // Read version.
     unsigned char ver[2];
-    if (fread(ver, 1, 2, fp) != 2)
+    if (bundle->read(ver, 1, 2) != 2)
     {
         GP_ERROR("Failed to read GPB version for bundle '%s'.", path);
-        if (fclose(fp) != 0)
-        {
-            GP_ERROR("Failed to close file '%s'.", path);
-        }
+        SAFE_RELEASE(bundle);
         return NULL;
     }
-    if (ver[0] != BUNDLE_VERSION_MAJOR || ver[1] != BUNDLE_VERSION_MINOR)
+    if (ver[0] != BUNDLE_VERSION_MAJOR || (ver[1] != BUNDLE_VERSION_MINOR && ver[1] != BUNDLE_VERSION_MINOR_COMPRESSED))
     {
         GP_ERROR("Unsupported version (%d.%d) for bundle '%s' (expected %d.%d).", (int)ver[0], (int)ver[1], path, BUNDLE_VERSION_MAJOR, BUNDLE_VERSION_MINOR);
-        if (fclose(fp) != 0)
-        {
-            GP_ERROR("Failed to close file '%s'.", path);
-        }
+        SAFE_RELEASE(bundle);
         return NULL;
     }
 
     // Read ref table.
     unsigned int refCount;
-    if (fread(&refCount, 4, 1, fp) != 1)
+    if (!bundle->read(&refCount))
     {
         GP_ERROR("Failed to read ref table for bundle '%s'.", path);
-        if (fclose(fp) != 0)
-        {
-            GP_ERROR("Failed to close file '%s'.", path);
-        }
+        SAFE_RELEASE(bundle);
         return NULL;
     }
 
@@ -229,41 +354,104 @@ Bundle* Bundle::create(const char* path)
     Reference* refs = new Reference[refCount];
     for (unsigned int i = 0; i < refCount; ++i)
     {
-        if ((refs[i].id = readString(fp)).empty() ||
-            fread(&refs[i].type, 4, 1, fp) != 1 ||
-            fread(&refs[i].offset, 4, 1, fp) != 1)
+        if ((refs[i].id = bundle->readString()).empty() ||
+            !bundle->read(&refs[i].type) ||
+            !bundle->read(&refs[i].offset))
         {
             GP_ERROR("Failed to read ref number %d for bundle '%s'.", i, path);
-            if (fclose(fp) != 0)
-            {
-                GP_ERROR("Failed to close file '%s'.", path);
-            }
             SAFE_DELETE_ARRAY(refs);
+            SAFE_RELEASE(bundle);
             return NULL;
         }
     }
 
-    // Keep file open for faster reading later.
-    Bundle* bundle = new Bundle(path);
     bundle->_referenceCount = refCount;
     bundle->_references = refs;
-    bundle->_file = fp;
+    bundle->buildReferenceIndex();
+
+    // Read the chunk table of a compressed bundle. Its data starts after the references,
+    // as in an uncompressed bundle, and is split in consecutive chunks.
+    if (ver[1] == BUNDLE_VERSION_MINOR_COMPRESSED)
+    {
+        unsigned int offset = (unsigned int)bundle->tell();
+        unsigned int chunkCount;
+        if (!bundle->read(&chunkCount) || chunkCount == 0)
+        {
+            GP_ERROR("Failed to read chunk table for bundle '%s'.", path);
+            SAFE_RELEASE(bundle);
+            return NULL;
+        }
+
+        std::vector<Chunk> chunks(chunkCount);
+        for (unsigned int i = 0; i < chunkCount; ++i)
+        {
+            Chunk& chunk = chunks[i];
+            if (!bundle->read(&chunk.offset) || !bundle->read(&chunk.size) ||
+                !bundle->read(&chunk.fileOffset) || !bundle->read(&chunk.fileSize) ||
+                chunk.offset != offset)
+            {
+                GP_ERROR("Failed to read chunk number %d for bundle '%s'.", i, path);
+                SAFE_RELEASE(bundle);
+                return NULL;
+            }
+            chunk.data = NULL;
+            chunk.lastUse = 0;
+            offset += chunk.size;
+        }
+
+        bundle->_chunks.swap(chunks);
+        bundle->_position = 0;
+    }
 
     return bundle;
 }
 
+void Bundle::buildReferenceIndex()
+{
+    // Keep the hash table at most half full so that probe sequences stay short.
+    unsigned int tableSize = 16;
+    while (tableSize < _referenceCount * 2)
+    {
+        tableSize <<= 1;
+    }
+    _referenceIds.assign(tableSize, 0);
+
+    // References are inserted in table order, so a duplicate ID is found after the
+    // first reference with that ID, as with a linear search of the table.
+    unsigned int mask = tableSize - 1;
+    for (unsigned int i = 0; i < _referenceCount; ++i)
+    {
+        unsigned int slot = hashId(_references[i].id.c_str()) & mask;
+        while (_referenceIds[slot] != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        _referenceIds[slot] = i + 1;
+    }
+
+    _referenceOffsets.resize(_referenceCount);
+    for (unsigned int i = 0; i < _referenceCount; ++i)
+    {
+        _referenceOffsets[i] = std::make_pair(_references[i].offset, i);
+    }
+    std::sort(_referenceOffsets.begin(), _referenceOffsets.end());
+}
+
 Bundle::Reference* Bundle::find(const char* id) const
 {
     GP_ASSERT(id);
     GP_ASSERT(_references);
 
-    // Search the ref table for the given id (case-sensitive).
-    for (unsigned int i = 0; i < _referenceCount; ++i)
+    // Probe the hash table for the given id (case-sensitive).
+    GP_ASSERT(!_referenceIds.empty());
+    unsigned int mask = _referenceIds.size() - 1;
+    for (unsigned int slot = hashId(id) & mask; _referenceIds[slot] != 0; slot = (slot + 1) & mask)
     {
-        if (_references[i].id == id)
+        Reference* ref = &_references[_referenceIds[slot] - 1];
+        if (ref->id == id)
         {
             // Found a match
-            return &_references[i];
+            return ref;
         }
     }
 
@@ -282,20 +470,23 @@ void Bundle::clearLoadSession()
 const char* Bundle::getIdFromOffset() const
 {
     GP_ASSERT(_file);
-    return getIdFromOffset((unsigned int) ftell(_file));
+    return getIdFromOffset((unsigned int) tell());
 }
 
 const char* Bundle::getIdFromOffset(unsigned int offset) const
 {
-    // Search the ref table for the given offset.
+    // Search the sorted offsets for the first reference (in table order) at the given offset.
     if (offset > 0)
     {
         GP_ASSERT(_references);
-        for (unsigned int i = 0; i < _referenceCount; ++i)
+        std::vector<std::pair<unsigned int, unsigned int> >::const_iterator itr =
+            std::lower_bound(_referenceOffsets.begin(), _referenceOffsets.end(), std::make_pair(offset, 0u));
+        for (; itr != _referenceOffsets.end() && itr->first == offset; ++itr)
         {
-            if (_references[i].offset == offset && _references[i].id.length() > 0)
+            const Reference& ref = _references[itr->second];
+            if (ref.id.length() > 0)
             {
-                return _references[i].id.c_str();
+                return ref.id.c_str();
             }
         }
     }
@@ -319,7 +510,7 @@ Bundle::Reference* Bundle::seekTo(const char* id, unsigned int type)
 
     // Seek to the offset of this object.
     GP_ASSERT(_file);
-    if (fseek(_file, ref->offset, SEEK_SET) != 0)
+    if (seek(ref->offset, SEEK_SET) != 0)
     {
         GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", id, _path.c_str());
         return NULL;
@@ -339,7 +530,7 @@ Bundle::Reference* Bundle::seekToFirstType(unsigned int type)
         if (ref->type == type)
         {
             // Found a match.
-            if (fseek(_file, ref->offset, SEEK_SET) != 0)
+            if (seek(ref->offset, SEEK_SET) != 0)
             {
                 GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
                 return NULL;
@@ -350,24 +541,188 @@ Bundle::Reference* Bundle::seekToFirstType(unsigned int type)
     return NULL;
 }
 
+size_t Bundle::read(void* ptr, size_t size, size_t count)
+{
+    if (!_chunks.empty())
+    {
+        // Like fread, only whole elements are read.
+        const Chunk& last = _chunks.back();
+        size_t end = (size_t)last.offset + last.size;
+        size_t available = (size > 0 && _position < end) ? (end - _position) / size : 0;
+        if (count > available)
+            count = available;
+
+        // Reads may span several chunks.
+        unsigned char* dst = static_cast<unsigned char*>(ptr);
+        size_t remaining = size * count;
+        while (remaining > 0)
+        {
+            const Chunk* chunk = loadChunk(_position);
+            if (chunk == NULL)
+                return (size * count - remaining) / size;
+
+            size_t offset = _position - chunk->offset;
+            size_t n = std::min(remaining, (size_t)chunk->size - offset);
+            memcpy(dst, chunk->data + offset, n);
+            dst += n;
+            _position += n;
+            remaining -= n;
+        }
+        return count;
+    }
+
+    if (_mappedData)
+    {
+        // Like fread, only whole elements are read.
+        size_t available = (size > 0 && _position < _mappedSize) ? (_mappedSize - _position) / size : 0;
+        if (count > available)
+            count = available;
+        memcpy(ptr, _mappedData + _position, size * count);
+        _position += size * count;
+        return count;
+    }
+
+    GP_ASSERT(_file);
+    return fread(ptr, size, count, _file);
+}
+
+int Bundle::seek(long offset, int origin)
+{
+    if (_mappedData || !_chunks.empty())
+    {
+        long position = offset;
+        if (origin == SEEK_CUR)
+            position += (long)_position;
+        else if (origin == SEEK_END)
+            position += _chunks.empty() ? (long)_mappedSize : (long)_chunks.back().offset + (long)_chunks.back().size;
+        if (position < 0)
+            return -1;
+        _position = (size_t)position;
+        return 0;
+    }
+
+    GP_ASSERT(_file);
+    return fseek(_file, offset, origin);
+}
+
+long Bundle::tell() const
+{
+    if (_mappedData || !_chunks.empty())
+        return (long)_position;
+
+    GP_ASSERT(_file);
+    return ftell(_file);
+}
+
+const unsigned char* Bundle::readInPlace(size_t size)
+{
+    if (_mappedData == NULL || !_chunks.empty() || _position > _mappedSize || _mappedSize - _position < size)
+        return NULL;
+
+    const unsigned char* ptr = _mappedData + _position;
+    _position += size;
+    return ptr;
+}
+
+const Bundle::Chunk* Bundle::loadChunk(size_t position)
+{
+    GP_ASSERT(!_chunks.empty());
+
+    // Reads are mostly sequential, so check the last chunk read from first.
+    Chunk* chunk = &_chunks[_currentChunk];
+    if (position < chunk->offset || position - chunk->offset >= chunk->size)
+    {
+        // Find the last chunk that starts at or before the position.
+        unsigned int low = 0, high = _chunks.size();
+        while (high - low > 1)
+        {
+            unsigned int middle = (low + high) / 2;
+            if (_chunks[middle].offset <= position)
+                low = middle;
+            else
+                high = middle;
+        }
+        chunk = &_chunks[low];
+        if (position < chunk->offset || position - chunk->offset >= chunk->size)
+            return NULL;
+        _currentChunk = low;
+    }
+    chunk->lastUse = ++_chunkUseCount;
+
+    if (chunk->data)
+        return chunk;
+
+    // Keep at most BUNDLE_CHUNK_CACHE_SIZE chunks decompressed, dropping the least recently used.
+    unsigned int residentCount = 0;
+    Chunk* oldest = NULL;
+    for (unsigned int i = 0, count = _chunks.size(); i < count; ++i)
+    {
+        if (_chunks[i].data)
+        {
+            ++residentCount;
+            if (oldest == NULL || _chunks[i].lastUse < oldest->lastUse)
+                oldest = &_chunks[i];
+        }
+    }
+    if (residentCount >= BUNDLE_CHUNK_CACHE_SIZE)
+    {
+        SAFE_DELETE_ARRAY(oldest->data);
+    }
+
+    // Decompress straight from the mapped file when possible.
+    const unsigned char* source = NULL;
+    unsigned char* buffer = NULL;
+    if (_mappedData)
+    {
+        if (chunk->fileOffset <= _mappedSize && _mappedSize - chunk->fileOffset >= chunk->fileSize)
+            source = _mappedData + chunk->fileOffset;
+    }
+    else
+    {
+        GP_ASSERT(_file);
+        buffer = new unsigned char[chunk->fileSize];
+        if (fseek(_file, chunk->fileOffset, SEEK_SET) == 0 && fread(buffer, 1, chunk->fileSize, _file) == chunk->fileSize)
+            source = buffer;
+    }
+    if (source == NULL)
+    {
+        GP_ERROR("Failed to read chunk at offset %u of bundle '%s'.", chunk->offset, _path.c_str());
+        SAFE_DELETE_ARRAY(buffer);
+        return NULL;
+    }
+
+    chunk->data = new unsigned char[chunk->size];
+    uLongf size = chunk->size;
+    int result = uncompress(chunk->data, &size, source, chunk->fileSize);
+    SAFE_DELETE_ARRAY(buffer);
+    if (result != Z_OK || size != chunk->size)
+    {
+        GP_ERROR("Failed to decompress chunk at offset %u of bundle '%s' (%d).", chunk->offset, _path.c_str(), result);
+        SAFE_DELETE_ARRAY(chunk->data);
+        return NULL;
+    }
+
+    return chunk;
+}
+
 bool Bundle::read(unsigned int* ptr)
 {
-    return fread(ptr, sizeof(unsigned int), 1, _file) == 1;
+    return read(ptr, sizeof(unsigned int), 1) == 1;
 }
 
 bool Bundle::read(unsigned char* ptr)
 {
-    return fread(ptr, sizeof(unsigned char), 1, _file) == 1;
+    return read(ptr, sizeof(unsigned char), 1) == 1;
 }
 
 bool Bundle::read(float* ptr)
 {
-    return fread(ptr, sizeof(float), 1, _file) == 1;
+    return read(ptr, sizeof(float), 1) == 1;
 }
 
 bool Bundle::readMatrix(float* m)
 {
-    return fread(m, sizeof(float), 16, _file) == 16;
+    return read(m, sizeof(float), 16) == 16;
 }
 
 Scene* Bundle::loadScene(const char* id)
@@ -419,7 +774,7 @@ Scene* Bundle::loadScene(const char* id)
         }
     }
     // Read active camera.
-    std::string xref = readString(_file);
+    std::string xref = readString();
     if (xref.length() > 1 && xref[0] == '#') // TODO: Handle full xrefs
     {
         Node* node = scene->findNode(xref.c_str() + 1, true);
@@ -460,7 +815,7 @@ Scene* Bundle::loadScene(const char* id)
         if (ref->type == BUNDLE_TYPE_ANIMATIONS)
         {
             // Found a match.
-            if (fseek(_file, ref->offset, SEEK_SET) != 0)
+            if (seek(ref->offset, SEEK_SET) != 0)
             {
                 GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
                 return NULL;
@@ -499,7 +854,7 @@ Node* Bundle::loadNode(const char* id, Scene* sceneContext)
         Reference* ref = &_references[i];
         if (ref->type == BUNDLE_TYPE_ANIMATIONS)
         {
-            if (fseek(_file, ref->offset, SEEK_SET) != 0)
+            if (seek(ref->offset, SEEK_SET) != 0)
             {
                 GP_ERROR("Failed to seek to object '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
                 SAFE_DELETE(_trackedNodes);
@@ -517,7 +872,7 @@ Node* Bundle::loadNode(const char* id, Scene* sceneContext)
 
             for (unsigned int j = 0; j < animationCount; j++)
             {
-                const std::string id = readString(_file);
+                const std::string id = readString();
 
                 // Read the number of animation channels in this animation.
                 unsigned int animationChannelCount;
@@ -532,7 +887,7 @@ Node* Bundle::loadNode(const char* id, Scene* sceneContext)
                 for (unsigned int k = 0; k < animationChannelCount; k++)
                 {
                     // Read target id.
-                    std::string targetId = readString(_file);
+                    std::string targetId = readString();
                     if (targetId.empty())
                     {
                         GP_ERROR("Failed to read target id for animation '%s'.", id.c_str());
@@ -638,12 +993,12 @@ bool Bundle::skipNode()
     }
     
     // Skip over the node's transform and parent ID.
-    if (fseek(_file, sizeof(float) * 16, SEEK_CUR) != 0)
+    if (seek(sizeof(float) * 16, SEEK_CUR) != 0)
     {
         GP_ERROR("Failed to skip over node transform for node '%s'.", id);
         return false;
     }
-    readString(_file);
+    readString();
 
     // Skip over the node's children.
     unsigned int childrenCount;
@@ -725,7 +1080,7 @@ Node* Bundle::readNode(Scene* sceneContext, Node* nodeContext)
 
     // Read transform.
     float transform[16];
-    if (fread(transform, sizeof(float), 16, _file) != 16)
+    if (read(transform, sizeof(float), 16) != 16)
     {
         GP_ERROR("Failed to read transform for node '%s'.", id);
         SAFE_RELEASE(node);
@@ -734,7 +1089,7 @@ Node* Bundle::readNode(Scene* sceneContext, Node* nodeContext)
     setTransform(transform, node);
 
     // Skip the parent ID.
-    readString(_file);
+    readString();
 
     // Read children.
     unsigned int childrenCount;
@@ -954,7 +1309,7 @@ Model* Bundle::readModel(const char* nodeId)
 {
     // Read mesh.
     Mesh* mesh = NULL;
-    std::string xref = readString(_file);
+    std::string xref = readString();
     if (xref.length() > 1 && xref[0] == '#') // TODO: Handle full xrefs
     {
         mesh = loadMesh(xref.c_str() + 1, nodeId);
@@ -1035,7 +1390,7 @@ MeshSkin* Bundle::readMeshSkin()
     // Read joint xref strings for all joints in the list.
     for (unsigned int i = 0; i < jointCount; i++)
     {
-        skinData->joints.push_back(readString(_file));
+        skinData->joints.push_back(readString());
     }
 
     // Read bind poses.
@@ -1145,12 +1500,12 @@ void Bundle::resolveJointReferences(Scene* sceneContext, Node* nodeContext)
                         seekTo(nodeId.c_str(), ref->type);
 
                         // Skip over the node type (1 unsigned int) and transform (16 floats) and read the parent id.
-                        if (fseek(_file, sizeof(unsigned int) + sizeof(float)*16, SEEK_CUR) != 0)
+                        if (seek(sizeof(unsigned int) + sizeof(float)*16, SEEK_CUR) != 0)
                         {
                             GP_ERROR("Failed to skip over node type and transform for node '%s' in bundle '%s'.", nodeId.c_str(), _path.c_str());
                             return;
                         }
-                        std::string parentID = readString(_file);
+                        std::string parentID = readString();
                         
                         if (!parentID.empty())
                             nodeId = parentID;
@@ -1186,7 +1541,7 @@ void Bundle::resolveJointReferences(Scene* sceneContext, Node* nodeContext)
 
 void Bundle::readAnimation(Scene* scene)
 {
-    const std::string animationId = readString(_file);
+    const std::string animationId = readString();
 
     // Read the number of animation channels in this animation.
     unsigned int animationChannelCount;
@@ -1224,7 +1579,7 @@ Animation* Bundle::readAnimationChannel(Scene* scene, Animation* animation, cons
     GP_ASSERT(animationId);
 
     // Read target id.
-    std::string targetId = readString(_file);
+    std::string targetId = readString();
     if (targetId.empty())
     {
         GP_ERROR("Failed to read target id for animation '%s'.", animationId);
@@ -1337,7 +1692,7 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
     GP_ASSERT(id);
 
     // Save the file position.
-    long position = ftell(_file);
+    long position = tell();
     if (position == -1L)
     {
         GP_ERROR("Failed to save the current file position before loading mesh '%s'.", id);
@@ -1352,8 +1707,19 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
         return NULL;
     }
 
-    // Read mesh data.
-    MeshData* meshData = readMeshData();
+    // Use the mesh data read by preloadMeshes() if there is some. Otherwise read it now; it is
+    // uploaded before this returns, so it can stay in the mapped file.
+    MeshData* meshData = NULL;
+    unsigned int index = (unsigned int)(ref - _references);
+    if (index < _preloadedMeshes.size() && _preloadedMeshes[index])
+    {
+        meshData = _preloadedMeshes[index];
+        _preloadedMeshes[index] = NULL;
+    }
+    else
+    {
+        meshData = readMeshData(true);
+    }
     if (meshData == NULL)
     {
         GP_ERROR("Failed to load mesh data for mesh '%s'.", id);
@@ -1397,7 +1763,7 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
     SAFE_DELETE(meshData);
 
     // Restore file pointer.
-    if (fseek(_file, position, SEEK_SET) != 0)
+    if (seek(position, SEEK_SET) != 0)
     {
         GP_ERROR("Failed to restore file pointer after loading mesh '%s'.", id);
         return NULL;
@@ -1406,11 +1772,39 @@ Mesh* Bundle::loadMesh(const char* id, const char* nodeId)
     return mesh;
 }
 
-Bundle::MeshData* Bundle::readMeshData()
+bool Bundle::preloadMeshes()
+{
+    GP_ASSERT(_references);
+
+    _preloadedMeshes.resize(_referenceCount, NULL);
+    for (unsigned int i = 0; i < _referenceCount; ++i)
+    {
+        Reference* ref = &_references[i];
+        if (ref->type != BUNDLE_TYPE_MESH || _preloadedMeshes[i])
+            continue;
+
+        if (seek(ref->offset, SEEK_SET) != 0)
+        {
+            GP_ERROR("Failed to seek to mesh '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
+            return false;
+        }
+
+        _preloadedMeshes[i] = readMeshData();
+        if (_preloadedMeshes[i] == NULL)
+        {
+            GP_ERROR("Failed to load mesh data for mesh '%s' in bundle '%s'.", ref->id.c_str(), _path.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+Bundle::MeshData* Bundle::readMeshData(bool inPlace)
 {
     // Read vertex format/elements.
     unsigned int vertexElementCount;
-    if (fread(&vertexElementCount, 4, 1, _file) != 1)
+    if (read(&vertexElementCount, 4, 1) != 1)
     {
         GP_ERROR("Failed to load vertex element count.");
         return NULL;
@@ -1422,24 +1816,66 @@ Bundle::MeshData* Bundle::readMeshData()
     }
 
     VertexFormat::Element* vertexElements = new VertexFormat::Element[vertexElementCount];
+    bool quantizedPositions = false;
+    Vector3 positionMin, positionMax;
     for (unsigned int i = 0; i < vertexElementCount; ++i)
     {
         unsigned int vUsage, vSize;
-        if (fread(&vUsage, 4, 1, _file) != 1)
+        if (read(&vUsage, 4, 1) != 1)
         {
             GP_ERROR("Failed to load vertex usage.");
             SAFE_DELETE_ARRAY(vertexElements);
             return NULL;
         }
-        if (fread(&vSize, 4, 1, _file) != 1)
+        if (read(&vSize, 4, 1) != 1)
         {
             GP_ERROR("Failed to load vertex size.");
             SAFE_DELETE_ARRAY(vertexElements);
             return NULL;
         }
 
+        VertexFormat::Type type;
+        switch ((vSize >> BUNDLE_VERTEX_TYPE_SHIFT) & BUNDLE_VERTEX_TYPE_MASK)
+        {
+        case BUNDLE_VERTEX_TYPE_FLOAT:
+            type = VertexFormat::FLOAT;
+            break;
+        case BUNDLE_VERTEX_TYPE_BYTE:
+            type = VertexFormat::BYTE;
+            break;
+        case BUNDLE_VERTEX_TYPE_UNSIGNED_BYTE:
+            type = VertexFormat::UNSIGNED_BYTE;
+            break;
+        case BUNDLE_VERTEX_TYPE_SHORT:
+            type = VertexFormat::SHORT;
+            break;
+        case BUNDLE_VERTEX_TYPE_UNSIGNED_SHORT:
+            type = VertexFormat::UNSIGNED_SHORT;
+            break;
+        default:
+            GP_ERROR("Failed to load vertex element; invalid type %u.", (vSize >> BUNDLE_VERTEX_TYPE_SHIFT) & BUNDLE_VERTEX_TYPE_MASK);
+            SAFE_DELETE_ARRAY(vertexElements);
+            return NULL;
+        }
+
         vertexElements[i].usage = (VertexFormat::Usage)vUsage;
-        vertexElements[i].size = vSize;
+        vertexElements[i].size = vSize & BUNDLE_VERTEX_SIZE_MASK;
+        vertexElements[i].type = type;
+        vertexElements[i].normalized = (vSize & BUNDLE_VERTEX_NORMALIZED) != 0;
+
+        // Quantized positions are expanded on load, as shaders expect positions in model space.
+        // They only save file size and I/O; GPU memory is saved for the other quantized elements.
+        if (vertexElements[i].usage == VertexFormat::POSITION && type != VertexFormat::FLOAT)
+        {
+            quantizedPositions = true;
+            if (vertexElements[i].normalized &&
+                (read(&positionMin.x, 4, 3) != 3 || read(&positionMax.x, 4, 3) != 3))
+            {
+                GP_ERROR("Failed to load vertex position range.");
+                SAFE_DELETE_ARRAY(vertexElements);
+                return NULL;
+            }
+        }
     }
 
     MeshData* meshData = new MeshData(VertexFormat(vertexElements, vertexElementCount));
@@ -1447,7 +1883,7 @@ Bundle::MeshData* Bundle::readMeshData()
 
     // Read vertex data.
     unsigned int vertexByteCount;
-    if (fread(&vertexByteCount, 4, 1, _file) != 1)
+    if (read(&vertexByteCount, 4, 1) != 1)
     {
         GP_ERROR("Failed to load vertex byte count.");
         SAFE_DELETE(meshData);
@@ -1462,22 +1898,38 @@ Bundle::MeshData* Bundle::readMeshData()
 
     GP_ASSERT(meshData->vertexFormat.getVertexSize());
     meshData->vertexCount = vertexByteCount / meshData->vertexFormat.getVertexSize();
-    meshData->vertexData = new unsigned char[vertexByteCount];
-    if (fread(meshData->vertexData, 1, vertexByteCount, _file) != vertexByteCount)
+    const unsigned char* mappedVertexData = (inPlace && !quantizedPositions) ? readInPlace(vertexByteCount) : NULL;
+    if (mappedVertexData)
     {
-        GP_ERROR("Failed to load vertex data.");
-        SAFE_DELETE(meshData);
-        return NULL;
+        meshData->vertexData = const_cast<unsigned char*>(mappedVertexData);
+        meshData->vertexDataMapped = true;
+    }
+    else
+    {
+        meshData->vertexData = new unsigned char[vertexByteCount];
+        if (read(meshData->vertexData, 1, vertexByteCount) != vertexByteCount)
+        {
+            GP_ERROR("Failed to load vertex data.");
+            SAFE_DELETE(meshData);
+            return NULL;
+        }
+
+        if (quantizedPositions)
+        {
+            unsigned char* decoded = decodePositions(&meshData->vertexFormat, meshData->vertexData, meshData->vertexCount, positionMin, positionMax);
+            SAFE_DELETE_ARRAY(meshData->vertexData);
+            meshData->vertexData = decoded;
+        }
     }
 
     // Read mesh bounds (bounding box and bounding sphere).
-    if (fread(&meshData->boundingBox.min.x, 4, 3, _file) != 3 || fread(&meshData->boundingBox.max.x, 4, 3, _file) != 3)
+    if (read(&meshData->boundingBox.min.x, 4, 3) != 3 || read(&meshData->boundingBox.max.x, 4, 3) != 3)
     {
         GP_ERROR("Failed to load mesh bounding box.");
         SAFE_DELETE(meshData);
         return NULL;
     }
-    if (fread(&meshData->boundingSphere.center.x, 4, 3, _file) != 3 || fread(&meshData->boundingSphere.radius, 4, 1, _file) != 1)
+    if (read(&meshData->boundingSphere.center.x, 4, 3) != 3 || read(&meshData->boundingSphere.radius, 4, 1) != 1)
     {
         GP_ERROR("Failed to load mesh bounding sphere.");
         SAFE_DELETE(meshData);
@@ -1486,7 +1938,7 @@ Bundle::MeshData* Bundle::readMeshData()
 
     // Read mesh parts.
     unsigned int meshPartCount;
-    if (fread(&meshPartCount, 4, 1, _file) != 1)
+    if (read(&meshPartCount, 4, 1) != 1)
     {
         GP_ERROR("Failed to load mesh part count.");
         SAFE_DELETE(meshData);
@@ -1496,19 +1948,19 @@ Bundle::MeshData* Bundle::readMeshData()
     {
         // Read primitive type, index format and index count.
         unsigned int pType, iFormat, iByteCount;
-        if (fread(&pType, 4, 1, _file) != 1)
+        if (read(&pType, 4, 1) != 1)
         {
             GP_ERROR("Failed to load primitive type for mesh part with index %d.", i);
             SAFE_DELETE(meshData);
             return NULL;
         }
-        if (fread(&iFormat, 4, 1, _file) != 1)
+        if (read(&iFormat, 4, 1) != 1)
         {
             GP_ERROR("Failed to load index format for mesh part with index %d.", i);
             SAFE_DELETE(meshData);
             return NULL;
         }
-        if (fread(&iByteCount, 4, 1, _file) != 1)
+        if (read(&iByteCount, 4, 1) != 1)
         {
             GP_ERROR("Failed to load index byte count for mesh part with index %d.", i);
             SAFE_DELETE(meshData);
@@ -1541,12 +1993,21 @@ Bundle::MeshData* Bundle::readMeshData()
         GP_ASSERT(indexSize);
         partData->indexCount = iByteCount / indexSize;
 
-        partData->indexData = new unsigned char[iByteCount];
-        if (fread(partData->indexData, 1, iByteCount, _file) != iByteCount)
+        const unsigned char* mappedIndexData = inPlace ? readInPlace(iByteCount) : NULL;
+        if (mappedIndexData)
         {
-            GP_ERROR("Failed to read index data for mesh part with index %d.", i);
-            SAFE_DELETE(meshData);
-            return NULL;
+            partData->indexData = const_cast<unsigned char*>(mappedIndexData);
+            partData->indexDataMapped = true;
+        }
+        else
+        {
+            partData->indexData = new unsigned char[iByteCount];
+            if (read(partData->indexData, 1, iByteCount) != iByteCount)
+            {
+                GP_ERROR("Failed to read index data for mesh part with index %d.", i);
+                SAFE_DELETE(meshData);
+                return NULL;
+            }
         }
     }
 
@@ -1614,7 +2075,7 @@ Font* Bundle::loadFont(const char* id)
     }
 
     // Read font family.
-    std::string family = readString(_file);
+    std::string family = readString();
     if (family.empty())
     {
         GP_ERROR("Failed to read font family for font '%s'.", id);
@@ -1623,23 +2084,23 @@ Font* Bundle::loadFont(const char* id)
 
     // Read font style and size.
     unsigned int style, size;
-    if (fread(&style, 4, 1, _file) != 1)
+    if (read(&style, 4, 1) != 1)
     {
         GP_ERROR("Failed to read style for font '%s'.", id);
         return NULL;
     }
-    if (fread(&size, 4, 1, _file) != 1)
+    if (read(&size, 4, 1) != 1)
     {
         GP_ERROR("Failed to read size for font '%s'.", id);
         return NULL;
     }
 
     // Read character set.
-    std::string charset = readString(_file);
+    std::string charset = readString();
 
     // Read font glyphs.
     unsigned int glyphCount;
-    if (fread(&glyphCount, 4, 1, _file) != 1)
+    if (read(&glyphCount, 4, 1) != 1)
     {
         GP_ERROR("Failed to read glyph count for font '%s'.", id);
         return NULL;
@@ -1651,7 +2112,7 @@ Font* Bundle::loadFont(const char* id)
     }
 
     Font::Glyph* glyphs = new Font::Glyph[glyphCount];
-    if (fread(glyphs, sizeof(Font::Glyph), glyphCount, _file) != glyphCount)
+    if (read(glyphs, sizeof(Font::Glyph), glyphCount) != glyphCount)
     {
         GP_ERROR("Failed to read glyphs for font '%s'.", id);
         SAFE_DELETE_ARRAY(glyphs);
@@ -1660,19 +2121,19 @@ Font* Bundle::loadFont(const char* id)
 
     // Read texture attributes.
     unsigned int width, height, textureByteCount;
-    if (fread(&width, 4, 1, _file) != 1)
+    if (read(&width, 4, 1) != 1)
     {
         GP_ERROR("Failed to read texture width for font '%s'.", id);
         SAFE_DELETE_ARRAY(glyphs);
         return NULL;
     }
-    if (fread(&height, 4, 1, _file) != 1)
+    if (read(&height, 4, 1) != 1)
     {
         GP_ERROR("Failed to read texture height for font '%s'.", id);
         SAFE_DELETE_ARRAY(glyphs);
         return NULL;
     }
-    if (fread(&textureByteCount, 4, 1, _file) != 1)
+    if (read(&textureByteCount, 4, 1) != 1)
     {
         GP_ERROR("Failed to read texture byte count for font '%s'.", id);
         SAFE_DELETE_ARRAY(glyphs);
@@ -1687,7 +2148,7 @@ Font* Bundle::loadFont(const char* id)
     
     // Read texture data.
     unsigned char* textureData = new unsigned char[textureByteCount];
-    if (fread(textureData, 1, textureByteCount, _file) != textureByteCount)
+    if (read(textureData, 1, textureByteCount) != textureByteCount)
     {
         GP_ERROR("Failed to read texture data for font '%s'.", id);
         SAFE_DELETE_ARRAY(glyphs);
@@ -1766,23 +2227,30 @@ Bundle::Reference::~Reference()
 }
 
 Bundle::MeshPartData::MeshPartData() :
-    indexCount(0), indexData(NULL)
+    indexCount(0), indexData(NULL), indexDataMapped(false)
 {
 }
 
 Bundle::MeshPartData::~MeshPartData()
 {
-    SAFE_DELETE_ARRAY(indexData);
+    // Data in the mapped file belongs to the bundle.
+    if (!indexDataMapped)
+    {
+        SAFE_DELETE_ARRAY(indexData);
+    }
 }
 
 Bundle::MeshData::MeshData(const VertexFormat& vertexFormat)
-    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL)
+    : vertexFormat(vertexFormat), vertexCount(0), vertexData(NULL), vertexDataMapped(false)
 {
 }
 
 Bundle::MeshData::~MeshData()
 {
-    SAFE_DELETE_ARRAY(vertexData);
+    if (!vertexDataMapped)
+    {
+        SAFE_DELETE_ARRAY(vertexData);
+    }
 
     for (unsigned int i = 0; i < parts.size(); ++i)
     {
@@ -17,6 +17,7 @@ class Bundle : public Ref
 {
     friend class PhysicsController;
     friend class SceneLoader;
+    friend class AssetLoader;
 
 public:
 
@@ -133,6 +134,7 @@ private:
         Mesh::IndexFormat indexFormat;
         unsigned int indexCount;
         unsigned char* indexData;
+        bool indexDataMapped;
     };
 
     struct MeshData
@@ -143,12 +145,26 @@ private:
         VertexFormat vertexFormat;
         unsigned int vertexCount;
         unsigned char* vertexData;
+        bool vertexDataMapped;
         BoundingBox boundingBox;
         BoundingSphere boundingSphere;
         Mesh::PrimitiveType primitiveType;
         std::vector<MeshPartData*> parts;
     };
 
+    /**
+     * A chunk of the data of a compressed bundle.
+     */
+    struct Chunk
+    {
+        unsigned int offset;
+        unsigned int size;
+        unsigned int fileOffset;
+        unsigned int fileSize;
+        unsigned char* data;
+        unsigned int lastUse;
+    };
+
     Bundle(const char* path);
 
     /**
@@ -161,11 +177,40 @@ private:
      */
     Bundle& operator=(const Bundle&);
 
+    /**
+     * Opens a bundle without looking it up in the bundle cache.
+     *
+     * The bundle is not shared with any other thread until this returns, so unlike
+     * create() this may run on a worker thread.
+     *
+     * @param path The path of the bundle file.
+     *
+     * @return The new bundle, or NULL if it could not be opened.
+     */
+    static Bundle* open(const char* path);
+
+    /**
+     * Reads the data of every mesh in the bundle ahead of time, so that loading a scene
+     * or mesh afterwards only has to create the vertex and index buffers.
+     *
+     * This does not touch OpenGL or any shared state, so it may run on a worker thread
+     * as long as no other thread uses the bundle meanwhile.
+     *
+     * @return true if all meshes were read, false otherwise.
+     */
+    bool preloadMeshes();
+
     /**
      * Finds a reference by ID.
      */
     Reference* find(const char* id) const;
 
+    /**
+     * Builds the indices used to look up references by ID and by offset.
+     * Called once the reference table has been read.
+     */
+    void buildReferenceIndex();
+
     /**
      * Resets any load session specific state for the bundle.
      */
@@ -231,6 +276,68 @@ private:
      */
     Mesh* loadMesh(const char* id, const char* nodeId);
 
+    /**
+     * Reads count elements of the given size from the current file position.
+     *
+     * Reads from the decompressed chunks of a compressed bundle, from the mapped file
+     * when the bundle is mapped and from the file otherwise, with the same semantics
+     * as fread. The file position of a compressed bundle is a position within its
+     * uncompressed data.
+     *
+     * @param ptr The destination of the data.
+     * @param size The size of an element, in bytes.
+     * @param count The number of elements to read.
+     *
+     * @return The number of whole elements read.
+     */
+    size_t read(void* ptr, size_t size, size_t count);
+
+    /**
+     * Sets the current file position, with the same semantics as fseek.
+     *
+     * @param offset The offset, in bytes, relative to origin.
+     * @param origin SEEK_SET, SEEK_CUR or SEEK_END.
+     *
+     * @return Zero if successful, nonzero if an error occurred.
+     */
+    int seek(long offset, int origin);
+
+    /**
+     * Returns the current file position.
+     *
+     * @return The current file position, in bytes.
+     */
+    long tell() const;
+
+    /**
+     * Returns a pointer to the next size bytes of the mapped file and skips over them,
+     * so that they can be used without being copied.
+     *
+     * @param size The number of bytes.
+     *
+     * @return A pointer into the mapped file, or NULL if the bundle is not mapped or is
+     *      compressed (the file position is then unchanged) or the file is too short.
+     */
+    const unsigned char* readInPlace(size_t size);
+
+    /**
+     * Returns the chunk of a compressed bundle that holds the given position within the
+     * uncompressed data, decompressing it if needed.
+     *
+     * @param position The position within the uncompressed data.
+     *
+     * @return The chunk, or NULL if the position is past the end of the data or
+     *      the chunk could not be decompressed.
+     */
+    const Chunk* loadChunk(size_t position);
+
+    /**
+     * Reads a length-prefixed string from the current file position.
+     *
+     * @return The string, which is empty if an error occurred.
+     */
+    std::string readString();
+
     /**
      * Reads an unsigned int from the current file position.
      *
@@ -341,8 +448,11 @@ private:
 
     /**
      * Reads mesh data from the current file position.
+     *
+     * @param inPlace Whether the vertex and index data may point into the mapped file
+     *      rather than being copied, in which case the mesh data must not outlive the bundle.
      */
-    MeshData* readMeshData();
+    MeshData* readMeshData(bool inPlace = false);
 
     /**
      * Reads mesh data for the specified URL.
@@ -429,7 +539,21 @@ private:
     std::string _path;
     unsigned int _referenceCount;
     Reference* _references;
+    // Open-addressed hash table of reference indices plus one (zero marks an empty slot).
+    std::vector<unsigned int> _referenceIds;
+    // (offset, index) pairs of all references, sorted.
+    std::vector<std::pair<unsigned int, unsigned int> > _referenceOffsets;
     FILE* _file;
+    const unsigned char* _mappedData;
+    size_t _mappedSize;
+    // Position within the mapped file, or within the uncompressed data of a compressed bundle.
+    size_t _position;
+    std::vector<Chunk> _chunks;
+    unsigned int _currentChunk;
+    unsigned int _chunkUseCount;
+
+    // Mesh data read by preloadMeshes(), indexed like _references, until loadMesh() takes it.
+    std::vector<MeshData*> _preloadedMeshes;
 
     std::vector<MeshSkinData*> _meshSkins;
     std::map<std::string, Node*>* _trackedNodes;
@@ -17,15 +17,19 @@
 namespace gameplay
 {
 
+// Source of camera change stamps. Every camera takes a new value whenever its
+// view or projection changes, so a stamp is never reused by a different camera.
+static unsigned int __cameraStamp = 0;
+
 Camera::Camera(float fieldOfView, float aspectRatio, float nearPlane, float farPlane)
     : _type(PERSPECTIVE), _fieldOfView(fieldOfView), _aspectRatio(aspectRatio), _nearPlane(nearPlane), _farPlane(farPlane),
-      _dirtyBits(CAMERA_DIRTY_ALL), _node(NULL)
+      _dirtyBits(CAMERA_DIRTY_ALL), _stamp(++__cameraStamp), _node(NULL)
 {
 }
 
 Camera::Camera(float zoomX, float zoomY, float aspectRatio, float nearPlane, float farPlane)
     : _type(ORTHOGRAPHIC), _aspectRatio(aspectRatio), _nearPlane(nearPlane), _farPlane(farPlane),
-      _dirtyBits(CAMERA_DIRTY_ALL), _node(NULL)
+      _dirtyBits(CAMERA_DIRTY_ALL), _stamp(++__cameraStamp), _node(NULL)
 {
     // Orthographic camera.
     _zoom[0] = zoomX;
@@ -64,6 +68,7 @@ void Camera::setFieldOfView(float fieldOfView)
 
     _fieldOfView = fieldOfView;
     _dirtyBits |= CAMERA_DIRTY_PROJ | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+    _stamp = ++__cameraStamp;
 }
 
 float Camera::getZoomX() const
@@ -79,6 +84,7 @@ void Camera::setZoomX(float zoomX)
 
     _zoom[0] = zoomX;
     _dirtyBits |= CAMERA_DIRTY_PROJ | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+    _stamp = ++__cameraStamp;
 }
 
 float Camera::getZoomY() const
@@ -94,6 +100,7 @@ void Camera::setZoomY(float zoomY)
 
     _zoom[1] = zoomY;
     _dirtyBits |= CAMERA_DIRTY_PROJ | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+    _stamp = ++__cameraStamp;
 }
 
 float Camera::getAspectRatio() const
@@ -105,6 +112,7 @@ void Camera::setAspectRatio(float aspectRatio)
 {
     _aspectRatio = aspectRatio;
     _dirtyBits |= CAMERA_DIRTY_PROJ | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+    _stamp = ++__cameraStamp;
 }
 
 float Camera::getNearPlane() const
@@ -116,6 +124,7 @@ void Camera::setNearPlane(float nearPlane)
 {
     _nearPlane = nearPlane;
     _dirtyBits |= CAMERA_DIRTY_PROJ | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+    _stamp = ++__cameraStamp;
 }
 
 float Camera::getFarPlane() const
@@ -127,6 +136,7 @@ void Camera::setFarPlane(float farPlane)
 {
     _farPlane = farPlane;
     _dirtyBits |= CAMERA_DIRTY_PROJ | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+    _stamp = ++__cameraStamp;
 }
 
 Node* Camera::getNode() const
@@ -152,6 +162,7 @@ void Camera::setNode(Node* node)
         }
 
         _dirtyBits |= CAMERA_DIRTY_VIEW | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_INV_VIEW | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+        _stamp = ++__cameraStamp;
     }
 }
 
@@ -337,6 +348,7 @@ Camera* Camera::clone(NodeCloneContext &context) const
 void Camera::transformChanged(Transform* transform, long cookie)
 {
     _dirtyBits |= CAMERA_DIRTY_VIEW | CAMERA_DIRTY_INV_VIEW | CAMERA_DIRTY_INV_VIEW_PROJ | CAMERA_DIRTY_VIEW_PROJ | CAMERA_DIRTY_BOUNDS;
+    _stamp = ++__cameraStamp;
 }
 
 }
@@ -282,6 +282,7 @@ private:
     mutable Matrix _inverseViewProjection;
     mutable Frustum _bounds;
     mutable int _dirtyBits;
+    unsigned int _stamp;
     Node* _node;
 };
 
@@ -89,23 +89,34 @@ Curve* Curve::create(unsigned int pointCount, unsigned int componentCount)
 }
 
 Curve::Curve(unsigned int pointCount, unsigned int componentCount)
-    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL)
+    : _pointCount(pointCount), _componentCount(componentCount), _componentSize(sizeof(float)*componentCount), _quaternionOffset(NULL), _points(NULL),
+      _times(NULL), _values(NULL), _inValues(NULL), _outValues(NULL)
 {
+    // Key data is stored in contiguous arrays (one per attribute) so that sampling
+    // walks memory linearly; the points reference their slice of each array.
     _points = new Point[_pointCount];
+    _times = new float[_pointCount];
+    _values = new float[_pointCount * _componentCount];
+    _inValues = new float[_pointCount * _componentCount];
+    _outValues = new float[_pointCount * _componentCount];
     for (unsigned int i = 0; i < _pointCount; i++)
     {
-        _points[i].time = 0.0f;
-        _points[i].value = new float[_componentCount];
-        _points[i].inValue = new float[_componentCount];
-        _points[i].outValue = new float[_componentCount];
+        _points[i].time = _times[i] = 0.0f;
+        _points[i].value = _values + i * _componentCount;
+        _points[i].inValue = _inValues + i * _componentCount;
+        _points[i].outValue = _outValues + i * _componentCount;
         _points[i].type = LINEAR;
     }
-    _points[_pointCount - 1].time = 1.0f;
+    _points[_pointCount - 1].time = _times[_pointCount - 1] = 1.0f;
 }
 
 Curve::~Curve()
 {
     SAFE_DELETE_ARRAY(_points);
+    SAFE_DELETE_ARRAY(_times);
+    SAFE_DELETE_ARRAY(_values);
+    SAFE_DELETE_ARRAY(_inValues);
+    SAFE_DELETE_ARRAY(_outValues);
     SAFE_DELETE_ARRAY(_quaternionOffset);
 }
 
@@ -116,9 +127,6 @@ Curve::Point::Point()
 
 Curve::Point::~Point()
 {
-    SAFE_DELETE_ARRAY(value);
-    SAFE_DELETE_ARRAY(inValue);
-    SAFE_DELETE_ARRAY(outValue);
 }
 
 unsigned int Curve::getPointCount() const
@@ -150,7 +158,7 @@ void Curve::setPoint(unsigned int index, float time, float* value, Interpolation
 {
     assert(index < _pointCount && time >= 0.0f && time <= 1.0f && !(_pointCount > 1 && index == 0 && time != 0.0f) && !(_pointCount != 1 && index == _pointCount - 1 && time != 1.0f));
 
-    _points[index].time = time;
+    _points[index].time = _times[index] = time;
     _points[index].type = type;
 
     if (value)
@@ -194,8 +202,57 @@ void Curve::evaluate(float time, float* dst) const
     }
 
     // Locate the points we are interpolating between using a binary search.
-    unsigned int index = determineIndex(time);
-    
+    evaluateSegment(time, determineIndex(time), dst);
+}
+
+void Curve::evaluate(float time, float* dst, unsigned int* index) const
+{
+    assert(dst && index && time >= 0 && time <= 1.0f);
+
+    if (_pointCount == 1 || time <= _times[0])
+    {
+        *index = 0;
+        memcpy(dst, _points[0].value, _componentSize);
+        return;
+    }
+    else if (time >= _times[_pointCount - 1])
+    {
+        *index = _pointCount - 2;
+        memcpy(dst, _points[_pointCount - 1].value, _componentSize);
+        return;
+    }
+
+    // Playback usually stays within the same segment or moves to a neighbouring one
+    // between evaluations, so check around the cached index before searching.
+    unsigned int i = *index;
+    if (i > _pointCount - 2)
+        i = _pointCount - 2;
+
+    if (time >= _times[i])
+    {
+        if (time > _times[i + 1])
+        {
+            if (i + 2 < _pointCount && time <= _times[i + 2])
+                ++i;
+            else
+                i = determineIndex(time);
+        }
+    }
+    else if (i > 0 && time >= _times[i - 1])
+    {
+        --i;
+    }
+    else
+    {
+        i = determineIndex(time);
+    }
+
+    *index = i;
+    evaluateSegment(time, i, dst);
+}
+
+void Curve::evaluateSegment(float time, unsigned int index, float* dst) const
+{
     Point* from = _points + index;
     Point* to = _points + (index + 1);
 
@@ -1168,9 +1225,9 @@ int Curve::determineIndex(float time) const
     {
         mid = (min + max) >> 1;
 
-        if (time >= _points[mid].time && time <= _points[mid + 1].time)
+        if (time >= _times[mid] && time <= _times[mid + 1])
             return mid;
-        else if (time < _points[mid].time)
+        else if (time < _times[mid])
             max = mid - 1;
         else
             min = mid + 1;
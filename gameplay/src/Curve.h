@@ -352,6 +352,20 @@ public:
      */
     void evaluate(float time, float* dst) const;
 
+    /**
+     * Evaluates the curve at the given position value (between 0.0 and 1.0 inclusive),
+     * starting the keyframe search at a cached index.
+     *
+     * When a curve is sampled at steadily advancing (or retreating) times the segment
+     * rarely changes between calls, so this avoids the binary search of evaluate(float, float*).
+     *
+     * @param time The position to evaluate the curve at.
+     * @param dst The evaluated value of the curve at the given time.
+     * @param index The index of the point the previous evaluation started from (0 initially).
+     *      Updated with the index of the point used for this evaluation.
+     */
+    void evaluate(float time, float* dst, unsigned int* index) const;
+
     /**
      * Linear interpolation function.
      */
@@ -421,6 +435,11 @@ private:
      */
     Curve& operator=(const Curve&);
 
+    /**
+     * Evaluates the curve between the point at index and the next point.
+     */
+    void evaluateSegment(float time, unsigned int index, float* dst) const;
+
     /**
      * Bezier interpolation function.
      */
@@ -484,6 +503,10 @@ private:
     unsigned int _componentSize;        // The component size (in bytes).
     unsigned int* _quaternionOffset;    // Offset for the rotation component.
     Point* _points;                     // The points on the curve.
+    float* _times;                      // The times of the points, contiguous for searching.
+    float* _values;                     // The values of the points, contiguous by point.
+    float* _inValues;                   // The incoming tangents of the points, contiguous by point.
+    float* _outValues;                  // The outgoing tangents of the points, contiguous by point.
 };
 
 }
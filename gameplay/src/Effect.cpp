@@ -10,8 +10,17 @@ namespace gameplay
 // Cache of unique effects.
 static std::map<std::string, Effect*> __effectCache;
 static Effect* __currentEffect = NULL;
+static unsigned int __uniformUploadCount = 0;
+static unsigned int __uniformUploadSkippedCount = 0;
 
-Effect::Effect() : _program(0)
+// Interned uniform name identifiers (and the names, indexed by identifier).
+static std::map<std::string, unsigned int> __uniformIds;
+static std::vector<const char*> __uniformNames;
+
+// Serial number handed out to each new effect (zero is never used).
+static unsigned int __effectSerial = 0;
+
+Effect::Effect() : _program(0), _serial(++__effectSerial)
 {
 }
 
@@ -410,11 +419,17 @@ Effect* Effect::createFromSource(const char* vshPath, const char* vshSource, con
                 Uniform* uniform = new Uniform();
                 uniform->_effect = effect;
                 uniform->_name = uniformName;
+                uniform->_id = getUniformId(uniformName);
                 uniform->_location = uniformLocation;
                 uniform->_type = uniformType;
                 uniform->_index = uniformType == GL_SAMPLER_2D ? (samplerIndex++) : 0;
 
                 effect->_uniforms[uniformName] = uniform;
+                if (uniform->_id >= effect->_uniformsById.size())
+                {
+                    effect->_uniformsById.resize(uniform->_id + 1, NULL);
+                }
+                effect->_uniformsById[uniform->_id] = uniform;
             }
             SAFE_DELETE_ARRAY(uniformName);
         }
@@ -458,82 +473,159 @@ unsigned int Effect::getUniformCount() const
     return _uniforms.size();
 }
 
+Uniform* Effect::getUniformById(unsigned int id) const
+{
+    return id < _uniformsById.size() ? _uniformsById[id] : NULL;
+}
+
+unsigned int Effect::getUniformId(const char* name)
+{
+    GP_ASSERT(name);
+
+    std::map<std::string, unsigned int>::const_iterator itr = __uniformIds.find(name);
+    if (itr != __uniformIds.end())
+    {
+        return itr->second;
+    }
+
+    unsigned int id = __uniformNames.size();
+    itr = __uniformIds.insert(std::make_pair(std::string(name), id)).first;
+    __uniformNames.push_back(itr->first.c_str());
+    return id;
+}
+
+bool Effect::findUniformId(const char* name, unsigned int* id)
+{
+    GP_ASSERT(name);
+    GP_ASSERT(id);
+
+    std::map<std::string, unsigned int>::const_iterator itr = __uniformIds.find(name);
+    if (itr == __uniformIds.end())
+    {
+        return false;
+    }
+    *id = itr->second;
+    return true;
+}
+
+const char* Effect::getUniformName(unsigned int id)
+{
+    GP_ASSERT(id < __uniformNames.size());
+    return __uniformNames[id];
+}
+
 void Effect::setValue(Uniform* uniform, float value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1f(uniform->_location, value) );
+    if (uniform->updateValue(&value, sizeof(float)))
+    {
+        GL_ASSERT( glUniform1f(uniform->_location, value) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const float* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    if (uniform->updateValue(values, sizeof(float) * count))
+    {
+        GL_ASSERT( glUniform1fv(uniform->_location, count, values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, int value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform1i(uniform->_location, value) );
+    if (uniform->updateValue(&value, sizeof(int)))
+    {
+        GL_ASSERT( glUniform1i(uniform->_location, value) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const int* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    if (uniform->updateValue(values, sizeof(int) * count))
+    {
+        GL_ASSERT( glUniform1iv(uniform->_location, count, values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    if (uniform->updateValue(value.m, sizeof(Matrix)))
+    {
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, 1, GL_FALSE, value.m) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Matrix* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(Matrix) * count))
+    {
+        GL_ASSERT( glUniformMatrix4fv(uniform->_location, count, GL_FALSE, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    if (uniform->updateValue(&value, sizeof(Vector2)))
+    {
+        GL_ASSERT( glUniform2f(uniform->_location, value.x, value.y) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector2* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(Vector2) * count))
+    {
+        GL_ASSERT( glUniform2fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    if (uniform->updateValue(&value, sizeof(Vector3)))
+    {
+        GL_ASSERT( glUniform3f(uniform->_location, value.x, value.y, value.z) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector3* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(Vector3) * count))
+    {
+        GL_ASSERT( glUniform3fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4& value)
 {
     GP_ASSERT(uniform);
-    GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    if (uniform->updateValue(&value, sizeof(Vector4)))
+    {
+        GL_ASSERT( glUniform4f(uniform->_location, value.x, value.y, value.z, value.w) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Vector4* values, unsigned int count)
 {
     GP_ASSERT(uniform);
     GP_ASSERT(values);
-    GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    if (uniform->updateValue(values, sizeof(Vector4) * count))
+    {
+        GL_ASSERT( glUniform4fv(uniform->_location, count, (GLfloat*)values) );
+    }
 }
 
 void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
@@ -547,14 +639,22 @@ void Effect::setValue(Uniform* uniform, const Texture::Sampler* sampler)
     // Bind the sampler - this binds the texture and applies sampler state
     const_cast<Texture::Sampler*>(sampler)->bind();
 
-    GL_ASSERT( glUniform1i(uniform->_location, uniform->_index) );
+    // The texture unit assigned to a sampler uniform never changes, so it only needs to be set once.
+    GLint unit = (GLint)uniform->_index;
+    if (uniform->updateValue(&unit, sizeof(GLint)))
+    {
+        GL_ASSERT( glUniform1i(uniform->_location, unit) );
+    }
 }
 
 void Effect::bind()
 {
-   glUseProgram(_program) ;
-   GLenum test = glGetError();
-    __currentEffect = this;
+    // Skip redundant program changes.
+    if (__currentEffect != this)
+    {
+        GL_ASSERT( glUseProgram(_program) );
+        __currentEffect = this;
+    }
 }
 
 Effect* Effect::getCurrentEffect()
@@ -562,14 +662,54 @@ Effect* Effect::getCurrentEffect()
     return __currentEffect;
 }
 
+unsigned int Effect::getUniformUploadCount()
+{
+    return __uniformUploadCount;
+}
+
+unsigned int Effect::getUniformUploadSkippedCount()
+{
+    return __uniformUploadSkippedCount;
+}
+
+void Effect::resetUniformUploadCounts()
+{
+    __uniformUploadCount = 0;
+    __uniformUploadSkippedCount = 0;
+}
+
 Uniform::Uniform() :
-    _location(-1), _type(0), _index(0)
+    _id(0), _location(-1), _type(0), _index(0), _value(NULL), _valueSize(0)
 {
 }
 
 Uniform::~Uniform()
 {
-    // hidden
+    SAFE_DELETE_ARRAY(_value);
+}
+
+bool Uniform::updateValue(const void* value, unsigned int size)
+{
+    GP_ASSERT(value);
+
+    // Uniform values are part of the program object, so they persist between binds
+    // of the effect and only need to be uploaded when they change.
+    if (_value && _valueSize == size && memcmp(_value, value, size) == 0)
+    {
+        ++__uniformUploadSkippedCount;
+        return false;
+    }
+
+    if (_valueSize != size)
+    {
+        SAFE_DELETE_ARRAY(_value);
+        _value = new unsigned char[size];
+        _valueSize = size;
+    }
+    memcpy(_value, value, size);
+
+    ++__uniformUploadCount;
+    return true;
 }
 
 Effect* Uniform::getEffect() const
@@ -587,4 +727,9 @@ const GLenum Uniform::getType() const
     return _type;
 }
 
+unsigned int Uniform::getId() const
+{
+    return _id;
+}
+
 }
@@ -25,6 +25,9 @@ class Uniform;
  */
 class Effect: public Ref
 {
+    friend class RenderQueue;
+    friend class MaterialParameter;
+
 public:
 
     /**
@@ -89,6 +92,55 @@ public:
      */
     unsigned int getUniformCount() const;
 
+    /**
+     * Returns the uniform with the specified name identifier.
+     *
+     * This avoids string lookups in code that runs every frame.
+     *
+     * @param id The identifier of the uniform's name (see getUniformId).
+     *
+     * @return The uniform, or NULL if no such uniform exists.
+     */
+    Uniform* getUniformById(unsigned int id) const;
+
+    /**
+     * Returns the identifier for the specified uniform name.
+     *
+     * Names are interned on first use, so a name maps to the same identifier
+     * for all effects and material parameters. Interned names are never released,
+     * so this should only be used for names declared by shaders; use findUniformId
+     * to look up arbitrary names. The name table is not synchronized and must only
+     * be accessed from the main (rendering) thread.
+     *
+     * @param name The uniform name.
+     *
+     * @return The identifier of the name.
+     */
+    static unsigned int getUniformId(const char* name);
+
+    /**
+     * Looks up the identifier for the specified uniform name without interning it.
+     *
+     * Every uniform of a loaded effect has an identifier, so a name that is not
+     * found here is not declared by any effect. Must only be called from the
+     * main (rendering) thread.
+     *
+     * @param name The uniform (or material parameter) name.
+     * @param id Receives the identifier of the name, if found.
+     *
+     * @return True if the name has an identifier, false otherwise.
+     */
+    static bool findUniformId(const char* name, unsigned int* id);
+
+    /**
+     * Returns the uniform name for the specified identifier.
+     *
+     * @param id An identifier returned by getUniformId.
+     *
+     * @return The name the identifier was created for.
+     */
+    static const char* getUniformName(unsigned int id);
+
     /**
      * Sets a float uniform value.
      *
@@ -211,6 +263,26 @@ public:
      */
     static Effect* getCurrentEffect();
 
+    /**
+     * Returns the number of uniform values uploaded to the GL since the counters were last reset.
+     *
+     * @return The number of uniform uploads issued.
+     */
+    static unsigned int getUniformUploadCount();
+
+    /**
+     * Returns the number of uniform uploads skipped since the counters were last reset,
+     * because the uniform already held the value being set.
+     *
+     * @return The number of uniform uploads skipped.
+     */
+    static unsigned int getUniformUploadSkippedCount();
+
+    /**
+     * Resets the uniform upload counters to zero.
+     */
+    static void resetUniformUploadCounts();
+
 private:
 
     /**
@@ -232,8 +304,10 @@ private:
 
     GLuint _program;
     std::string _id;
+    unsigned int _serial;
     std::map<std::string, VertexAttribute> _vertexAttributes;
     std::map<std::string, Uniform*> _uniforms;
+    std::vector<Uniform*> _uniformsById;
     static Uniform _emptyUniform;
 };
 
@@ -267,6 +341,13 @@ public:
      */
     Effect* getEffect() const;
 
+    /**
+     * Returns the identifier of this uniform's name (see Effect::getUniformId).
+     *
+     * @return The identifier of the uniform's name.
+     */
+    unsigned int getId() const;
+
 private:
 
     /**
@@ -289,11 +370,22 @@ private:
      */
     Uniform& operator=(const Uniform&);
 
+    /**
+     * Records the given value as the value of this uniform.
+     *
+     * @return true if the value differs from the one last uploaded and must be
+     *      sent to the GL; false if the upload can be skipped.
+     */
+    bool updateValue(const void* value, unsigned int size);
+
     std::string _name;
+    unsigned int _id;
     GLint _location;
     GLenum _type;
     unsigned int _index;
     Effect* _effect;
+    unsigned char* _value;
+    unsigned int _valueSize;
 };
 
 }
@@ -11,8 +11,10 @@
     #include <stdio.h>
     #define gp_stat _stat
     #define gp_stat_struct struct stat
+    #include <io.h>
 #else
     #include <dirent.h>
+    #include <sys/mman.h>
     #define gp_stat stat
     #define gp_stat_struct struct stat
 #endif
@@ -254,6 +256,52 @@ FILE* FileSystem::openFile(const char* path, const char* mode)
     return fp;
 }
 
+const void* FileSystem::mapFile(FILE* file, size_t* size)
+{
+    GP_ASSERT(file);
+    GP_ASSERT(size);
+
+    *size = 0;
+#ifdef WIN32
+    HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
+    LARGE_INTEGER fileSize;
+    if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0 || fileSize.HighPart != 0)
+        return NULL;
+
+    // The view keeps the mapping object alive, so its handle can be closed right away.
+    HANDLE mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+        return NULL;
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == NULL)
+        return NULL;
+    *size = (size_t)fileSize.LowPart;
+#else
+    int fd = fileno(file);
+    gp_stat_struct s;
+    if (fd == -1 || fstat(fd, &s) != 0 || s.st_size <= 0)
+        return NULL;
+
+    void* data = mmap(NULL, (size_t)s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+        return NULL;
+    *size = (size_t)s.st_size;
+#endif
+    return data;
+}
+
+void FileSystem::unmapFile(const void* data, size_t size)
+{
+    if (data == NULL)
+        return;
+#ifdef WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<void*>(data), size);
+#endif
+}
+
 char* FileSystem::readAll(const char* filePath, int* fileSize)
 {
     GP_ASSERT(filePath);
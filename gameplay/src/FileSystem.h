@@ -115,6 +115,30 @@ public:
      */
     static FILE* openFile(const char* filePath, const char* mode);
 
+    /**
+     * Maps the contents of an open file into memory for reading.
+     *
+     * The mapping stays valid after the file is closed and must be released with
+     * unmapFile(). Mapping fails on platforms without memory-mapped files, and for
+     * empty files, in which case the file should be read with fread instead.
+     *
+     * @param file The file to map. Its position is not changed.
+     * @param size Populated with the size of the mapping (the size of the file), in bytes.
+     *
+     * @return A read-only pointer to the contents of the file, or NULL if it could not be mapped.
+     * @script{ignore}
+     */
+    static const void* mapFile(FILE* file, size_t* size);
+
+    /**
+     * Releases a mapping returned by mapFile().
+     *
+     * @param data The mapped data.
+     * @param size The size of the mapping, in bytes.
+     * @script{ignore}
+     */
+    static void unmapFile(const void* data, size_t size);
+
     /**
      * Reads the entire contents of the specified file and returns its contents.
      *
@@ -5,6 +5,8 @@
 #include "FileSystem.h"
 #include "FrameBuffer.h"
 #include "SceneLoader.h"
+#include "ThreadPool.h"
+#include "AssetLoader.h"
 
 /** @script{ignore} */
 GLenum __gl_error_code = GL_NO_ERROR;
@@ -24,7 +26,7 @@ Game::Game()
       _clearDepth(1.0f), _clearStencil(0), _properties(NULL),
       _animationController(NULL), _audioController(NULL), 
       _physicsController(NULL), _aiController(NULL), _audioListener(NULL), 
-      _gamepads(NULL), _timeEvents(NULL), _scriptController(NULL), _scriptListeners(NULL)
+      _gamepads(NULL), _timeEvents(NULL), _scriptController(NULL), _scriptListeners(NULL), _threadPool(NULL), _assetLoader(NULL)
 {
     GP_ASSERT(__gameInstance == NULL);
     __gameInstance = this;
@@ -111,6 +113,8 @@ bool Game::startup()
     setViewport(Rectangle(0.0f, 0.0f, (float)_width, (float)_height));
     RenderState::initialize();
     FrameBuffer::initialize();
+
+    _threadPool = ThreadPool::create();
     
     _animationController = new AnimationController();
     _animationController->initialize();
@@ -182,6 +186,9 @@ void Game::shutdown()
         Platform::signalShutdown();
         finalize();
 
+        // Requests still pending are failed before the controllers they load for go away.
+        SAFE_DELETE(_assetLoader);
+
         
         std::vector<Gamepad*>::iterator itr = _gamepads->begin();
         std::vector<Gamepad*>::iterator end = _gamepads->end();
@@ -206,6 +213,8 @@ void Game::shutdown()
         _aiController->finalize();
         SAFE_DELETE(_aiController);
 
+        SAFE_DELETE(_threadPool);
+
         // Note: we do not clean up the script controller here
         // because users can call Game::exit() from a script.
 
@@ -267,6 +276,10 @@ void Game::frame()
         _initialized = true;
     }
 
+    // Finalize background loads within the frame budget, so listeners see them before update().
+    if (_assetLoader)
+        _assetLoader->update();
+
     if (_state == Game::RUNNING)
     {
         GP_ASSERT(_animationController);
@@ -408,6 +421,16 @@ void Game::clear(ClearFlags flags, const Vector4& clearColor, float clearDepth,
     glClear(bits);
 }
 
+AssetLoader* Game::getAssetLoader()
+{
+    if (_assetLoader == NULL)
+    {
+        GP_ASSERT(_threadPool);
+        _assetLoader = AssetLoader::create(_threadPool);
+    }
+    return _assetLoader;
+}
+
 AudioListener* Game::getAudioListener()
 {
     if (_audioListener == NULL)
@@ -20,6 +20,8 @@ namespace gameplay
 {
 
 class ScriptController;
+class ThreadPool;
+class AssetLoader;
 
 /**
  * Defines the basic game initialization, logic and platform delegates.
@@ -236,6 +238,25 @@ public:
      */
     inline ScriptController* getScriptController() const;
 
+    /**
+     * Gets the thread pool that engine systems use to spread per-frame
+     * work over the available cores.
+     *
+     * @return The thread pool for this game.
+     */
+    inline ThreadPool* getThreadPool() const;
+
+    /**
+     * Gets the asset loader that loads assets in the background and
+     * finalizes them on the main thread at the start of each frame.
+     *
+     * The loader is created on first use and runs its background steps
+     * on the game's thread pool.
+     *
+     * @return The asset loader for this game.
+     */
+    AssetLoader* getAssetLoader();
+
     /**
      * Gets the audio listener for 3D audio.
      * 
@@ -564,6 +585,8 @@ private:
     std::priority_queue<TimeEvent, std::vector<TimeEvent>, std::less<TimeEvent> >* _timeEvents;     // Contains the scheduled time events.
     ScriptController* _scriptController;            // Controls the scripting engine.
     std::vector<ScriptListener*>* _scriptListeners; // Lua script listeners.
+    ThreadPool* _threadPool;                        // Worker threads shared by the engine systems.
+    AssetLoader* _assetLoader;                      // Loads assets in the background.
 
     // Note: Do not add STL object member variables on the stack; this will cause false memory leaks to be reported.
 
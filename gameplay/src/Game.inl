@@ -53,6 +53,12 @@ inline ScriptController* Game::getScriptController() const
 {
     return _scriptController;
 }
+
+inline ThreadPool* Game::getThreadPool() const
+{
+    return _threadPool;
+}
+
 inline AIController* Game::getAIController() const
 {
     return _aiController;
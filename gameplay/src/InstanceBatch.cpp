@@ -0,0 +1,353 @@
+#include "Base.h"
+#include "InstanceBatch.h"
+#include "MeshPart.h"
+#include "Technique.h"
+#include "Pass.h"
+
+namespace gameplay
+{
+
+// Returns the number of primitives of the given type that elementCount vertices (or indices) hold.
+static unsigned int getPrimitiveCount(Mesh::PrimitiveType primitiveType, unsigned int elementCount)
+{
+    switch (primitiveType)
+    {
+    case Mesh::LINES:
+        return elementCount / 2;
+    case Mesh::LINE_STRIP:
+        return elementCount > 1 ? elementCount - 1 : 1;
+    case Mesh::TRIANGLES:
+        return elementCount / 3;
+    case Mesh::TRIANGLE_STRIP:
+        return elementCount > 2 ? elementCount - 2 : 1;
+    default:
+        return elementCount;
+    }
+}
+
+InstanceBatch::InstanceBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, unsigned int initialCapacity)
+    : _vertexFormat(vertexFormat), _primitiveType(primitiveType), _material(NULL), _mesh(NULL), _instanceBuffer(0),
+      _instanceBufferCapacity(0), _batch(NULL), _vertices(NULL), _indices(NULL), _transformedVertices(NULL), _vertexCount(0), _indexCount(0), _chunkInstances(0)
+{
+    _instances.reserve(initialCapacity);
+}
+
+InstanceBatch::~InstanceBatch()
+{
+    if (_instanceBuffer)
+    {
+        GL_ASSERT( glDeleteBuffers(1, &_instanceBuffer) );
+        _instanceBuffer = 0;
+    }
+    SAFE_DELETE(_batch);
+    SAFE_RELEASE(_mesh);
+    SAFE_RELEASE(_material);
+    SAFE_DELETE_ARRAY(_vertices);
+    SAFE_DELETE_ARRAY(_indices);
+    SAFE_DELETE_ARRAY(_transformedVertices);
+}
+
+InstanceBatch* InstanceBatch::create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType,
+                                     const void* vertices, unsigned int vertexCount,
+                                     const unsigned short* indices, unsigned int indexCount,
+                                     const char* vshPath, const char* fshPath, const char* defines,
+                                     unsigned int initialCapacity)
+{
+    GP_ASSERT(vertices);
+    GP_ASSERT(vertexCount > 0);
+    GP_ASSERT(indices || indexCount == 0);
+
+    bool hardware = isHardwareInstancingSupported();
+
+    // The built-in shaders read the per-instance matrix when INSTANCED is defined.
+    std::string allDefines = defines ? defines : "";
+    if (hardware)
+    {
+        if (!allDefines.empty())
+            allDefines += "\n";
+        allDefines += "INSTANCED";
+    }
+
+    Material* material = Material::create(vshPath, fshPath, allDefines.c_str());
+    if (material == NULL)
+    {
+        GP_ERROR("Failed to create material for instance batch.");
+        return NULL;
+    }
+
+    InstanceBatch* batch = new InstanceBatch(vertexFormat, primitiveType, initialCapacity);
+    batch->_material = material;
+    batch->_vertexCount = vertexCount;
+    batch->_indexCount = indexCount;
+
+    unsigned int vertexBytes = vertexCount * vertexFormat.getVertexSize();
+    if (hardware)
+    {
+        // Upload the instanced geometry once, like any other mesh.
+        batch->_mesh = Mesh::createMesh(vertexFormat, vertexCount, false);
+        if (batch->_mesh == NULL)
+        {
+            GP_ERROR("Failed to create mesh for instance batch.");
+            SAFE_DELETE(batch);
+            return NULL;
+        }
+        batch->_mesh->setPrimitiveType(primitiveType);
+        batch->_mesh->setVertexData(reinterpret_cast<float*>(const_cast<void*>(vertices)));
+        if (indexCount > 0)
+        {
+            MeshPart* part = batch->_mesh->addPart(primitiveType, Mesh::INDEX16, indexCount, false);
+            GP_ASSERT(part);
+            part->setIndexData(const_cast<unsigned short*>(indices), 0, indexCount);
+        }
+
+        GL_ASSERT( glGenBuffers(1, &batch->_instanceBuffer) );
+
+        for (unsigned int i = 0, techniqueCount = material->getTechniqueCount(); i < techniqueCount; ++i)
+        {
+            Technique* technique = material->getTechniqueByIndex(i);
+            GP_ASSERT(technique);
+            for (unsigned int j = 0, passCount = technique->getPassCount(); j < passCount; ++j)
+            {
+                Pass* pass = technique->getPassByIndex(j);
+                GP_ASSERT(pass);
+                VertexAttributeBinding* b = VertexAttributeBinding::create(batch->_mesh, pass->getEffect());
+                pass->setVertexAttributeBinding(b);
+                SAFE_RELEASE(b);
+            }
+        }
+    }
+    else
+    {
+        // Keep a copy of the geometry to transform and merge on the CPU, which can
+        // only transform float positions, normals, tangents and binormals.
+        for (unsigned int i = 0, count = vertexFormat.getElementCount(); i < count; ++i)
+        {
+            const VertexFormat::Element& e = vertexFormat.getElement(i);
+            bool transformed = e.usage == VertexFormat::POSITION || e.usage == VertexFormat::NORMAL ||
+                               e.usage == VertexFormat::TANGENT || e.usage == VertexFormat::BINORMAL;
+            if (transformed && e.type != VertexFormat::FLOAT)
+            {
+                GP_ERROR("Instance batches without hardware instancing require float positions, normals, tangents and binormals.");
+                SAFE_DELETE(batch);
+                return NULL;
+            }
+        }
+
+        batch->_vertices = new unsigned char[vertexBytes];
+        memcpy(batch->_vertices, vertices, vertexBytes);
+        batch->_transformedVertices = new unsigned char[vertexBytes];
+        if (indexCount > 0)
+        {
+            batch->_indices = new unsigned short[indexCount];
+            memcpy(batch->_indices, indices, indexCount * sizeof(unsigned short));
+        }
+
+        // The merged batch uses 16-bit indices, so it holds at most USHRT_MAX vertices (and
+        // indices, since MeshBatch sizes both the same). Instances are drawn in chunks that fit
+        // the initial capacity, so that the batch never grows past that limit.
+        unsigned int elementCount = std::max(vertexCount, indexCount) + 2;
+        batch->_chunkInstances = std::max(1u, std::min(initialCapacity, (unsigned int)USHRT_MAX / elementCount));
+        unsigned int capacity = std::max(1u, getPrimitiveCount(primitiveType, batch->_chunkInstances * elementCount));
+        batch->_batch = MeshBatch::create(vertexFormat, primitiveType, material, indexCount > 0, capacity, capacity);
+    }
+
+    return batch;
+}
+
+bool InstanceBatch::isHardwareInstancingSupported()
+{
+#ifdef USE_INSTANCED_ARRAYS
+    return GLEW_ARB_instanced_arrays ? true : false;
+#else
+    return false;
+#endif
+}
+
+void InstanceBatch::transformVertices(const VertexFormat& vertexFormat, const void* vertices, unsigned int vertexCount, const Matrix& matrix, void* dst)
+{
+    GP_ASSERT(vertices);
+    GP_ASSERT(dst);
+
+    unsigned int vertexSize = vertexFormat.getVertexSize();
+    memcpy(dst, vertices, vertexCount * vertexSize);
+
+    unsigned int offset = 0;
+    for (unsigned int i = 0, count = vertexFormat.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& e = vertexFormat.getElement(i);
+
+        switch (e.type == VertexFormat::FLOAT ? e.usage : 0)
+        {
+        case VertexFormat::POSITION:
+            if (e.size == 3)
+            {
+                unsigned char* v = (unsigned char*)dst + offset;
+                for (unsigned int j = 0; j < vertexCount; ++j, v += vertexSize)
+                {
+                    matrix.transformPoint((Vector3*)v);
+                }
+            }
+            else if (e.size == 4)
+            {
+                unsigned char* v = (unsigned char*)dst + offset;
+                for (unsigned int j = 0; j < vertexCount; ++j, v += vertexSize)
+                {
+                    matrix.transformVector((Vector4*)v);
+                }
+            }
+            break;
+        case VertexFormat::NORMAL:
+        case VertexFormat::TANGENT:
+        case VertexFormat::BINORMAL:
+            if (e.size == 3)
+            {
+                unsigned char* v = (unsigned char*)dst + offset;
+                for (unsigned int j = 0; j < vertexCount; ++j, v += vertexSize)
+                {
+                    matrix.transformVector((Vector3*)v);
+                }
+            }
+            break;
+        default:
+            // All other elements are not affected by the instance transform.
+            break;
+        }
+
+        offset += e.getByteSize();
+    }
+}
+
+Material* InstanceBatch::getMaterial() const
+{
+    return _material;
+}
+
+void InstanceBatch::start()
+{
+    _instances.clear();
+}
+
+void InstanceBatch::add(const Matrix& worldMatrix)
+{
+    _instances.push_back(worldMatrix);
+}
+
+void InstanceBatch::finish()
+{
+    if (_instanceBuffer == 0 || _instances.empty())
+        return;
+
+    // Upload the instance matrices, growing the buffer if needed.
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer) );
+    unsigned int size = _instances.size() * sizeof(Matrix);
+    if (_instances.size() > _instanceBufferCapacity)
+    {
+        GL_ASSERT( glBufferData(GL_ARRAY_BUFFER, size, &_instances[0], GL_DYNAMIC_DRAW) );
+        _instanceBufferCapacity = _instances.size();
+    }
+    else
+    {
+        GL_ASSERT( glBufferSubData(GL_ARRAY_BUFFER, 0, size, &_instances[0]) );
+    }
+    GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, 0) );
+}
+
+unsigned int InstanceBatch::getInstanceCount() const
+{
+    return _instances.size();
+}
+
+void InstanceBatch::draw()
+{
+    if (_instances.empty())
+        return; // nothing to draw
+
+    if (_mesh)
+    {
+        drawInstanced();
+    }
+    else
+    {
+        drawMerged();
+    }
+}
+
+void InstanceBatch::drawInstanced()
+{
+#ifdef USE_INSTANCED_ARRAYS
+    GP_ASSERT(_mesh);
+    GP_ASSERT(_material);
+
+    MeshPart* part = _mesh->getPartCount() > 0 ? _mesh->getPart(0) : NULL;
+
+    Technique* technique = _material->getTechnique();
+    GP_ASSERT(technique);
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+        pass->bind();
+
+        // A mat4 attribute occupies four consecutive locations, one per column.
+        VertexAttribute attrib = pass->getEffect()->getVertexAttribute(VERTEX_ATTRIBUTE_INSTANCE_MATRIX_NAME);
+        if (attrib != -1)
+        {
+            GL_ASSERT( glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer) );
+            for (unsigned int c = 0; c < 4; ++c)
+            {
+                GL_ASSERT( glEnableVertexAttribArray(attrib + c) );
+                GL_ASSERT( glVertexAttribPointer(attrib + c, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix), (void*)(c * 4 * sizeof(float))) );
+                GL_ASSERT( glVertexAttribDivisorARB(attrib + c, 1) );
+            }
+        }
+
+        if (part)
+        {
+            // Bound after the pass, since binding its vertex array object replaces the index buffer binding.
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->getIndexBuffer()) );
+            GL_ASSERT( glDrawElementsInstancedARB(_primitiveType, _indexCount, GL_UNSIGNED_SHORT, 0, _instances.size()) );
+        }
+        else
+        {
+            GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+            GL_ASSERT( glDrawArraysInstancedARB(_primitiveType, 0, _vertexCount, _instances.size()) );
+        }
+
+        if (attrib != -1)
+        {
+            for (unsigned int c = 0; c < 4; ++c)
+            {
+                GL_ASSERT( glVertexAttribDivisorARB(attrib + c, 0) );
+                GL_ASSERT( glDisableVertexAttribArray(attrib + c) );
+            }
+        }
+
+        pass->unbind();
+    }
+#endif
+}
+
+void InstanceBatch::drawMerged()
+{
+    GP_ASSERT(_batch);
+    GP_ASSERT(_vertices);
+    GP_ASSERT(_transformedVertices);
+    GP_ASSERT(_chunkInstances > 0);
+
+    unsigned int chunkInstances = _chunkInstances;
+    for (unsigned int first = 0, count = _instances.size(); first < count; first += chunkInstances)
+    {
+        unsigned int last = std::min(first + chunkInstances, count);
+
+        _batch->start();
+        for (unsigned int i = first; i < last; ++i)
+        {
+            transformVertices(_vertexFormat, _vertices, _vertexCount, _instances[i], _transformedVertices);
+            _batch->addVertices(_transformedVertices, _vertexCount, _indices, _indexCount);
+        }
+        _batch->finish();
+        _batch->draw();
+    }
+}
+
+}
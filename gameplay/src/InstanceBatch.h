@@ -0,0 +1,156 @@
+#ifndef INSTANCEBATCH_H_
+#define INSTANCEBATCH_H_
+
+#include "Mesh.h"
+#include "MeshBatch.h"
+#include "Material.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a class for drawing many copies (instances) of the same geometry with
+ * as few draw calls as possible.
+ *
+ * Each instance is described by a world matrix. Where hardware instancing is
+ * supported, the matrices are uploaded into a per-instance vertex stream and all
+ * instances are drawn with a single instanced draw call per pass. The effect is
+ * compiled with the INSTANCED define, which makes the built-in shaders transform
+ * each vertex by the 'a_instanceMatrix' attribute. Otherwise, the instances are
+ * transformed on the CPU and merged into a MeshBatch.
+ *
+ * In both cases the resulting positions are in the space of the batch, so the
+ * material's auto-bindings (such as WORLD_VIEW_PROJECTION_MATRIX) apply on top
+ * of the instance matrices.
+ */
+class InstanceBatch
+{
+public:
+
+    /**
+     * Creates a new instance batch.
+     *
+     * The vertex and index data are copied, so they do not need to be kept after this call.
+     *
+     * @param vertexFormat The format of the vertices of the instanced geometry.
+     * @param primitiveType The type of primitives of the instanced geometry.
+     * @param vertices The vertices of the instanced geometry.
+     * @param vertexCount The number of vertices.
+     * @param indices The indices of the instanced geometry, or NULL for non-indexed geometry.
+     * @param indexCount The number of indices.
+     * @param vshPath The path to the vertex shader file.
+     * @param fshPath The path to the fragment shader file.
+     * @param defines A new-line delimited list of preprocessor defines. May be NULL.
+     * @param initialCapacity The initial capacity of the batch, in instances.
+     *
+     * @return A new instance batch, or NULL if the material could not be created.
+     */
+    static InstanceBatch* create(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType,
+                                 const void* vertices, unsigned int vertexCount,
+                                 const unsigned short* indices, unsigned int indexCount,
+                                 const char* vshPath, const char* fshPath, const char* defines = NULL,
+                                 unsigned int initialCapacity = 64);
+
+    /**
+     * Destructor.
+     */
+    ~InstanceBatch();
+
+    /**
+     * Determines whether the device supports hardware instancing.
+     *
+     * @return true if instances are drawn with instanced draw calls; false if they are merged on the CPU.
+     */
+    static bool isHardwareInstancingSupported();
+
+    /**
+     * Transforms the positions, normals, tangents and binormals of the given vertices
+     * by the specified matrix. Other vertex elements, and elements that are not of
+     * type float, are copied unchanged.
+     *
+     * This is the per-instance work of the CPU fallback path.
+     *
+     * @param vertexFormat The format of the vertices.
+     * @param vertices The vertices to transform.
+     * @param vertexCount The number of vertices.
+     * @param matrix The matrix to transform the vertices by.
+     * @param dst The destination for the transformed vertices (must not overlap vertices).
+     */
+    static void transformVertices(const VertexFormat& vertexFormat, const void* vertices, unsigned int vertexCount, const Matrix& matrix, void* dst);
+
+    /**
+     * Returns the material for this instance batch.
+     *
+     * @return The material used to draw the batch.
+     */
+    Material* getMaterial() const;
+
+    /**
+     * Starts batching, clearing any instances currently in the batch.
+     */
+    void start();
+
+    /**
+     * Adds an instance to the batch.
+     *
+     * @param worldMatrix The matrix transforming the instanced geometry into the space of the batch.
+     */
+    void add(const Matrix& worldMatrix);
+
+    /**
+     * Indicates that batching is complete and uploads the instances for drawing.
+     */
+    void finish();
+
+    /**
+     * Returns the number of instances in the batch.
+     *
+     * @return The number of instances.
+     */
+    unsigned int getInstanceCount() const;
+
+    /**
+     * Draws the instances currently in the batch.
+     */
+    void draw();
+
+private:
+
+    /**
+     * Constructor.
+     */
+    InstanceBatch(const VertexFormat& vertexFormat, Mesh::PrimitiveType primitiveType, unsigned int initialCapacity);
+
+    /**
+     * Hidden copy constructor.
+     */
+    InstanceBatch(const InstanceBatch& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    InstanceBatch& operator=(const InstanceBatch&);
+
+    void drawInstanced();
+
+    void drawMerged();
+
+    const VertexFormat _vertexFormat;
+    Mesh::PrimitiveType _primitiveType;
+    Material* _material;
+    std::vector<Matrix> _instances;
+    Mesh* _mesh;
+    VertexBufferHandle _instanceBuffer;
+    unsigned int _instanceBufferCapacity;
+    MeshBatch* _batch;
+    unsigned char* _vertices;
+    unsigned short* _indices;
+    unsigned char* _transformedVertices;
+    unsigned int _vertexCount;
+    unsigned int _indexCount;
+    unsigned int _chunkInstances;
+};
+
+}
+
+#endif
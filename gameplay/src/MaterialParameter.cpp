@@ -6,7 +6,8 @@ namespace gameplay
 {
 
 MaterialParameter::MaterialParameter(const char* name) :
-    _type(MaterialParameter::NONE), _count(1), _dynamic(false), _name(name ? name : ""), _uniform(NULL)
+    _type(MaterialParameter::NONE), _count(1), _dynamic(false), _name(name ? name : ""),
+    _id(UINT_MAX), _uniform(NULL), _uniformEffectSerial(0)
 {
     clearValue();
 }
@@ -68,6 +69,17 @@ const char* MaterialParameter::getName() const
     return _name.c_str();
 }
 
+unsigned int MaterialParameter::getId() const
+{
+    // Only names declared by a loaded effect have an identifier, so resolve it
+    // lazily rather than interning arbitrary parameter names.
+    if (_id == UINT_MAX)
+    {
+        Effect::findUniformId(_name.c_str(), &_id);
+    }
+    return _id;
+}
+
 void MaterialParameter::setValue(float value)
 {
     clearValue();
@@ -235,20 +247,27 @@ void MaterialParameter::bind(Effect* effect)
 {
     GP_ASSERT(effect);
 
-    // If we had a Uniform cached that is not from the passed in effect,
+    // If our cached Uniform was not resolved against the passed in effect,
     // we need to update our uniform to point to the new effect's uniform.
-    if (!_uniform || _uniform->getEffect() != effect)
+    // Effects are compared by serial number since a destroyed effect's
+    // address may be reused by a new one.
+    if (_uniformEffectSerial != effect->_serial)
     {
-        _uniform = effect->getUniform(_name.c_str());
+        _uniform = effect->getUniformById(getId());
+        _uniformEffectSerial = effect->_serial;
 
         if (!_uniform)
         {
-            // This parameter was not found in the specified effect, so do nothing.
             GP_WARN("Warning: Material parameter '%s' not found in effect '%s'.", _name.c_str(), effect->getId());
-            return;
         }
     }
 
+    if (!_uniform)
+    {
+        // This parameter was not found in the specified effect, so do nothing.
+        return;
+    }
+
     switch (_type)
     {
     case MaterialParameter::FLOAT:
@@ -570,6 +589,7 @@ void MaterialParameter::cloneInto(MaterialParameter* materialParameter) const
     materialParameter->_count = _count;
     materialParameter->_dynamic = _dynamic;
     materialParameter->_uniform = _uniform;
+    materialParameter->_uniformEffectSerial = _uniformEffectSerial;
     switch (_type)
     {
     case NONE:
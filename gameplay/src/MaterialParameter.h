@@ -44,6 +44,13 @@ public:
      */
     const char* getName() const;
 
+    /**
+     * Returns the identifier of this material parameter's name (see Effect::getUniformId).
+     *
+     * @return The identifier, or UINT_MAX if no loaded effect declares a uniform with this name.
+     */
+    unsigned int getId() const;
+
     /**
      * Sets the value of this parameter to a float value.
      */
@@ -310,7 +317,9 @@ private:
     unsigned int _count;
     bool _dynamic;
     std::string _name;
+    mutable unsigned int _id;
     Uniform* _uniform;
+    unsigned int _uniformEffectSerial;
 };
 
 template <class ClassType, class ParameterType>
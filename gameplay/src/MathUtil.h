@@ -10,6 +10,7 @@ class MathUtil
 {
 	friend class Matrix;
 	friend class Vector3;
+	friend class MeshSkin;
 
 private:
 
@@ -23,6 +24,8 @@ private:
 
 	inline static void multiplyMatrix(const float* m1, const float* m2, float* dst);
 
+	inline static void multiplyMatrices(const float* m1, const float* m2, unsigned int m2Stride, float* dst, unsigned int count);
+
 	inline static void negateMatrix(const float* m, float* dst);
 
 	inline static void transposeMatrix(const float* m, float* dst);
@@ -31,8 +34,13 @@ private:
 
 	inline static void transformVector4(const float* m, const float* v, float* dst);
 
+	inline static void transformVector3(const float* m, const float* v, float w, float* dst, unsigned int count);
+
 	inline static void crossVector3(const float* v1, const float* v2, float* dst);
 
+	inline static void skinVertex(const float* palette, const float* indices, const float* weights, unsigned int influenceCount,
+	                              const float* position, const float* normal, float* dstPosition, float* dstNormal);
+
 	MathUtil();
 };
 
@@ -42,6 +50,8 @@ private:
 
 #ifdef USE_NEON
 #include "MathUtilNeon.inl"
+#elif defined(USE_SSE)
+#include "MathUtilSSE.inl"
 #else
 #include "MathUtil.inl"
 #endif
@@ -109,6 +109,14 @@ inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* ds
 	memcpy(dst, product, MATRIX_SIZE);
 }
 
+inline void MathUtil::multiplyMatrices(const float* m1, const float* m2, unsigned int m2Stride, float* dst, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i, m1 += 16, m2 += m2Stride, dst += 16)
+	{
+		multiplyMatrix(m1, m2, dst);
+	}
+}
+
 inline void MathUtil::negateMatrix(const float* m, float* dst)
 {
 	dst[0]  = -m[0];
@@ -161,6 +169,26 @@ inline void MathUtil::transformVector4(const float* m, const float* v, float* ds
 	dst[3] = w;
 }
 
+inline void MathUtil::transformVector3(const float* m, const float* v, float w, float* dst, unsigned int count)
+{
+	// Hoist the translation column, which is constant for the whole array.
+	float tx = w * m[12];
+	float ty = w * m[13];
+	float tz = w * m[14];
+
+	for (unsigned int i = 0; i < count; ++i, v += 3, dst += 3)
+	{
+		// Handle case where v == dst.
+		float x = v[0] * m[0] + v[1] * m[4] + v[2] * m[8] + tx;
+		float y = v[0] * m[1] + v[1] * m[5] + v[2] * m[9] + ty;
+		float z = v[0] * m[2] + v[1] * m[6] + v[2] * m[10] + tz;
+
+		dst[0] = x;
+		dst[1] = y;
+		dst[2] = z;
+	}
+}
+
 inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
 {
 	float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
@@ -172,6 +200,39 @@ inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
 	dst[2] = z;
 }
 
+inline void MathUtil::skinVertex(const float* palette, const float* indices, const float* weights, unsigned int influenceCount,
+                                 const float* position, const float* normal, float* dstPosition, float* dstNormal)
+{
+	// Blend the 3x4 palette matrices (three rows each) of the influencing joints.
+	float r[12] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (unsigned int i = 0; i < influenceCount; ++i)
+	{
+		const float* m = palette + (unsigned int)indices[i] * 12;
+		float w = weights[i];
+		for (unsigned int j = 0; j < 12; ++j)
+		{
+			r[j] += m[j] * w;
+		}
+	}
+
+	// Handle case where position == dstPosition.
+	float x = r[0] * position[0] + r[1] * position[1] + r[2]  * position[2] + r[3];
+	float y = r[4] * position[0] + r[5] * position[1] + r[6]  * position[2] + r[7];
+	float z = r[8] * position[0] + r[9] * position[1] + r[10] * position[2] + r[11];
+	dstPosition[0] = x;
+	dstPosition[1] = y;
+	dstPosition[2] = z;
+
+	if (normal)
+	{
+		x = r[0] * normal[0] + r[1] * normal[1] + r[2]  * normal[2];
+		y = r[4] * normal[0] + r[5] * normal[1] + r[6]  * normal[2];
+		z = r[8] * normal[0] + r[9] * normal[1] + r[10] * normal[2];
+		dstNormal[0] = x;
+		dstNormal[1] = y;
+		dstNormal[2] = z;
+	}
 }
 
+}
 
@@ -123,6 +123,14 @@ inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* ds
 	);
 }
 
+inline void MathUtil::multiplyMatrices(const float* m1, const float* m2, unsigned int m2Stride, float* dst, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i, m1 += 16, m2 += m2Stride, dst += 16)
+	{
+		multiplyMatrix(m1, m2, dst);
+	}
+}
+
 inline void MathUtil::negateMatrix(const float* m, float* dst)
 {
 	asm volatile(
@@ -201,6 +209,32 @@ inline void MathUtil::transformVector4(const float* m, const float* v, float* ds
 	);
 }
 
+inline void MathUtil::transformVector3(const float* m, const float* v, float w, float* dst, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i, v += 3, dst += 3)
+	{
+		// The pointers are advanced by the loop, so no write-back addressing is used here.
+		asm volatile(
+			"vld1.32	{d0},			[%2]	\n\t"	// V[x, y]
+			"vld1.32	{d1[0]},		[%3]	\n\t"	// V[z]
+			"vld1.32	{d1[1]},		[%4]	\n\t"	// V[w]
+			"vld1.32	{d18 - d21},	[%5]	\n\t"	// M[m0-m7]
+			"vld1.32	{d22 - d25},	[%6]	\n\t"	// M[m8-m15]
+
+			"vmul.f32 q13,  q9, d0[0]			\n\t"	// DST->V = M[m0-m3] * V[x]
+			"vmla.f32 q13, q10, d0[1]      		\n\t"	// DST->V += M[m4-m7] * V[y]
+			"vmla.f32 q13, q11, d1[0]      		\n\t"	// DST->V += M[m8-m11] * V[z]
+			"vmla.f32 q13, q12, d1[1]      		\n\t"	// DST->V += M[m12-m15] * V[w]
+
+			"vst1.32 {d26}, [%0]        		\n\t"	// DST->V[x, y]
+			"vst1.32 {d27[0]}, [%1]        		\n\t"	// DST->V[z]
+			:
+			: "r"(dst), "r"(dst + 2), "r"(v), "r"(v + 2), "r"(&w), "r"(m), "r"(m + 8)
+			: "q0", "q9", "q10","q11", "q12", "q13", "memory"
+		);
+	}
+}
+
 inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
 {
 	asm volatile(
@@ -226,4 +260,50 @@ inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
 	);
 }
 
+inline void MathUtil::skinVertex(const float* palette, const float* indices, const float* weights, unsigned int influenceCount,
+                                 const float* position, const float* normal, float* dstPosition, float* dstNormal)
+{
+	// Blend the 3x4 palette matrices (three rows each) of the influencing joints.
+	float r[12] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (unsigned int i = 0; i < influenceCount; ++i)
+	{
+		const float* m = palette + (unsigned int)indices[i] * 12;
+		asm volatile(
+			"vld1.32	{d16 - d19},	[%0]	\n\t"	// R[r0-r7]
+			"vld1.32	{d20 - d21},	[%1]	\n\t"	// R[r8-r11]
+			"vld1.32	{d22 - d25},	[%2]	\n\t"	// M[m0-m7]
+			"vld1.32	{d26 - d27},	[%3]	\n\t"	// M[m8-m11]
+			"vld1.32	{d0[]},			[%4]	\n\t"	// W
+
+			"vmla.f32	q8,  q11, d0[0]			\n\t"	// R[r0-r3] += M[m0-m3] * W
+			"vmla.f32	q9,  q12, d0[0]			\n\t"	// R[r4-r7] += M[m4-m7] * W
+			"vmla.f32	q10, q13, d0[0]			\n\t"	// R[r8-r11] += M[m8-m11] * W
+
+			"vst1.32	{d16 - d19},	[%0]	\n\t"	// R[r0-r7]
+			"vst1.32	{d20 - d21},	[%1]	\n\t"	// R[r8-r11]
+			:
+			: "r"(r), "r"(r + 8), "r"(m), "r"(m + 8), "r"(&weights[i])
+			: "q0", "q8", "q9", "q10", "q11", "q12", "q13", "memory"
+		);
+	}
+
+	// Handle case where position == dstPosition.
+	float x = r[0] * position[0] + r[1] * position[1] + r[2]  * position[2] + r[3];
+	float y = r[4] * position[0] + r[5] * position[1] + r[6]  * position[2] + r[7];
+	float z = r[8] * position[0] + r[9] * position[1] + r[10] * position[2] + r[11];
+	dstPosition[0] = x;
+	dstPosition[1] = y;
+	dstPosition[2] = z;
+
+	if (normal)
+	{
+		x = r[0] * normal[0] + r[1] * normal[1] + r[2]  * normal[2];
+		y = r[4] * normal[0] + r[5] * normal[1] + r[6]  * normal[2];
+		z = r[8] * normal[0] + r[9] * normal[1] + r[10] * normal[2];
+		dstNormal[0] = x;
+		dstNormal[1] = y;
+		dstNormal[2] = z;
+	}
+}
+
 }
@@ -0,0 +1,234 @@
+#include <emmintrin.h>
+#ifdef USE_AVX
+#include <immintrin.h>
+#endif
+
+namespace gameplay
+{
+
+inline void MathUtil::addMatrix(const float* m, float scalar, float* dst)
+{
+	__m128 s = _mm_set1_ps(scalar);
+
+	_mm_storeu_ps(&dst[0],  _mm_add_ps(_mm_loadu_ps(&m[0]),  s)); // DST->M[m0-m3] = M[m0-m3] + s
+	_mm_storeu_ps(&dst[4],  _mm_add_ps(_mm_loadu_ps(&m[4]),  s)); // DST->M[m4-m7] = M[m4-m7] + s
+	_mm_storeu_ps(&dst[8],  _mm_add_ps(_mm_loadu_ps(&m[8]),  s)); // DST->M[m8-m11] = M[m8-m11] + s
+	_mm_storeu_ps(&dst[12], _mm_add_ps(_mm_loadu_ps(&m[12]), s)); // DST->M[m12-m15] = M[m12-m15] + s
+}
+
+inline void MathUtil::addMatrix(const float* m1, const float* m2, float* dst)
+{
+	_mm_storeu_ps(&dst[0],  _mm_add_ps(_mm_loadu_ps(&m1[0]),  _mm_loadu_ps(&m2[0])));
+	_mm_storeu_ps(&dst[4],  _mm_add_ps(_mm_loadu_ps(&m1[4]),  _mm_loadu_ps(&m2[4])));
+	_mm_storeu_ps(&dst[8],  _mm_add_ps(_mm_loadu_ps(&m1[8]),  _mm_loadu_ps(&m2[8])));
+	_mm_storeu_ps(&dst[12], _mm_add_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12])));
+}
+
+inline void MathUtil::subtractMatrix(const float* m1, const float* m2, float* dst)
+{
+	_mm_storeu_ps(&dst[0],  _mm_sub_ps(_mm_loadu_ps(&m1[0]),  _mm_loadu_ps(&m2[0])));
+	_mm_storeu_ps(&dst[4],  _mm_sub_ps(_mm_loadu_ps(&m1[4]),  _mm_loadu_ps(&m2[4])));
+	_mm_storeu_ps(&dst[8],  _mm_sub_ps(_mm_loadu_ps(&m1[8]),  _mm_loadu_ps(&m2[8])));
+	_mm_storeu_ps(&dst[12], _mm_sub_ps(_mm_loadu_ps(&m1[12]), _mm_loadu_ps(&m2[12])));
+}
+
+inline void MathUtil::multiplyMatrix(const float* m, float scalar, float* dst)
+{
+	__m128 s = _mm_set1_ps(scalar);
+
+	_mm_storeu_ps(&dst[0],  _mm_mul_ps(_mm_loadu_ps(&m[0]),  s));
+	_mm_storeu_ps(&dst[4],  _mm_mul_ps(_mm_loadu_ps(&m[4]),  s));
+	_mm_storeu_ps(&dst[8],  _mm_mul_ps(_mm_loadu_ps(&m[8]),  s));
+	_mm_storeu_ps(&dst[12], _mm_mul_ps(_mm_loadu_ps(&m[12]), s));
+}
+
+#ifdef USE_AVX
+
+inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+	// Each column of M1 is duplicated into both 128-bit lanes so that two
+	// destination columns are produced per instruction.
+	__m256 c0 = _mm256_broadcast_ps((const __m128*)&m1[0]);  // M1[m0-m3, m0-m3]
+	__m256 c1 = _mm256_broadcast_ps((const __m128*)&m1[4]);  // M1[m4-m7, m4-m7]
+	__m256 c2 = _mm256_broadcast_ps((const __m128*)&m1[8]);  // M1[m8-m11, m8-m11]
+	__m256 c3 = _mm256_broadcast_ps((const __m128*)&m1[12]); // M1[m12-m15, m12-m15]
+
+	__m256 b01 = _mm256_loadu_ps(&m2[0]);                    // M2[m0-m7]
+	__m256 b23 = _mm256_loadu_ps(&m2[8]);                    // M2[m8-m15]
+
+	// DST->M[m0-m7] = M1 * M2[m0-m7]
+	__m256 r01 = _mm256_mul_ps(c0, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(0, 0, 0, 0)));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(c1, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(1, 1, 1, 1))));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(c2, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(2, 2, 2, 2))));
+	r01 = _mm256_add_ps(r01, _mm256_mul_ps(c3, _mm256_shuffle_ps(b01, b01, _MM_SHUFFLE(3, 3, 3, 3))));
+
+	// DST->M[m8-m15] = M1 * M2[m8-m15]
+	__m256 r23 = _mm256_mul_ps(c0, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(0, 0, 0, 0)));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(c1, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(1, 1, 1, 1))));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(c2, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(2, 2, 2, 2))));
+	r23 = _mm256_add_ps(r23, _mm256_mul_ps(c3, _mm256_shuffle_ps(b23, b23, _MM_SHUFFLE(3, 3, 3, 3))));
+
+	// All loads are complete, so m1 or m2 may be the same array as dst.
+	_mm256_storeu_ps(&dst[0], r01);
+	_mm256_storeu_ps(&dst[8], r23);
+}
+
+#else
+
+inline void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
+{
+	__m128 c0 = _mm_loadu_ps(&m1[0]);  // M1[m0-m3]
+	__m128 c1 = _mm_loadu_ps(&m1[4]);  // M1[m4-m7]
+	__m128 c2 = _mm_loadu_ps(&m1[8]);  // M1[m8-m11]
+	__m128 c3 = _mm_loadu_ps(&m1[12]); // M1[m12-m15]
+
+	__m128 r[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		// DST->M[column i] = M1[m0-m3] * M2[4i] + M1[m4-m7] * M2[4i+1] + M1[m8-m11] * M2[4i+2] + M1[m12-m15] * M2[4i+3]
+		__m128 b = _mm_loadu_ps(&m2[i * 4]);
+		r[i] = _mm_mul_ps(c0, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 0, 0, 0)));
+		r[i] = _mm_add_ps(r[i], _mm_mul_ps(c1, _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 1, 1))));
+		r[i] = _mm_add_ps(r[i], _mm_mul_ps(c2, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 2, 2))));
+		r[i] = _mm_add_ps(r[i], _mm_mul_ps(c3, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 3, 3))));
+	}
+
+	// All loads are complete, so m1 or m2 may be the same array as dst.
+	_mm_storeu_ps(&dst[0],  r[0]);
+	_mm_storeu_ps(&dst[4],  r[1]);
+	_mm_storeu_ps(&dst[8],  r[2]);
+	_mm_storeu_ps(&dst[12], r[3]);
+}
+
+#endif
+
+inline void MathUtil::multiplyMatrices(const float* m1, const float* m2, unsigned int m2Stride, float* dst, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i, m1 += 16, m2 += m2Stride, dst += 16)
+	{
+		multiplyMatrix(m1, m2, dst);
+	}
+}
+
+inline void MathUtil::negateMatrix(const float* m, float* dst)
+{
+	__m128 sign = _mm_set1_ps(-0.0f);
+
+	_mm_storeu_ps(&dst[0],  _mm_xor_ps(_mm_loadu_ps(&m[0]),  sign));
+	_mm_storeu_ps(&dst[4],  _mm_xor_ps(_mm_loadu_ps(&m[4]),  sign));
+	_mm_storeu_ps(&dst[8],  _mm_xor_ps(_mm_loadu_ps(&m[8]),  sign));
+	_mm_storeu_ps(&dst[12], _mm_xor_ps(_mm_loadu_ps(&m[12]), sign));
+}
+
+inline void MathUtil::transposeMatrix(const float* m, float* dst)
+{
+	__m128 c0 = _mm_loadu_ps(&m[0]);
+	__m128 c1 = _mm_loadu_ps(&m[4]);
+	__m128 c2 = _mm_loadu_ps(&m[8]);
+	__m128 c3 = _mm_loadu_ps(&m[12]);
+
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+	_mm_storeu_ps(&dst[0],  c0); // DST->M[m0-m3] = M[m0, m4, m8, m12]
+	_mm_storeu_ps(&dst[4],  c1); // DST->M[m4-m7] = M[m1, m5, m9, m13]
+	_mm_storeu_ps(&dst[8],  c2); // DST->M[m8-m11] = M[m2, m6, m10, m14]
+	_mm_storeu_ps(&dst[12], c3); // DST->M[m12-m15] = M[m3, m7, m11, m15]
+}
+
+inline void MathUtil::transformVector4(const float* m, float x, float y, float z, float w, float* dst)
+{
+	__m128 r = _mm_mul_ps(_mm_loadu_ps(&m[0]), _mm_set1_ps(x));  // DST->V = M[m0-m3] * V[x]
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[4]), _mm_set1_ps(y)));  // DST->V += M[m4-m7] * V[y]
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[8]), _mm_set1_ps(z)));  // DST->V += M[m8-m11] * V[z]
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[12]), _mm_set1_ps(w))); // DST->V += M[m12-m15] * V[w]
+
+	// dst is a three component vector, so only store V[x, y, z].
+	_mm_storel_pi((__m64*)dst, r);
+	_mm_store_ss(&dst[2], _mm_movehl_ps(r, r));
+}
+
+inline void MathUtil::transformVector4(const float* m, const float* v, float* dst)
+{
+	// Handle case where v == dst.
+	__m128 vec = _mm_loadu_ps(v);
+
+	__m128 r = _mm_mul_ps(_mm_loadu_ps(&m[0]), _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(0, 0, 0, 0)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[4]), _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(1, 1, 1, 1))));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[8]), _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(2, 2, 2, 2))));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(&m[12]), _mm_shuffle_ps(vec, vec, _MM_SHUFFLE(3, 3, 3, 3))));
+
+	_mm_storeu_ps(dst, r);
+}
+
+inline void MathUtil::transformVector3(const float* m, const float* v, float w, float* dst, unsigned int count)
+{
+	// The matrix columns stay in registers for the whole array.
+	__m128 c0 = _mm_loadu_ps(&m[0]);                                    // M[m0-m3]
+	__m128 c1 = _mm_loadu_ps(&m[4]);                                    // M[m4-m7]
+	__m128 c2 = _mm_loadu_ps(&m[8]);                                    // M[m8-m11]
+	__m128 t = _mm_mul_ps(_mm_loadu_ps(&m[12]), _mm_set1_ps(w));        // M[m12-m15] * V[w]
+
+	for (unsigned int i = 0; i < count; ++i, v += 3, dst += 3)
+	{
+		// Handle case where v == dst.
+		__m128 r = _mm_add_ps(t, _mm_mul_ps(c0, _mm_set1_ps(v[0])));
+		r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(v[1])));
+		r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(v[2])));
+
+		// dst is a three component vector, so only store V[x, y, z].
+		_mm_storel_pi((__m64*)dst, r);
+		_mm_store_ss(&dst[2], _mm_movehl_ps(r, r));
+	}
+}
+
+inline void MathUtil::crossVector3(const float* v1, const float* v2, float* dst)
+{
+	// Vector3 is only three floats wide, so a 128-bit load would read past the end of
+	// the source vectors. The scalar form is as fast as any shuffle sequence here.
+	float x = (v1[1] * v2[2]) - (v1[2] * v2[1]);
+	float y = (v1[2] * v2[0]) - (v1[0] * v2[2]);
+	float z = (v1[0] * v2[1]) - (v1[1] * v2[0]);
+
+	dst[0] = x;
+	dst[1] = y;
+	dst[2] = z;
+}
+
+inline void MathUtil::skinVertex(const float* palette, const float* indices, const float* weights, unsigned int influenceCount,
+                                 const float* position, const float* normal, float* dstPosition, float* dstNormal)
+{
+	// Blend the 3x4 palette matrices (three rows each) of the influencing joints.
+	__m128 r0 = _mm_setzero_ps();
+	__m128 r1 = _mm_setzero_ps();
+	__m128 r2 = _mm_setzero_ps();
+	for (unsigned int i = 0; i < influenceCount; ++i)
+	{
+		const float* m = palette + (unsigned int)indices[i] * 12;
+		__m128 w = _mm_set1_ps(weights[i]);
+		r0 = _mm_add_ps(r0, _mm_mul_ps(_mm_loadu_ps(&m[0]), w));        // R[r0-r3] += M[m0-m3] * W
+		r1 = _mm_add_ps(r1, _mm_mul_ps(_mm_loadu_ps(&m[4]), w));        // R[r4-r7] += M[m4-m7] * W
+		r2 = _mm_add_ps(r2, _mm_mul_ps(_mm_loadu_ps(&m[8]), w));        // R[r8-r11] += M[m8-m11] * W
+	}
+
+	// Turn the rows into columns so that each vertex is transformed with multiply-adds.
+	__m128 r3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	// Handle case where position == dstPosition.
+	__m128 p = _mm_add_ps(r3, _mm_mul_ps(r0, _mm_set1_ps(position[0])));
+	p = _mm_add_ps(p, _mm_mul_ps(r1, _mm_set1_ps(position[1])));
+	p = _mm_add_ps(p, _mm_mul_ps(r2, _mm_set1_ps(position[2])));
+	_mm_storel_pi((__m64*)dstPosition, p);
+	_mm_store_ss(&dstPosition[2], _mm_movehl_ps(p, p));
+
+	if (normal)
+	{
+		__m128 n = _mm_mul_ps(r0, _mm_set1_ps(normal[0]));
+		n = _mm_add_ps(n, _mm_mul_ps(r1, _mm_set1_ps(normal[1])));
+		n = _mm_add_ps(n, _mm_mul_ps(r2, _mm_set1_ps(normal[2])));
+		_mm_storel_pi((__m64*)dstNormal, n);
+		_mm_store_ss(&dstNormal[2], _mm_movehl_ps(n, n));
+	}
+}
+
+}
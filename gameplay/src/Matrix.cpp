@@ -659,6 +659,20 @@ void Matrix::multiply(const Matrix& m1, const Matrix& m2, Matrix* dst)
 	MathUtil::multiplyMatrix(m1.m, m2.m, dst->m);
 }
 
+void Matrix::multiply(const Matrix* m1, const Matrix* m2, Matrix* dst, unsigned int count)
+{
+    GP_ASSERT(count == 0 || (m1 && m2 && dst));
+
+    MathUtil::multiplyMatrices((const float*)m1, (const float*)m2, 16, (float*)dst, count);
+}
+
+void Matrix::multiply(const Matrix* m1, const Matrix& m2, Matrix* dst, unsigned int count)
+{
+    GP_ASSERT(count == 0 || (m1 && dst));
+
+    MathUtil::multiplyMatrices((const float*)m1, m2.m, 0, (float*)dst, count);
+}
+
 void Matrix::negate()
 {
     negate(this);
@@ -827,6 +841,13 @@ void Matrix::transformPoint(const Vector3& point, Vector3* dst) const
     transformVector(point.x, point.y, point.z, 1.0f, dst);
 }
 
+void Matrix::transformPoints(const Vector3* points, Vector3* dst, unsigned int count) const
+{
+    GP_ASSERT(count == 0 || (points && dst));
+
+    MathUtil::transformVector3(m, (const float*)points, 1.0f, (float*)dst, count);
+}
+
 void Matrix::transformVector(Vector3* vector) const
 {
     GP_ASSERT(vector);
@@ -838,6 +859,13 @@ void Matrix::transformVector(const Vector3& vector, Vector3* dst) const
     transformVector(vector.x, vector.y, vector.z, 0.0f, dst);
 }
 
+void Matrix::transformVectors(const Vector3* vectors, Vector3* dst, unsigned int count) const
+{
+    GP_ASSERT(count == 0 || (vectors && dst));
+
+    MathUtil::transformVector3(m, (const float*)vectors, 0.0f, (float*)dst, count);
+}
+
 void Matrix::transformVector(float x, float y, float z, float w, Vector3* dst) const
 {
     GP_ASSERT(dst);
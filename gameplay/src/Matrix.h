@@ -490,6 +490,30 @@ public:
      */
     static void multiply(const Matrix& m1, const Matrix& m2, Matrix* dst);
 
+    /**
+     * Multiplies each matrix in m1 by the matrix at the same index in m2
+     * and stores the results in dst.
+     *
+     * This is equivalent to calling multiply(m1[i], m2[i], &dst[i]) for
+     * every index, but processes the whole array in one call.
+     *
+     * @param m1 The array of first matrices to multiply.
+     * @param m2 The array of second matrices to multiply.
+     * @param dst An array to store the results in (may be the same array as m1 or m2).
+     * @param count The number of matrices in each array.
+     */
+    static void multiply(const Matrix* m1, const Matrix* m2, Matrix* dst, unsigned int count);
+
+    /**
+     * Multiplies each matrix in m1 by m2 and stores the results in dst.
+     *
+     * @param m1 The array of first matrices to multiply.
+     * @param m2 The second matrix to multiply each matrix of m1 by.
+     * @param dst An array to store the results in (may be the same array as m1).
+     * @param count The number of matrices in m1 and dst.
+     */
+    static void multiply(const Matrix* m1, const Matrix& m2, Matrix* dst, unsigned int count);
+
     /**
      * Negates this matrix.
      */
@@ -725,6 +749,16 @@ public:
      */
     void transformPoint(const Vector3& point, Vector3* dst) const;
 
+    /**
+     * Transforms an array of points by this matrix, and stores
+     * the results in dst.
+     *
+     * @param points The array of points to transform.
+     * @param dst An array to store the transformed points in (may be the same array as points).
+     * @param count The number of points in each array.
+     */
+    void transformPoints(const Vector3* points, Vector3* dst, unsigned int count) const;
+
     /**
      * Transforms the specified vector by this matrix by
      * treating the fourth (w) coordinate as zero.
@@ -745,6 +779,16 @@ public:
      */
     void transformVector(const Vector3& vector, Vector3* dst) const;
 
+    /**
+     * Transforms an array of vectors by this matrix by treating the
+     * fourth (w) coordinate as zero, and stores the results in dst.
+     *
+     * @param vectors The array of vectors to transform.
+     * @param dst An array to store the transformed vectors in (may be the same array as vectors).
+     * @param count The number of vectors in each array.
+     */
+    void transformVectors(const Vector3* vectors, Vector3* dst, unsigned int count) const;
+
     /**
      * Transforms the specified vector by this matrix.
      *
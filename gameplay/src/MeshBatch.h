@@ -12,6 +12,9 @@ namespace gameplay
  */
 class MeshBatch
 {
+    friend class InstanceBatch;
+    friend class SpriteBatch;
+
 public:
 
     /**
@@ -135,6 +138,22 @@ private:
 
     bool resize(unsigned int capacity);
 
+    /**
+     * Adds vertices (in the batch's vertex format) and indices to the batch.
+     */
+    void addVertices(const void* vertices, unsigned int vertexCount, const unsigned short* indices, unsigned int indexCount);
+
+    /**
+     * Appends space for vertices and indices to the batch, growing it if needed, and
+     * returns where that space starts so that the caller can write into it directly.
+     *
+     * Unlike addVertices(), the indices are not offset and triangle strips are not
+     * joined: the caller writes final index values, relative to the start of the batch.
+     *
+     * @return true if the space was appended, false if the batch could not grow.
+     */
+    bool appendVertices(unsigned int vertexCount, unsigned int indexCount, void** vertices, unsigned short** indices);
+
     const VertexFormat _vertexFormat;
     Mesh::PrimitiveType _primitiveType;
     Material* _material;
@@ -1,6 +1,8 @@
 #include "Base.h"
 #include "MeshSkin.h"
 #include "Joint.h"
+#include "Model.h"
+#include "MathUtil.h"
 
 // The number of rows in each palette matrix.
 #define PALETTE_ROWS 3
@@ -9,7 +11,9 @@ namespace gameplay
 {
 
 MeshSkin::MeshSkin()
-    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _model(NULL)
+    : _rootJoint(NULL), _rootNode(NULL), _matrixPalette(NULL), _skinMatrices(NULL), _skinMatricesDirty(true),
+      _bindPoseVersions(NULL), _jointMatrices(NULL), _jointIndices(NULL), _cpuSkinVertices(NULL), _cpuSkinnedVertices(NULL), _cpuSkinVertexCount(0),
+      _cpuSkinnedVerticesDirty(false), _model(NULL)
 {
 }
 
@@ -18,6 +22,12 @@ MeshSkin::~MeshSkin()
     clearJoints();
 
     SAFE_DELETE_ARRAY(_matrixPalette);
+    SAFE_DELETE_ARRAY(_skinMatrices);
+    SAFE_DELETE_ARRAY(_bindPoseVersions);
+    SAFE_DELETE_ARRAY(_jointMatrices);
+    SAFE_DELETE_ARRAY(_jointIndices);
+    SAFE_DELETE_ARRAY(_cpuSkinVertices);
+    SAFE_DELETE_ARRAY(_cpuSkinnedVertices);
 }
 
 const Matrix& MeshSkin::getBindShape() const
@@ -28,6 +38,7 @@ const Matrix& MeshSkin::getBindShape() const
 void MeshSkin::setBindShape(const float* matrix)
 {
     _bindShape.set(matrix);
+    _skinMatricesDirty = true;
 }
 
 unsigned int MeshSkin::getJointCount() const
@@ -122,6 +133,11 @@ void MeshSkin::setJointCount(unsigned int jointCount)
 
     // Rebuild the matrix palette. Each matrix is 3 rows of Vector4.
     SAFE_DELETE_ARRAY(_matrixPalette);
+    SAFE_DELETE_ARRAY(_skinMatrices);
+    SAFE_DELETE_ARRAY(_bindPoseVersions);
+    SAFE_DELETE_ARRAY(_jointMatrices);
+    SAFE_DELETE_ARRAY(_jointIndices);
+    _skinMatricesDirty = true;
 
     if (jointCount > 0)
     {
@@ -132,6 +148,10 @@ void MeshSkin::setJointCount(unsigned int jointCount)
             _matrixPalette[i+1].set(0.0f, 1.0f, 0.0f, 0.0f);
             _matrixPalette[i+2].set(0.0f, 0.0f, 1.0f, 0.0f);
         }
+        _skinMatrices = new Matrix[jointCount];
+        _bindPoseVersions = new unsigned int[jointCount];
+        _jointMatrices = new Matrix[jointCount * 2];
+        _jointIndices = new unsigned int[jointCount];
     }
 }
 
@@ -146,6 +166,7 @@ void MeshSkin::setJoint(Joint* joint, unsigned int index)
     }
 
     _joints[index] = joint;
+    _skinMatricesDirty = true;
 
     if (joint)
     {
@@ -155,16 +176,96 @@ void MeshSkin::setJoint(Joint* joint, unsigned int index)
 }
 
 Vector4* MeshSkin::getMatrixPalette() const
+{
+    updateMatrixPalette();
+    return _matrixPalette;
+}
+
+bool MeshSkin::updateMatrixPalette() const
 {
     GP_ASSERT(_matrixPalette);
 
+    GP_ASSERT(_skinMatrices && _bindPoseVersions && _jointMatrices && _jointIndices);
+
     unsigned int count = _joints.size();
+    if (!_skinMatricesDirty)
+    {
+        // The inverse bind pose of a joint may have been set since the last rebuild.
+        for (unsigned int i = 0; i < count; i++)
+        {
+            GP_ASSERT(_joints[i]);
+            if (_joints[i]->_bindPoseVersion != _bindPoseVersions[i])
+            {
+                _skinMatricesDirty = true;
+                break;
+            }
+        }
+    }
+
+    if (_skinMatricesDirty)
+    {
+        // Combine the inverse bind poses with the bind shape once, rather than every frame.
+        for (unsigned int i = 0; i < count; i++)
+        {
+            GP_ASSERT(_joints[i]);
+            _skinMatrices[i] = _joints[i]->getInverseBindPose();
+            _bindPoseVersions[i] = _joints[i]->_bindPoseVersion;
+            _joints[i]->_jointMatrixDirty = true;
+        }
+        Matrix::multiply(_skinMatrices, _bindShape, _skinMatrices, count);
+        _skinMatricesDirty = false;
+    }
+
+    // Gather the world matrices of every joint whose palette entry is out of date,
+    // so that they can be combined with the skin matrices in one batched multiply.
+    Matrix* worldMatrices = _jointMatrices;
+    Matrix* skinMatrices = _jointMatrices + count;
+    unsigned int dirtyCount = 0;
     for (unsigned int i = 0; i < count; i++)
     {
-        GP_ASSERT(_joints[i]);
-        _joints[i]->updateJointMatrix(getBindShape(), &_matrixPalette[i * PALETTE_ROWS]);
+        Joint* joint = _joints[i];
+        GP_ASSERT(joint);
+
+        // Note: If more than one MeshSkin influences this Joint, we need to skip
+        // the _jointMatrixDirty optimization since the joint matrix may be
+        // needed multiple times a frame with different bindShape matrices.
+        if (joint->_skinCount > 1 || joint->_jointMatrixDirty)
+        {
+            joint->_jointMatrixDirty = false;
+
+            _jointIndices[dirtyCount] = i;
+            worldMatrices[dirtyCount] = joint->getWorldMatrix();
+            ++dirtyCount;
+        }
     }
-    return _matrixPalette;
+
+    if (dirtyCount == 0)
+        return false;
+
+    if (dirtyCount == count)
+    {
+        // Every joint moved (the common case for an animated skin), so the skin
+        // matrices already line up with the gathered world matrices.
+        Matrix::multiply(worldMatrices, _skinMatrices, worldMatrices, count);
+    }
+    else
+    {
+        for (unsigned int i = 0; i < dirtyCount; i++)
+        {
+            skinMatrices[i] = _skinMatrices[_jointIndices[i]];
+        }
+        Matrix::multiply(worldMatrices, skinMatrices, worldMatrices, dirtyCount);
+    }
+
+    for (unsigned int i = 0; i < dirtyCount; i++)
+    {
+        const Matrix& t = worldMatrices[i];
+        Vector4* palette = &_matrixPalette[_jointIndices[i] * PALETTE_ROWS];
+        palette[0].set(t.m[0], t.m[4], t.m[8], t.m[12]);
+        palette[1].set(t.m[1], t.m[5], t.m[9], t.m[13]);
+        palette[2].set(t.m[2], t.m[6], t.m[10], t.m[14]);
+    }
+    return true;
 }
 
 unsigned int MeshSkin::getMatrixPaletteSize() const
@@ -172,6 +273,132 @@ unsigned int MeshSkin::getMatrixPaletteSize() const
     return _joints.size() * PALETTE_ROWS;
 }
 
+void MeshSkin::setCpuSkinning(const void* vertices, unsigned int vertexCount)
+{
+    SAFE_DELETE_ARRAY(_cpuSkinVertices);
+    SAFE_DELETE_ARRAY(_cpuSkinnedVertices);
+    _cpuSkinVertexCount = 0;
+    _cpuSkinnedVerticesDirty = false;
+
+    if (vertices == NULL || vertexCount == 0)
+        return;
+
+    GP_ASSERT(_model && _model->getMesh());
+    Mesh* mesh = _model->getMesh();
+    if (vertexCount != mesh->getVertexCount())
+    {
+        GP_ERROR("CPU skinning vertex count (%u) does not match the mesh vertex count (%u).", vertexCount, mesh->getVertexCount());
+        return;
+    }
+    const VertexFormat& vertexFormat = mesh->getVertexFormat();
+    for (unsigned int i = 0, count = vertexFormat.getElementCount(); i < count; ++i)
+    {
+        if (vertexFormat.getElement(i).type != VertexFormat::FLOAT)
+        {
+            GP_ERROR("CPU skinning requires a vertex format with only float elements.");
+            return;
+        }
+    }
+
+    unsigned int size = vertexCount * mesh->getVertexSize();
+    _cpuSkinVertices = new unsigned char[size];
+    memcpy(_cpuSkinVertices, vertices, size);
+    _cpuSkinnedVertices = new unsigned char[size];
+    memcpy(_cpuSkinnedVertices, vertices, size);
+    _cpuSkinVertexCount = vertexCount;
+    _cpuSkinnedVerticesDirty = true;
+}
+
+bool MeshSkin::isCpuSkinning() const
+{
+    return _cpuSkinVertices != NULL;
+}
+
+void MeshSkin::updateSkinnedVertices()
+{
+    GP_ASSERT(_cpuSkinVertices && _cpuSkinnedVertices);
+    GP_ASSERT(_model && _model->getMesh());
+
+    if (!updateMatrixPalette() && !_cpuSkinnedVerticesDirty)
+        return;
+
+    Mesh* mesh = _model->getMesh();
+    skinVertices(mesh->getVertexFormat(), _matrixPalette, _cpuSkinVertices, _cpuSkinnedVertices, _cpuSkinVertexCount);
+    mesh->setVertexData((float*)_cpuSkinnedVertices, 0, _cpuSkinVertexCount);
+    _cpuSkinnedVerticesDirty = false;
+}
+
+void MeshSkin::skinVertices(const VertexFormat& vertexFormat, const Vector4* matrixPalette, const void* vertices, void* dst, unsigned int vertexCount)
+{
+    GP_ASSERT(matrixPalette);
+    GP_ASSERT(vertices);
+    GP_ASSERT(dst);
+
+    // Locate the elements that take part in skinning (offsets in bytes). Other elements may
+    // be of any type, but the elements read and written here must be floats.
+    int positionOffset = -1;
+    int normalOffset = -1;
+    int indicesOffset = -1;
+    int weightsOffset = -1;
+    unsigned int influenceCount = 0;
+    unsigned int offset = 0;
+    for (unsigned int i = 0, count = vertexFormat.getElementCount(); i < count; ++i)
+    {
+        const VertexFormat::Element& e = vertexFormat.getElement(i);
+        if (e.type != VertexFormat::FLOAT)
+        {
+            if (e.usage == VertexFormat::POSITION || e.usage == VertexFormat::NORMAL ||
+                e.usage == VertexFormat::BLENDINDICES || e.usage == VertexFormat::BLENDWEIGHTS)
+            {
+                GP_ERROR("Skinning requires float position, normal, blend index and blend weight elements.");
+                return;
+            }
+            offset += e.getByteSize();
+            continue;
+        }
+
+        switch (e.usage)
+        {
+        case VertexFormat::POSITION:
+            if (e.size >= 3)
+                positionOffset = offset;
+            break;
+        case VertexFormat::NORMAL:
+            if (e.size == 3)
+                normalOffset = offset;
+            break;
+        case VertexFormat::BLENDINDICES:
+            indicesOffset = offset;
+            influenceCount = e.size;
+            break;
+        case VertexFormat::BLENDWEIGHTS:
+            weightsOffset = offset;
+            influenceCount = std::min(influenceCount ? influenceCount : e.size, e.size);
+            break;
+        default:
+            break;
+        }
+        offset += e.getByteSize();
+    }
+
+    if (positionOffset < 0 || indicesOffset < 0 || weightsOffset < 0)
+    {
+        GP_ERROR("Vertex format must contain position, blend index and blend weight elements for skinning.");
+        return;
+    }
+
+    const float* palette = (const float*)matrixPalette;
+    unsigned int stride = vertexFormat.getVertexSize();
+    const unsigned char* v = (const unsigned char*)vertices;
+    unsigned char* d = (unsigned char*)dst;
+    for (unsigned int i = 0; i < vertexCount; ++i, v += stride, d += stride)
+    {
+        MathUtil::skinVertex(palette, (const float*)(v + indicesOffset), (const float*)(v + weightsOffset), influenceCount,
+                             (const float*)(v + positionOffset), normalOffset < 0 ? NULL : (const float*)(v + normalOffset),
+                             (float*)(d + positionOffset), normalOffset < 0 ? NULL : (float*)(d + normalOffset));
+    }
+}
+
 Model* MeshSkin::getModel() const
 {
     return _model;
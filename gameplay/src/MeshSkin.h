@@ -3,6 +3,7 @@
 
 #include "Matrix.h"
 #include "Transform.h"
+#include "VertexFormat.h"
 
 namespace gameplay
 {
@@ -21,6 +22,7 @@ class MeshSkin : public Transform::Listener
     friend class Model;
     friend class Joint;
     friend class Node;
+    friend class RenderQueue;
 
 public:
 
@@ -100,6 +102,49 @@ public:
      */
     unsigned int getMatrixPaletteSize() const;
 
+    /**
+     * Enables or disables skinning on the CPU.
+     *
+     * When enabled, the vertex positions and normals of the skin's mesh are deformed
+     * by the matrix palette on the CPU whenever the model is drawn and the joints have
+     * moved, and streamed into the mesh's vertex buffer. The model's materials must then
+     * be created without the SKINNING define, which also lifts the limit on the number
+     * of joints imposed by the size of the shader's matrix palette uniform.
+     *
+     * Since the deformed vertices are written to the mesh, the mesh should be dynamic and
+     * must not be shared with other models. CPU skinning is not copied when the skin is cloned.
+     *
+     * @param vertices The bind pose vertices of the mesh, in the mesh's vertex format,
+     *      or NULL to go back to skinning on the GPU. The data is copied. The vertex
+     *      format must only contain float elements.
+     * @param vertexCount The number of vertices (must match the mesh).
+     */
+    void setCpuSkinning(const void* vertices, unsigned int vertexCount);
+
+    /**
+     * Determines whether this skin is deformed on the CPU.
+     *
+     * @return true if CPU skinning is enabled, false otherwise.
+     * @see setCpuSkinning
+     */
+    bool isCpuSkinning() const;
+
+    /**
+     * Deforms vertex positions and normals by a matrix palette.
+     *
+     * The vertex format must contain a POSITION element and BLENDINDICES and BLENDWEIGHTS
+     * elements of the same size; a NORMAL element of size 3 is deformed too. These elements
+     * must be floats, the other elements may be of any type. Only the positions and normals
+     * of dst are written, all other elements are left untouched.
+     *
+     * @param vertexFormat The format of the vertices.
+     * @param matrixPalette The matrix palette, as returned by getMatrixPalette().
+     * @param vertices The bind pose vertices.
+     * @param dst The vertices to write the deformed positions and normals to (may be the same as vertices).
+     * @param vertexCount The number of vertices.
+     */
+    static void skinVertices(const VertexFormat& vertexFormat, const Vector4* matrixPalette, const void* vertices, void* dst, unsigned int vertexCount);
+
     /**
      * Returns our parent Model.
      */
@@ -169,6 +214,18 @@ private:
      */
     void clearJoints();
 
+    /**
+     * Brings the matrix palette up to date with the joints.
+     *
+     * @return true if any palette entry was recomputed.
+     */
+    bool updateMatrixPalette() const;
+
+    /**
+     * Deforms the mesh on the CPU if the joints have moved since the last call.
+     */
+    void updateSkinnedVertices();
+
     Matrix _bindShape;
     std::vector<Joint*> _joints;
     Joint* _rootJoint;
@@ -183,6 +240,26 @@ private:
     // Each 4x3 row-wise matrix is represented as 3 Vector4's.
     // The number of Vector4's is (_joints.size() * 3).
     Vector4* _matrixPalette;
+
+    // The inverse bind pose of each joint premultiplied onto the bind shape, stored
+    // contiguously so that the palette only needs one batched multiply per frame.
+    // Rebuilt when the joints, their inverse bind poses or the bind shape change.
+    Matrix* _skinMatrices;
+    mutable bool _skinMatricesDirty;
+
+    // The bind pose version of each joint when the skin matrices were last rebuilt.
+    unsigned int* _bindPoseVersions;
+
+    // Scratch storage used to batch the joint matrix products in getMatrixPalette().
+    // Holds (_joints.size() * 2) matrices and _joints.size() joint indices.
+    Matrix* _jointMatrices;
+    unsigned int* _jointIndices;
+
+    // Bind pose and deformed vertices when skinning on the CPU (NULL otherwise).
+    unsigned char* _cpuSkinVertices;
+    unsigned char* _cpuSkinnedVertices;
+    unsigned int _cpuSkinVertexCount;
+    bool _cpuSkinnedVerticesDirty;
     Model* _model;
 };
 
@@ -257,6 +257,11 @@ void Model::draw(bool wireframe)
 {
     GP_ASSERT(_mesh);
 
+    if (_skin && _skin->isCpuSkinning())
+    {
+        _skin->updateSkinnedVertices();
+    }
+
     unsigned int partCount = _mesh->getPartCount();
     if (partCount == 0)
     {
@@ -271,19 +276,7 @@ void Model::draw(bool wireframe)
                 Pass* pass = technique->getPassByIndex(i);
                 GP_ASSERT(pass);
                 pass->bind();
-                GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
-                if (wireframe && (_mesh->getPrimitiveType() == Mesh::TRIANGLES || _mesh->getPrimitiveType() == Mesh::TRIANGLE_STRIP))
-                {
-                    unsigned int vertexCount = _mesh->getVertexCount();
-                    for (unsigned int j = 0; j < vertexCount; j += 3)
-                    {
-                        GL_ASSERT( glDrawArrays(GL_LINE_LOOP, j, 3) );
-                    }
-                }
-                else
-                {
-                    GL_ASSERT( glDrawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount()) );
-                }
+                drawPart(NULL, wireframe);
                 pass->unbind();
             }
         }
@@ -307,36 +300,7 @@ void Model::draw(bool wireframe)
                     Pass* pass = technique->getPassByIndex(j);
                     GP_ASSERT(pass);
                     pass->bind();
-                    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->_indexBuffer) );
-                    if (wireframe && (_mesh->getPrimitiveType() == Mesh::TRIANGLES || _mesh->getPrimitiveType() == Mesh::TRIANGLE_STRIP))
-                    {
-                        unsigned int indexCount = part->getIndexCount();
-                        unsigned int indexSize = 0;
-                        switch (part->getIndexFormat())
-                        {
-                        case Mesh::INDEX8:
-                            indexSize = 1;
-                            break;
-                        case Mesh::INDEX16:
-                            indexSize = 2;
-                            break;
-                        case Mesh::INDEX32:
-                            indexSize = 4;
-                            break;
-                        default:
-                            GP_ERROR("Unsupported index format (%d).", part->getIndexFormat());
-                            continue;
-                        }
-
-                        for (unsigned int k = 0; k < indexCount; k += 3)
-                        {
-                            GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)(k*indexSize))) );
-                        }
-                    }
-                    else
-                    {
-                        GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
-                    }
+                    drawPart(part, wireframe);
                     pass->unbind();
                 }
             }
@@ -344,6 +308,62 @@ void Model::draw(bool wireframe)
     }
 }
 
+void Model::drawPart(MeshPart* part, bool wireframe)
+{
+    GP_ASSERT(_mesh);
+
+    bool triangles = _mesh->getPrimitiveType() == Mesh::TRIANGLES || _mesh->getPrimitiveType() == Mesh::TRIANGLE_STRIP;
+    if (part == NULL)
+    {
+        // No mesh parts (index buffers).
+        GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+        if (wireframe && triangles)
+        {
+            unsigned int vertexCount = _mesh->getVertexCount();
+            for (unsigned int j = 0; j < vertexCount; j += 3)
+            {
+                GL_ASSERT( glDrawArrays(GL_LINE_LOOP, j, 3) );
+            }
+        }
+        else
+        {
+            GL_ASSERT( glDrawArrays(_mesh->getPrimitiveType(), 0, _mesh->getVertexCount()) );
+        }
+        return;
+    }
+
+    GL_ASSERT( glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part->_indexBuffer) );
+    if (wireframe && triangles)
+    {
+        unsigned int indexCount = part->getIndexCount();
+        unsigned int indexSize = 0;
+        switch (part->getIndexFormat())
+        {
+        case Mesh::INDEX8:
+            indexSize = 1;
+            break;
+        case Mesh::INDEX16:
+            indexSize = 2;
+            break;
+        case Mesh::INDEX32:
+            indexSize = 4;
+            break;
+        default:
+            GP_ERROR("Unsupported index format (%d).", part->getIndexFormat());
+            return;
+        }
+
+        for (unsigned int k = 0; k < indexCount; k += 3)
+        {
+            GL_ASSERT( glDrawElements(GL_LINE_LOOP, 3, part->getIndexFormat(), ((const GLvoid*)(k*indexSize))) );
+        }
+    }
+    else
+    {
+        GL_ASSERT( glDrawElements(part->getPrimitiveType(), part->getIndexCount(), part->getIndexFormat(), 0) );
+    }
+}
+
 void Model::validatePartCount()
 {
     GP_ASSERT(_mesh);
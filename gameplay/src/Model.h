@@ -22,6 +22,7 @@ class Model : public Ref
     friend class Node;
     friend class Mesh;
     friend class Bundle;
+    friend class RenderQueue;
 
 public:
 
@@ -182,6 +183,12 @@ private:
      */
     void setMaterialNodeBinding(Material *m);
 
+    /**
+     * Issues the draw call for the given mesh part, or for the whole mesh if part
+     * is NULL. The pass used to draw it must already be bound.
+     */
+    void drawPart(MeshPart* part, bool wireframe);
+
     void validatePartCount();
 
     /**
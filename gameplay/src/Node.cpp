@@ -13,6 +13,12 @@
 #define NODE_DIRTY_BOUNDS 2
 #define NODE_DIRTY_ALL (NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS)
 
+// Node view cache flags
+#define NODE_CACHE_WORLD_VIEW 1
+#define NODE_CACHE_WORLD_VIEW_PROJ 2
+#define NODE_CACHE_INV_TRANS_WORLD 4
+#define NODE_CACHE_INV_TRANS_WORLD_VIEW 8
+
 // Node property flags
 #define NODE_FLAG_VISIBLE 1
 #define NODE_FLAG_TRANSPARENT 2
@@ -24,7 +30,8 @@ namespace gameplay
 Node::Node(const char* id)
     : _scene(NULL), _firstChild(NULL), _nextSibling(NULL), _prevSibling(NULL), _parent(NULL), _childCount(0),
     _nodeFlags(NODE_FLAG_VISIBLE), _camera(NULL), _light(NULL), _model(NULL), _form(NULL), _audioSource(NULL), _particleEmitter(NULL),
-    _collisionObject(NULL), _agent(NULL), _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _userData(NULL)
+    _collisionObject(NULL), _agent(NULL), _dirtyBits(NODE_DIRTY_ALL), _notifyHierarchyChanged(true), _userData(NULL),
+    _viewCache(NULL), _spatialProxy(BoundingVolumeTree::NULL_PROXY), _spatialProxyDirty(false)
 {
     if (id)
     {
@@ -63,6 +70,8 @@ Node::~Node()
             _userData->cleanupCallback(_userData->pointer);
         SAFE_DELETE(_userData);
     }
+
+    SAFE_DELETE(_viewCache);
 }
 
 Node* Node::create(const char* id)
@@ -126,6 +135,13 @@ void Node::addChild(Node* child)
 
     ++_childCount;
 
+    // Index the child and its descendants if we are part of a scene.
+    Scene* scene = getScene();
+    if (scene)
+    {
+        scene->addToSpatialIndex(child);
+    }
+
     if (_notifyHierarchyChanged)
     {
         hierarchyChanged();
@@ -161,6 +177,13 @@ void Node::removeAllChildren()
 
 void Node::remove()
 {
+    // We and our descendants are leaving the scene, so drop out of its spatial index.
+    Scene* scene = getScene();
+    if (scene)
+    {
+        scene->removeFromSpatialIndex(this);
+    }
+
     // Re-link our neighbours.
     if (_prevSibling)
     {
@@ -414,31 +437,66 @@ const Matrix& Node::getWorldMatrix() const
     return _world;
 }
 
-const Matrix& Node::getWorldViewMatrix() const
+Node::ViewCache* Node::getViewCache() const
 {
-    static Matrix worldView;
+    if (_viewCache == NULL)
+    {
+        _viewCache = new ViewCache();
+    }
+
+    // Matrices combined with the view are only valid for the camera (and the
+    // state of that camera) they were computed with.
+    Scene* scene = getScene();
+    const Camera* camera = scene ? scene->getActiveCamera() : NULL;
+    unsigned int cameraStamp = camera ? camera->_stamp : 0;
+    if (_viewCache->camera != camera || _viewCache->cameraStamp != cameraStamp)
+    {
+        _viewCache->camera = camera;
+        _viewCache->cameraStamp = cameraStamp;
+        _viewCache->validBits &= NODE_CACHE_INV_TRANS_WORLD;
+    }
 
-    Matrix::multiply(getViewMatrix(), getWorldMatrix(), &worldView);
+    return _viewCache;
+}
 
-    return worldView;
+const Matrix& Node::getWorldViewMatrix() const
+{
+    ViewCache* cache = getViewCache();
+    if (!(cache->validBits & NODE_CACHE_WORLD_VIEW))
+    {
+        Matrix::multiply(getViewMatrix(), getWorldMatrix(), &cache->worldView);
+        cache->validBits |= NODE_CACHE_WORLD_VIEW;
+    }
+
+    return cache->worldView;
 }
 
 const Matrix& Node::getInverseTransposeWorldViewMatrix() const
 {
-    static Matrix invTransWorldView;
-    Matrix::multiply(getViewMatrix(), getWorldMatrix(), &invTransWorldView);
-    invTransWorldView.invert();
-    invTransWorldView.transpose();
-    return invTransWorldView;
+    ViewCache* cache = getViewCache();
+    if (!(cache->validBits & NODE_CACHE_INV_TRANS_WORLD_VIEW))
+    {
+        cache->inverseTransposeWorldView = getWorldViewMatrix();
+        cache->inverseTransposeWorldView.invert();
+        cache->inverseTransposeWorldView.transpose();
+        cache->validBits |= NODE_CACHE_INV_TRANS_WORLD_VIEW;
+    }
+
+    return cache->inverseTransposeWorldView;
 }
 
 const Matrix& Node::getInverseTransposeWorldMatrix() const
 {
-    static Matrix invTransWorld;
-    invTransWorld = getWorldMatrix();
-    invTransWorld.invert();
-    invTransWorld.transpose();
-    return invTransWorld;
+    ViewCache* cache = getViewCache();
+    if (!(cache->validBits & NODE_CACHE_INV_TRANS_WORLD))
+    {
+        cache->inverseTransposeWorld = getWorldMatrix();
+        cache->inverseTransposeWorld.invert();
+        cache->inverseTransposeWorld.transpose();
+        cache->validBits |= NODE_CACHE_INV_TRANS_WORLD;
+    }
+
+    return cache->inverseTransposeWorld;
 }
 
 const Matrix& Node::getViewMatrix() const
@@ -511,13 +569,16 @@ const Matrix& Node::getInverseViewProjectionMatrix() const
 
 const Matrix& Node::getWorldViewProjectionMatrix() const
 {
-    static Matrix worldViewProj;
-
-    // Always re-calculate worldViewProjection matrix since it's extremely difficult
-    // to track whether the camera has changed (it may frequently change every frame).
-    Matrix::multiply(getViewProjectionMatrix(), getWorldMatrix(), &worldViewProj);
+    // The cache is keyed by the camera's change stamp, so camera changes
+    // (which may happen every frame) are picked up without tracking them here.
+    ViewCache* cache = getViewCache();
+    if (!(cache->validBits & NODE_CACHE_WORLD_VIEW_PROJ))
+    {
+        Matrix::multiply(getViewProjectionMatrix(), getWorldMatrix(), &cache->worldViewProjection);
+        cache->validBits |= NODE_CACHE_WORLD_VIEW_PROJ;
+    }
 
-    return worldViewProj;
+    return cache->worldViewProjection;
 }
 
 Vector3 Node::getTranslationWorld() const
@@ -602,8 +663,42 @@ Vector3 Node::getActiveCameraTranslationView() const
     return Vector3::zero();
 }
 
+void Node::updateWorldMatrix(const Matrix* parentWorld) const
+{
+    if (_dirtyBits & NODE_DIRTY_WORLD)
+    {
+        _dirtyBits &= ~NODE_DIRTY_WORLD;
+
+        if (parentWorld && (!_collisionObject || _collisionObject->isKinematic()))
+        {
+            Matrix::multiply(*parentWorld, getMatrix(), &_world);
+        }
+        else
+        {
+            _world = getMatrix();
+        }
+    }
+}
+
+void Node::updateViewMatrices() const
+{
+    // Resolve every cached matrix, so none of the getters needs to write the
+    // cache afterwards. Matrices that are still valid are not recomputed.
+    getWorldViewMatrix();
+    getWorldViewProjectionMatrix();
+    getInverseTransposeWorldMatrix();
+    getInverseTransposeWorldViewMatrix();
+}
+
 void Node::hierarchyChanged()
 {
+    // The scene caches its flattened hierarchy for transform updates, so it must be rebuilt.
+    Scene* scene = getScene();
+    if (scene)
+    {
+        scene->_transformHierarchyDirty = true;
+    }
+
     // When our hierarchy changes our world transform is affected, so we must dirty it.
     transformChanged();
 }
@@ -612,6 +707,10 @@ void Node::transformChanged()
 {
     // Our local transform was changed, so mark our world matrices dirty.
     _dirtyBits |= NODE_DIRTY_WORLD | NODE_DIRTY_BOUNDS;
+    if (_viewCache)
+    {
+        _viewCache->validBits = 0;
+    }
 
     // Notify our children that their transform has also changed (since transforms are inherited).
     for (Node* n = getFirstChild(); n != NULL; n = n->getNextSibling())
@@ -631,6 +730,8 @@ void Node::transformChanged()
         }
     }
 
+    spatialBoundsChanged();
+
     Transform::transformChanged();
 }
 
@@ -638,12 +739,25 @@ void Node::setBoundsDirty()
 {
     // Mark ourself and our parent nodes as dirty
     _dirtyBits |= NODE_DIRTY_BOUNDS;
+    spatialBoundsChanged();
 
     // Mark our parent bounds as dirty as well
     if (_parent)
         _parent->setBoundsDirty();
 }
 
+void Node::spatialBoundsChanged()
+{
+    if (_spatialProxy != BoundingVolumeTree::NULL_PROXY && !_spatialProxyDirty)
+    {
+        // Only nodes that are part of a scene have a proxy.
+        Scene* scene = getScene();
+        GP_ASSERT(scene);
+        scene->_spatialDirtyProxies.push_back(_spatialProxy);
+        _spatialProxyDirty = true;
+    }
+}
+
 Animation* Node::getAnimation(const char* id) const
 {
     Animation* animation = ((AnimationTarget*)this)->getAnimation(id);
@@ -771,6 +885,13 @@ void Node::setModel(Model* model)
             _model->addRef();
             _model->setNode(this);
         }
+
+        // Only nodes with a model are kept in the scene's spatial index.
+        Scene* scene = getScene();
+        if (scene)
+        {
+            scene->updateSpatialProxy(this);
+        }
     }
 }
 
@@ -11,6 +11,7 @@
 #include "PhysicsCollisionObject.h"
 #include "PhysicsCollisionShape.h"
 #include "BoundingBox.h"
+#include "BoundingVolumeTree.h"
 #include "AIAgent.h"
 
 namespace gameplay
@@ -659,6 +660,28 @@ protected:
      */
     void setBoundsDirty();
 
+    /**
+     * Resolves the world matrix of this node, if it is dirty, from the
+     * already resolved world matrix of its parent. Unlike getWorldMatrix(),
+     * this does not visit the parent or child nodes.
+     *
+     * @param parentWorld The parent's world matrix, or NULL if this node has no parent.
+     */
+    void updateWorldMatrix(const Matrix* parentWorld) const;
+
+    /**
+     * Resolves all of the cached matrices of this node (world view, world view
+     * projection and the inverse transpose world and world view matrices) for
+     * the active camera, so that later reads of them are read-only.
+     */
+    void updateViewMatrices() const;
+
+    /**
+     * Queues this node's entry in the scene's spatial index to be refreshed
+     * from its current bounding sphere.
+     */
+    void spatialBoundsChanged();
+
 private:
 
     /**
@@ -694,6 +717,58 @@ protected:
         void (*cleanupCallback)(void*);
     };
 
+    /**
+     * Caches the combined matrices of the Node for the camera they were computed with.
+     */
+    struct ViewCache
+    {
+        /**
+         * Constructor.
+         */
+        ViewCache() : camera(NULL), cameraStamp(0), validBits(0) {}
+
+        /**
+         * The camera the cached matrices were computed with.
+         */
+        const Camera* camera;
+
+        /**
+         * The change stamp of the camera when the cached matrices were computed.
+         */
+        unsigned int cameraStamp;
+
+        /**
+         * Flags indicating which of the cached matrices are valid.
+         */
+        int validBits;
+
+        /**
+         * The cached world view matrix.
+         */
+        Matrix worldView;
+
+        /**
+         * The cached world view projection matrix.
+         */
+        Matrix worldViewProjection;
+
+        /**
+         * The cached inverse transpose world matrix.
+         */
+        Matrix inverseTransposeWorld;
+
+        /**
+         * The cached inverse transpose world view matrix.
+         */
+        Matrix inverseTransposeWorldView;
+    };
+
+    /**
+     * Returns the view cache of the Node, discarding any matrices cached
+     * for a different camera or an earlier state of the active camera.
+     */
+    ViewCache* getViewCache() const;
+
     /**
      * The Scene this node belongs to.
      */
@@ -798,6 +873,21 @@ protected:
      * Pointer to custom UserData and cleanup call back that can be stored in a Node.
      */
     UserData* _userData;
+
+    /**
+     * Combined matrices cached for the active camera (allocated on first use).
+     */
+    mutable ViewCache* _viewCache;
+
+    /**
+     * The proxy of this node in its scene's spatial index, or BoundingVolumeTree::NULL_PROXY.
+     */
+    int _spatialProxy;
+
+    /**
+     * Whether the node's spatial index proxy is queued to be refreshed.
+     */
+    bool _spatialProxyDirty;
 };
 
 /**
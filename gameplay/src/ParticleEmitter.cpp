@@ -10,11 +10,19 @@
 #define PARTICLE_EMISSION_RATE                   10
 #define PARTICLE_EMISSION_RATE_TIME_INTERVAL     1000.0f / (float)PARTICLE_EMISSION_RATE
 
+// Particle streams are padded to a multiple of this many particles (one SIMD register)
+// and aligned to its size, so the update kernels never need a scalar remainder loop.
+#define PARTICLE_STREAM_ALIGNMENT                4
+
+#ifdef USE_SSE
+#include <emmintrin.h>
+#endif
+
 namespace gameplay
 {
 
 ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountMax) :
-    _particleCountMax(particleCountMax), _particleCount(0), _particles(NULL),
+    _particleCountMax(particleCountMax), _particleCount(0), _particleData(NULL),
     _emissionRate(PARTICLE_EMISSION_RATE), _started(false), _ellipsoid(false),
     _sizeStartMin(1.0f), _sizeStartMax(1.0f), _sizeEndMin(1.0f), _sizeEndMax(1.0f),
     _energyMin(1000L), _energyMax(1000L),
@@ -28,10 +36,21 @@ ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountM
     _spriteBatch(batch), _spriteTextureBlending(BLEND_TRANSPARENT),  _spriteTextureWidth(0), _spriteTextureHeight(0), _spriteTextureWidthRatio(0), _spriteTextureHeightRatio(0), _spriteTextureCoords(NULL),
     _spriteAnimated(false),  _spriteLooped(false), _spriteFrameCount(1), _spriteFrameRandomOffset(0),_spriteFrameDuration(0L), _spriteFrameDurationSecs(0.0f), _spritePercentPerFrame(0.0f),
     _node(NULL), _orbitPosition(false), _orbitVelocity(false), _orbitAcceleration(false),
-    _timePerEmission(PARTICLE_EMISSION_RATE_TIME_INTERVAL), _timeRunning(0)
+    _timePerEmission(PARTICLE_EMISSION_RATE_TIME_INTERVAL), _timeRunning(0), _randomState(0)
 {
     GP_ASSERT(particleCountMax);
-    _particles = new Particle[particleCountMax];
+
+    // Allocate all particle streams in one block, each one aligned and padded for SIMD.
+    unsigned int streamSize = (particleCountMax + PARTICLE_STREAM_ALIGNMENT - 1) & ~(PARTICLE_STREAM_ALIGNMENT - 1);
+    _particleData = new float[PARTICLE_STREAM_COUNT * streamSize + PARTICLE_STREAM_ALIGNMENT];
+    memset(_particleData, 0, (PARTICLE_STREAM_COUNT * streamSize + PARTICLE_STREAM_ALIGNMENT) * sizeof(float));
+    float* stream = _particleData + ((PARTICLE_STREAM_ALIGNMENT - ((size_t)_particleData / sizeof(float)) % PARTICLE_STREAM_ALIGNMENT) % PARTICLE_STREAM_ALIGNMENT);
+    for (unsigned int i = 0; i < PARTICLE_STREAM_COUNT; ++i, stream += streamSize)
+    {
+        _particleStreams[i] = stream;
+    }
+
+    setRandomSeed((unsigned int)rand());
 
     GP_ASSERT(_spriteBatch);
     GP_ASSERT(_spriteBatch->getStateBlock());
@@ -42,7 +61,7 @@ ParticleEmitter::ParticleEmitter(SpriteBatch* batch, unsigned int particleCountM
 ParticleEmitter::~ParticleEmitter()
 {
     SAFE_DELETE(_spriteBatch);
-    SAFE_DELETE_ARRAY(_particles);
+    SAFE_DELETE_ARRAY(_particleData);
     SAFE_DELETE_ARRAY(_spriteTextureCoords);
 }
 
@@ -248,11 +267,11 @@ bool ParticleEmitter::isActive() const
     if (!_node)
         return false;
 
-    GP_ASSERT(_particles);
+    const float* energy = _particleStreams[PARTICLE_ENERGY];
     bool active = false;
     for (unsigned int i = 0; i < _particleCount; i++)
     {
-        if (_particles[i]._energy > 0)
+        if (energy[i] > 0.0f)
         {
             active = true;
             break;
@@ -265,7 +284,6 @@ bool ParticleEmitter::isActive() const
 void ParticleEmitter::emitOnce(unsigned int particleCount)
 {
     GP_ASSERT(_node);
-    GP_ASSERT(_particles);
 
     // Limit particleCount so as not to go over _particleCountMax.
     if (particleCount + _particleCount > _particleCountMax)
@@ -283,64 +301,97 @@ void ParticleEmitter::emitOnce(unsigned int particleCount)
     world.m[14] = 0.0f;
 
     // Emit the new particles.
+    float** s = _particleStreams;
     for (unsigned int i = 0; i < particleCount; i++)
     {
-        Particle* p = &_particles[_particleCount];
-        p->_visible = true;
-
-        generateColor(_colorStart, _colorStartVar, &p->_colorStart);
-        generateColor(_colorEnd, _colorEndVar, &p->_colorEnd);
-        p->_color.set(p->_colorStart);
-
-        p->_energy = p->_energyStart = generateScalar(_energyMin, _energyMax);
-        p->_size = p->_sizeStart = generateScalar(_sizeStartMin, _sizeStartMax);
-        p->_sizeEnd = generateScalar(_sizeEndMin, _sizeEndMax);
-        p->_rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
-        p->_angle = generateScalar(0.0f, p->_rotationPerParticleSpeed);
-        p->_rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
+        unsigned int p = _particleCount;
+
+        Vector4 colorStart;
+        Vector4 colorEnd;
+        generateColor(_colorStart, _colorStartVar, &colorStart);
+        generateColor(_colorEnd, _colorEndVar, &colorEnd);
+        s[PARTICLE_COLOR_START_R][p] = s[PARTICLE_COLOR_R][p] = colorStart.x;
+        s[PARTICLE_COLOR_START_G][p] = s[PARTICLE_COLOR_G][p] = colorStart.y;
+        s[PARTICLE_COLOR_START_B][p] = s[PARTICLE_COLOR_B][p] = colorStart.z;
+        s[PARTICLE_COLOR_START_A][p] = s[PARTICLE_COLOR_A][p] = colorStart.w;
+        s[PARTICLE_COLOR_END_R][p] = colorEnd.x;
+        s[PARTICLE_COLOR_END_G][p] = colorEnd.y;
+        s[PARTICLE_COLOR_END_B][p] = colorEnd.z;
+        s[PARTICLE_COLOR_END_A][p] = colorEnd.w;
+
+        // Energy is kept in whole milliseconds, as it always was.
+        float energy = (float)generateScalar(_energyMin, _energyMax);
+        s[PARTICLE_ENERGY][p] = energy;
+        s[PARTICLE_ENERGY_START_INVERSE][p] = energy > 0.0f ? 1.0f / energy : 0.0f;
+        s[PARTICLE_SIZE][p] = s[PARTICLE_SIZE_START][p] = generateScalar(_sizeStartMin, _sizeStartMax);
+        s[PARTICLE_SIZE_END][p] = generateScalar(_sizeEndMin, _sizeEndMax);
+        float rotationPerParticleSpeed = generateScalar(_rotationPerParticleSpeedMin, _rotationPerParticleSpeedMax);
+        s[PARTICLE_ROTATION_PER_PARTICLE_SPEED][p] = rotationPerParticleSpeed;
+        s[PARTICLE_ANGLE][p] = generateScalar(0.0f, rotationPerParticleSpeed);
+        float rotationSpeed = generateScalar(_rotationSpeedMin, _rotationSpeedMax);
+        s[PARTICLE_ROTATION_SPEED][p] = rotationSpeed;
 
         // Only initial position can be generated within an ellipsoidal domain.
-        generateVector(_position, _positionVar, &p->_position, _ellipsoid);
-        generateVector(_velocity, _velocityVar, &p->_velocity, false);
-        generateVector(_acceleration, _accelerationVar, &p->_acceleration, false);
-        generateVector(_rotationAxis, _rotationAxisVar, &p->_rotationAxis, false);
+        Vector3 position;
+        Vector3 velocity;
+        Vector3 acceleration;
+        Vector3 rotationAxis;
+        generateVector(_position, _positionVar, &position, _ellipsoid);
+        generateVector(_velocity, _velocityVar, &velocity, false);
+        generateVector(_acceleration, _accelerationVar, &acceleration, false);
+        generateVector(_rotationAxis, _rotationAxisVar, &rotationAxis, false);
 
         // Initial position, velocity and acceleration can all be relative to the emitter's transform.
         // Rotate specified properties by the node's rotation.
         if (_orbitPosition)
         {
-            world.transformPoint(p->_position, &p->_position);
+            world.transformPoint(position, &position);
         }
 
         if (_orbitVelocity)
         {
-            world.transformPoint(p->_velocity, &p->_velocity);
+            world.transformPoint(velocity, &velocity);
         }
 
         if (_orbitAcceleration)
         {
-            world.transformPoint(p->_acceleration, &p->_acceleration);
+            world.transformPoint(acceleration, &acceleration);
         }
 
         // The rotation axis always orbits the node.
-        if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
+        if (rotationSpeed != 0.0f && !rotationAxis.isZero())
         {
-            world.transformPoint(p->_rotationAxis, &p->_rotationAxis);
+            world.transformPoint(rotationAxis, &rotationAxis);
         }
 
         // Translate position relative to the node's world space.
-        p->_position.add(translation);
+        position.add(translation);
+
+        s[PARTICLE_POSITION_X][p] = position.x;
+        s[PARTICLE_POSITION_Y][p] = position.y;
+        s[PARTICLE_POSITION_Z][p] = position.z;
+        s[PARTICLE_VELOCITY_X][p] = velocity.x;
+        s[PARTICLE_VELOCITY_Y][p] = velocity.y;
+        s[PARTICLE_VELOCITY_Z][p] = velocity.z;
+        s[PARTICLE_ACCELERATION_X][p] = acceleration.x;
+        s[PARTICLE_ACCELERATION_Y][p] = acceleration.y;
+        s[PARTICLE_ACCELERATION_Z][p] = acceleration.z;
+        s[PARTICLE_ROTATION_AXIS_X][p] = rotationAxis.x;
+        s[PARTICLE_ROTATION_AXIS_Y][p] = rotationAxis.y;
+        s[PARTICLE_ROTATION_AXIS_Z][p] = rotationAxis.z;
 
         // Initial sprite frame.
+        unsigned int* frame = (unsigned int*)s[PARTICLE_FRAME];
         if (_spriteFrameRandomOffset > 0)
         {
-            p->_frame = rand() % _spriteFrameRandomOffset;
+            frame[p] = generateRandom() % _spriteFrameRandomOffset;
         }
         else
         {
-            p->_frame = 0;
+            frame[p] = 0;
         }
-        p->_timeOnCurrentFrame = 0.0f;
+        s[PARTICLE_TIME_ON_CURRENT_FRAME][p] = 0.0f;
+        ((unsigned int*)s[PARTICLE_VISIBLE])[p] = 0xFFFFFFFF;
 
         ++_particleCount;
     }
@@ -686,26 +737,46 @@ void ParticleEmitter::setOrbit(bool orbitPosition, bool orbitVelocity, bool orbi
     _orbitAcceleration = orbitAcceleration;
 }
 
+void ParticleEmitter::setRandomSeed(unsigned int seed)
+{
+    // Xorshift never leaves the zero state, so zero is remapped.
+    _randomState = seed ? seed : 0x9E3779B9;
+}
+
+unsigned int ParticleEmitter::generateRandom()
+{
+    // Xorshift32: fast, and good enough to scatter particles.
+    unsigned int x = _randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    _randomState = x;
+    return x;
+}
+
+float ParticleEmitter::generateRandom0To1()
+{
+    // The top 24 bits fill a float mantissa exactly.
+    return (float)(generateRandom() >> 8) * (1.0f / 16777215.0f);
+}
+
+float ParticleEmitter::generateRandomMinus1To1()
+{
+    return 2.0f * generateRandom0To1() - 1.0f;
+}
+
 long ParticleEmitter::generateScalar(long min, long max)
 {
-    // Note: this is not a very good RNG, but it should be suitable for our purposes.
-    long r = 0;
-    for (unsigned int i = 0; i < sizeof(long)/sizeof(int); i++)
+    if (max <= min)
     {
-        r = r << 8; // sizeof(int) * CHAR_BITS
-        r |= rand();
+        return min;
     }
-
-    // Now we have a random long between 0 and MAX_LONG.  We need to clamp it between min and max.
-    r %= max - min;
-    r += min;
-
-    return r;
+    return min + (long)(generateRandom() % (unsigned long)(max - min));
 }
 
 float ParticleEmitter::generateScalar(float min, float max)
 {
-    return min + (max - min) * MATH_RANDOM_0_1();
+    return min + (max - min) * generateRandom0To1();
 }
 
 void ParticleEmitter::generateVectorInRect(const Vector3& base, const Vector3& variance, Vector3* dst)
@@ -714,9 +785,9 @@ void ParticleEmitter::generateVectorInRect(const Vector3& base, const Vector3& v
 
     // Scale each component of the variance vector by a random float
     // between -1 and 1, then add this to the corresponding base component.
-    dst->x = base.x + variance.x * MATH_RANDOM_MINUS1_1();
-    dst->y = base.y + variance.y * MATH_RANDOM_MINUS1_1();
-    dst->z = base.z + variance.z * MATH_RANDOM_MINUS1_1();
+    dst->x = base.x + variance.x * generateRandomMinus1To1();
+    dst->y = base.y + variance.y * generateRandomMinus1To1();
+    dst->z = base.z + variance.z * generateRandomMinus1To1();
 }
 
 void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vector3& scale, Vector3* dst)
@@ -726,9 +797,9 @@ void ParticleEmitter::generateVectorInEllipsoid(const Vector3& center, const Vec
     // Generate a point within a unit cube, then reject if the point is not in a unit sphere.
     do
     {
-        dst->x = MATH_RANDOM_MINUS1_1();
-        dst->y = MATH_RANDOM_MINUS1_1();
-        dst->z = MATH_RANDOM_MINUS1_1();
+        dst->x = generateRandomMinus1To1();
+        dst->y = generateRandomMinus1To1();
+        dst->z = generateRandomMinus1To1();
     } while (dst->length() > 1.0f);
     
     // Scale this point by the scaling vector.
@@ -758,10 +829,10 @@ void ParticleEmitter::generateColor(const Vector4& base, const Vector4& variance
 
     // Scale each component of the variance color by a random float
     // between -1 and 1, then add this to the corresponding base component.
-    dst->x = base.x + variance.x * MATH_RANDOM_MINUS1_1();
-    dst->y = base.y + variance.y * MATH_RANDOM_MINUS1_1();
-    dst->z = base.z + variance.z * MATH_RANDOM_MINUS1_1();
-    dst->w = base.w + variance.w * MATH_RANDOM_MINUS1_1();
+    dst->x = base.x + variance.x * generateRandomMinus1To1();
+    dst->y = base.y + variance.y * generateRandomMinus1To1();
+    dst->z = base.z + variance.z * generateRandomMinus1To1();
+    dst->w = base.w + variance.w * generateRandomMinus1To1();
 }
 
 ParticleEmitter::TextureBlending ParticleEmitter::getTextureBlendingFromString(const char* str)
@@ -819,97 +890,260 @@ void ParticleEmitter::update(float elapsedTime)
         }
     }
 
+    if (_particleCount == 0)
+    {
+        return;
+    }
+
+    // Remove the particles that died, then simulate the survivors one attribute at a time.
+    updateEnergy(elapsedTime);
+    updateRotation(elapsedSecs);
+
+    // The kernels below run over whole SIMD groups; the padding lanes past _particleCount
+    // belong to the same allocation and their results are never read.
+    unsigned int count = (_particleCount + PARTICLE_STREAM_ALIGNMENT - 1) & ~(PARTICLE_STREAM_ALIGNMENT - 1);
+    float** s = _particleStreams;
+
     GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera());
     const Frustum& frustum = _node->getScene()->getActiveCamera()->getFrustum();
+    const Plane* planes[6] = { &frustum.getNear(), &frustum.getFar(), &frustum.getLeft(), &frustum.getRight(), &frustum.getTop(), &frustum.getBottom() };
 
-    // Now update all currently living particles.
-    GP_ASSERT(_particles);
-    for (unsigned int particlesIndex = 0; particlesIndex < _particleCount; ++particlesIndex)
+#ifdef USE_SSE
+    const __m128 dt = _mm_set1_ps(elapsedSecs);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    for (unsigned int i = 0; i < count; i += PARTICLE_STREAM_ALIGNMENT)
     {
-        Particle* p = &_particles[particlesIndex];
-        p->_energy -= elapsedTime;
+        // Integrate velocity, position and angle.
+        __m128 vx = _mm_add_ps(_mm_load_ps(s[PARTICLE_VELOCITY_X] + i), _mm_mul_ps(_mm_load_ps(s[PARTICLE_ACCELERATION_X] + i), dt));
+        __m128 vy = _mm_add_ps(_mm_load_ps(s[PARTICLE_VELOCITY_Y] + i), _mm_mul_ps(_mm_load_ps(s[PARTICLE_ACCELERATION_Y] + i), dt));
+        __m128 vz = _mm_add_ps(_mm_load_ps(s[PARTICLE_VELOCITY_Z] + i), _mm_mul_ps(_mm_load_ps(s[PARTICLE_ACCELERATION_Z] + i), dt));
+        _mm_store_ps(s[PARTICLE_VELOCITY_X] + i, vx);
+        _mm_store_ps(s[PARTICLE_VELOCITY_Y] + i, vy);
+        _mm_store_ps(s[PARTICLE_VELOCITY_Z] + i, vz);
+        __m128 px = _mm_add_ps(_mm_load_ps(s[PARTICLE_POSITION_X] + i), _mm_mul_ps(vx, dt));
+        __m128 py = _mm_add_ps(_mm_load_ps(s[PARTICLE_POSITION_Y] + i), _mm_mul_ps(vy, dt));
+        __m128 pz = _mm_add_ps(_mm_load_ps(s[PARTICLE_POSITION_Z] + i), _mm_mul_ps(vz, dt));
+        _mm_store_ps(s[PARTICLE_POSITION_X] + i, px);
+        _mm_store_ps(s[PARTICLE_POSITION_Y] + i, py);
+        _mm_store_ps(s[PARTICLE_POSITION_Z] + i, pz);
+        _mm_store_ps(s[PARTICLE_ANGLE] + i, _mm_add_ps(_mm_load_ps(s[PARTICLE_ANGLE] + i), _mm_mul_ps(_mm_load_ps(s[PARTICLE_ROTATION_PER_PARTICLE_SPEED] + i), dt)));
+
+        // Simple linear interpolation of color and size.
+        __m128 percent = _mm_sub_ps(one, _mm_mul_ps(_mm_load_ps(s[PARTICLE_ENERGY] + i), _mm_load_ps(s[PARTICLE_ENERGY_START_INVERSE] + i)));
+        for (unsigned int c = 0; c < 4; ++c)
+        {
+            __m128 start = _mm_load_ps(s[PARTICLE_COLOR_START_R + c] + i);
+            __m128 end = _mm_load_ps(s[PARTICLE_COLOR_END_R + c] + i);
+            _mm_store_ps(s[PARTICLE_COLOR_R + c] + i, _mm_add_ps(start, _mm_mul_ps(_mm_sub_ps(end, start), percent)));
+        }
+        __m128 sizeStart = _mm_load_ps(s[PARTICLE_SIZE_START] + i);
+        __m128 sizeEnd = _mm_load_ps(s[PARTICLE_SIZE_END] + i);
+        _mm_store_ps(s[PARTICLE_SIZE] + i, _mm_add_ps(sizeStart, _mm_mul_ps(_mm_sub_ps(sizeEnd, sizeStart), percent)));
 
-        if (p->_energy > 0L)
+        // Cull against the frustum; a particle is visible when it is in front of all six planes.
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (unsigned int j = 0; j < 6; ++j)
         {
-            if (p->_rotationSpeed != 0.0f && !p->_rotationAxis.isZero())
-            {
-                Matrix::createRotation(p->_rotationAxis, p->_rotationSpeed * elapsedSecs, &_rotation);
+            const Vector3& n = planes[j]->getNormal();
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(n.x)), _mm_mul_ps(py, _mm_set1_ps(n.y))),
+                                  _mm_add_ps(_mm_mul_ps(pz, _mm_set1_ps(n.z)), _mm_set1_ps(planes[j]->getDistance())));
+            visible = _mm_and_ps(visible, _mm_cmpgt_ps(d, zero));
+        }
+        _mm_store_ps(s[PARTICLE_VISIBLE] + i, visible);
+    }
+#else
+    // Plain loops over the streams, which compilers vectorize where the target allows.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        s[PARTICLE_VELOCITY_X][i] += s[PARTICLE_ACCELERATION_X][i] * elapsedSecs;
+        s[PARTICLE_VELOCITY_Y][i] += s[PARTICLE_ACCELERATION_Y][i] * elapsedSecs;
+        s[PARTICLE_VELOCITY_Z][i] += s[PARTICLE_ACCELERATION_Z][i] * elapsedSecs;
+        s[PARTICLE_POSITION_X][i] += s[PARTICLE_VELOCITY_X][i] * elapsedSecs;
+        s[PARTICLE_POSITION_Y][i] += s[PARTICLE_VELOCITY_Y][i] * elapsedSecs;
+        s[PARTICLE_POSITION_Z][i] += s[PARTICLE_VELOCITY_Z][i] * elapsedSecs;
+        s[PARTICLE_ANGLE][i] += s[PARTICLE_ROTATION_PER_PARTICLE_SPEED][i] * elapsedSecs;
+    }
 
-                _rotation.transformPoint(p->_velocity, &p->_velocity);
-                _rotation.transformPoint(p->_acceleration, &p->_acceleration);
-            }
+    // Simple linear interpolation of color and size.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        float percent = 1.0f - s[PARTICLE_ENERGY][i] * s[PARTICLE_ENERGY_START_INVERSE][i];
+        s[PARTICLE_COLOR_R][i] = s[PARTICLE_COLOR_START_R][i] + (s[PARTICLE_COLOR_END_R][i] - s[PARTICLE_COLOR_START_R][i]) * percent;
+        s[PARTICLE_COLOR_G][i] = s[PARTICLE_COLOR_START_G][i] + (s[PARTICLE_COLOR_END_G][i] - s[PARTICLE_COLOR_START_G][i]) * percent;
+        s[PARTICLE_COLOR_B][i] = s[PARTICLE_COLOR_START_B][i] + (s[PARTICLE_COLOR_END_B][i] - s[PARTICLE_COLOR_START_B][i]) * percent;
+        s[PARTICLE_COLOR_A][i] = s[PARTICLE_COLOR_START_A][i] + (s[PARTICLE_COLOR_END_A][i] - s[PARTICLE_COLOR_START_A][i]) * percent;
+        s[PARTICLE_SIZE][i] = s[PARTICLE_SIZE_START][i] + (s[PARTICLE_SIZE_END][i] - s[PARTICLE_SIZE_START][i]) * percent;
+    }
 
-            // Particle is still alive.
-            p->_velocity.x += p->_acceleration.x * elapsedSecs;
-            p->_velocity.y += p->_acceleration.y * elapsedSecs;
-            p->_velocity.z += p->_acceleration.z * elapsedSecs;
+    // Cull against the frustum; a particle is visible when it is in front of all six planes.
+    unsigned int* visible = (unsigned int*)s[PARTICLE_VISIBLE];
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        visible[i] = 0xFFFFFFFF;
+    }
+    for (unsigned int j = 0; j < 6; ++j)
+    {
+        const Vector3& n = planes[j]->getNormal();
+        float d = planes[j]->getDistance();
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            float distance = n.x * s[PARTICLE_POSITION_X][i] + n.y * s[PARTICLE_POSITION_Y][i] + n.z * s[PARTICLE_POSITION_Z][i] + d;
+            visible[i] &= distance > 0.0f ? 0xFFFFFFFF : 0;
+        }
+    }
+#endif
 
-            p->_position.x += p->_velocity.x * elapsedSecs;
-            p->_position.y += p->_velocity.y * elapsedSecs;
-            p->_position.z += p->_velocity.z * elapsedSecs;
+    // Handle sprite animations.
+    if (_spriteAnimated)
+    {
+        updateSpriteFrames(elapsedSecs);
+    }
+}
 
-            if (!frustum.intersects(p->_position))
-            {
-                p->_visible = false;
-                continue;
-            }
+unsigned int ParticleEmitter::generateQuads(unsigned int count, const unsigned int* visible,
+                                            const float* x, const float* y, const float* z, const float* size, const float* angle,
+                                            const float* const color[4], const unsigned int* frame, const float* frameCoords,
+                                            const Vector3& right, const Vector3& up, float* dst)
+{
+    GP_ASSERT(count == 0 || (visible && x && y && z && size && angle && color && frame && frameCoords && dst));
 
-            p->_angle += p->_rotationPerParticleSpeed * elapsedSecs;
+    unsigned int quadCount = 0;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (!visible[i])
+            continue;
+
+        // Rotating the quad about its center is the same as rotating its half extents
+        // within the camera plane, so only two vectors need rotating.
+        float halfSize = size[i] * 0.5f;
+        float c = cos(angle[i]) * halfSize;
+        float s = sin(angle[i]) * halfSize;
+        float rx = right.x * c + up.x * s;
+        float ry = right.y * c + up.y * s;
+        float rz = right.z * c + up.z * s;
+        float ux = up.x * c - right.x * s;
+        float uy = up.y * c - right.y * s;
+        float uz = up.z * c - right.z * s;
+
+        const float* uv = &frameCoords[frame[i] * 4];
+        float r = color[0][i];
+        float g = color[1][i];
+        float b = color[2][i];
+        float a = color[3][i];
+
+        dst[0] = x[i] - rx - ux; dst[1] = y[i] - ry - uy; dst[2] = z[i] - rz - uz;
+        dst[3] = uv[0]; dst[4] = uv[1];
+        dst[5] = r; dst[6] = g; dst[7] = b; dst[8] = a;
+
+        dst[9] = x[i] + rx - ux; dst[10] = y[i] + ry - uy; dst[11] = z[i] + rz - uz;
+        dst[12] = uv[2]; dst[13] = uv[1];
+        dst[14] = r; dst[15] = g; dst[16] = b; dst[17] = a;
+
+        dst[18] = x[i] - rx + ux; dst[19] = y[i] - ry + uy; dst[20] = z[i] - rz + uz;
+        dst[21] = uv[0]; dst[22] = uv[3];
+        dst[23] = r; dst[24] = g; dst[25] = b; dst[26] = a;
+
+        dst[27] = x[i] + rx + ux; dst[28] = y[i] + ry + uy; dst[29] = z[i] + rz + uz;
+        dst[30] = uv[2]; dst[31] = uv[3];
+        dst[32] = r; dst[33] = g; dst[34] = b; dst[35] = a;
+
+        dst += 36;
+        ++quadCount;
+    }
 
-            // Simple linear interpolation of color and size.
-            float percent = 1.0f - ((float)p->_energy / (float)p->_energyStart);
+    return quadCount;
+}
 
-            p->_color.x = p->_colorStart.x + (p->_colorEnd.x - p->_colorStart.x) * percent;
-            p->_color.y = p->_colorStart.y + (p->_colorEnd.y - p->_colorStart.y) * percent;
-            p->_color.z = p->_colorStart.z + (p->_colorEnd.z - p->_colorStart.z) * percent;
-            p->_color.w = p->_colorStart.w + (p->_colorEnd.w - p->_colorStart.w) * percent;
+void ParticleEmitter::updateEnergy(float elapsedTime)
+{
+    float** s = _particleStreams;
+    float* energy = s[PARTICLE_ENERGY];
+    unsigned int i = 0;
+    while (i < _particleCount)
+    {
+        energy[i] -= elapsedTime;
+        if (energy[i] > 0.0f)
+        {
+            ++i;
+            continue;
+        }
 
-            p->_size = p->_sizeStart + (p->_sizeEnd - p->_sizeStart) * percent;
+        // Particle is dead.  Move the particle furthest from the start of the array
+        // down to take its place, and re-use the slot at the end of the list of living particles.
+        // The moved particle has not been updated yet, so the same index is visited again.
+        unsigned int last = _particleCount - 1;
+        if (i != last)
+        {
+            for (unsigned int j = 0; j < PARTICLE_STREAM_COUNT; ++j)
+            {
+                s[j][i] = s[j][last];
+            }
+        }
+        --_particleCount;
+    }
+}
 
-            // Handle sprite animations.
-            if (_spriteAnimated)
+void ParticleEmitter::updateRotation(float elapsedSecs)
+{
+    float** s = _particleStreams;
+    for (unsigned int i = 0; i < _particleCount; ++i)
+    {
+        float rotationSpeed = s[PARTICLE_ROTATION_SPEED][i];
+        Vector3 axis(s[PARTICLE_ROTATION_AXIS_X][i], s[PARTICLE_ROTATION_AXIS_Y][i], s[PARTICLE_ROTATION_AXIS_Z][i]);
+        if (rotationSpeed == 0.0f || axis.isZero())
+            continue;
+
+        Matrix::createRotation(axis, rotationSpeed * elapsedSecs, &_rotation);
+
+        Vector3 v[2];
+        v[0].set(s[PARTICLE_VELOCITY_X][i], s[PARTICLE_VELOCITY_Y][i], s[PARTICLE_VELOCITY_Z][i]);
+        v[1].set(s[PARTICLE_ACCELERATION_X][i], s[PARTICLE_ACCELERATION_Y][i], s[PARTICLE_ACCELERATION_Z][i]);
+        _rotation.transformPoints(v, v, 2);
+        s[PARTICLE_VELOCITY_X][i] = v[0].x;
+        s[PARTICLE_VELOCITY_Y][i] = v[0].y;
+        s[PARTICLE_VELOCITY_Z][i] = v[0].z;
+        s[PARTICLE_ACCELERATION_X][i] = v[1].x;
+        s[PARTICLE_ACCELERATION_Y][i] = v[1].y;
+        s[PARTICLE_ACCELERATION_Z][i] = v[1].z;
+    }
+}
+
+void ParticleEmitter::updateSpriteFrames(float elapsedSecs)
+{
+    float** s = _particleStreams;
+    unsigned int* frame = (unsigned int*)s[PARTICLE_FRAME];
+    float* timeOnCurrentFrame = s[PARTICLE_TIME_ON_CURRENT_FRAME];
+
+    if (!_spriteLooped)
+    {
+        // The last frame should finish exactly when the particle dies.
+        for (unsigned int i = 0; i < _particleCount; ++i)
+        {
+            float percent = 1.0f - s[PARTICLE_ENERGY][i] * s[PARTICLE_ENERGY_START_INVERSE][i];
+            timeOnCurrentFrame[i] = percent - frame[i] * _spritePercentPerFrame;
+            if (frame[i] < _spriteFrameCount - 1 && timeOnCurrentFrame[i] >= _spritePercentPerFrame)
             {
-                if (!_spriteLooped)
-                {
-                    // The last frame should finish exactly when the particle dies.
-                    float percentSpent = 0.0f;
-                    for (unsigned int i = 0; i < p->_frame; i++)
-                    {
-                        percentSpent += _spritePercentPerFrame;
-                    }
-                    p->_timeOnCurrentFrame = percent - percentSpent;
-                    if (p->_frame < _spriteFrameCount - 1 &&
-                        p->_timeOnCurrentFrame >= _spritePercentPerFrame)
-                    {
-                        ++p->_frame;
-                    }
-                }
-                else
-                {
-                    // _spriteFrameDurationSecs is an absolute time measured in seconds,
-                    // and the animation repeats indefinitely.
-                    p->_timeOnCurrentFrame += elapsedSecs;
-                    if (p->_timeOnCurrentFrame >= _spriteFrameDurationSecs)
-                    {
-                        p->_timeOnCurrentFrame -= _spriteFrameDurationSecs;
-                        ++p->_frame;
-                        if (p->_frame == _spriteFrameCount)
-                        {
-                            p->_frame = 0;
-                        }
-                    }
-                }
+                ++frame[i];
             }
         }
-        else
+    }
+    else
+    {
+        // _spriteFrameDurationSecs is an absolute time measured in seconds,
+        // and the animation repeats indefinitely.
+        for (unsigned int i = 0; i < _particleCount; ++i)
         {
-            // Particle is dead.  Move the particle furthest from the start of the array
-            // down to take its place, and re-use the slot at the end of the list of living particles.
-            if (particlesIndex != _particleCount - 1)
+            timeOnCurrentFrame[i] += elapsedSecs;
+            if (timeOnCurrentFrame[i] >= _spriteFrameDurationSecs)
             {
-                _particles[particlesIndex] = _particles[_particleCount - 1];
+                timeOnCurrentFrame[i] -= _spriteFrameDurationSecs;
+                ++frame[i];
+                if (frame[i] == _spriteFrameCount)
+                {
+                    frame[i] = 0;
+                }
             }
-            --_particleCount;
         }
     }
 }
@@ -924,7 +1158,6 @@ void ParticleEmitter::draw()
     if (_particleCount > 0)
     {
         GP_ASSERT(_spriteBatch);
-        GP_ASSERT(_particles);
         GP_ASSERT(_spriteTextureCoords);
 
         // Set our node's view projection matrix to this emitter's effect.
@@ -936,9 +1169,6 @@ void ParticleEmitter::draw()
         // Begin sprite batch drawing
         _spriteBatch->start();
 
-        // 2D Rotation.
-        static const Vector2 pivot(0.5f, 0.5f);
-
         // 3D Rotation so that particles always face the camera.
         GP_ASSERT(_node && _node->getScene() && _node->getScene()->getActiveCamera() && _node->getScene()->getActiveCamera()->getNode());
         const Matrix& cameraWorldMatrix = _node->getScene()->getActiveCamera()->getNode()->getWorldMatrix();
@@ -948,16 +1178,23 @@ void ParticleEmitter::draw()
         Vector3 up;
         cameraWorldMatrix.getUpVector(&up);
 
+        // Write the quads of all visible particles straight into the batch.
+        float** s = _particleStreams;
+        const unsigned int* visible = (const unsigned int*)s[PARTICLE_VISIBLE];
+        unsigned int visibleCount = 0;
         for (unsigned int i = 0; i < _particleCount; i++)
         {
-            Particle* p = &_particles[i];
+            if (visible[i])
+                ++visibleCount;
+        }
 
-            if (p->_visible)
-            {
-                _spriteBatch->draw(p->_position, right, up, p->_size, p->_size,
-                                   _spriteTextureCoords[p->_frame * 4], _spriteTextureCoords[p->_frame * 4 + 1], _spriteTextureCoords[p->_frame * 4 + 2], _spriteTextureCoords[p->_frame * 4 + 3],
-                                   p->_color, pivot, p->_angle);
-            }
+        SpriteBatch::SpriteVertex* vertices = _spriteBatch->appendQuads(visibleCount);
+        if (vertices)
+        {
+            const float* color[4] = { s[PARTICLE_COLOR_R], s[PARTICLE_COLOR_G], s[PARTICLE_COLOR_B], s[PARTICLE_COLOR_A] };
+            generateQuads(_particleCount, visible, s[PARTICLE_POSITION_X], s[PARTICLE_POSITION_Y], s[PARTICLE_POSITION_Z],
+                          s[PARTICLE_SIZE], s[PARTICLE_ANGLE], color, (const unsigned int*)s[PARTICLE_FRAME], _spriteTextureCoords,
+                          right, up, &vertices->x);
         }
 
         // Render.
@@ -606,9 +606,23 @@ public:
      */
     void setOrbit(bool orbitPosition, bool orbitVelocity, bool orbitAcceleration);
 
+    /**
+     * Seeds the random number generator used to generate the properties of new particles.
+     *
+     * Each emitter has its own generator, so an emitter seeded with a given value emits
+     * the same particles regardless of what other emitters (or threads) do. By default
+     * the generator is seeded from rand() when the emitter is created.
+     *
+     * @param seed The seed value.
+     */
+    void setRandomSeed(unsigned int seed);
+
     /**
      * Updates the particles currently being emitted.
      *
+     * An emitter only modifies its own state while updating, so different emitters
+     * may be updated concurrently (see ParticleSystem).
+     *
      * @param elapsedTime The amount of time that has passed since the last call to update(), in milliseconds.
      */
     void update(float elapsedTime);
@@ -618,6 +632,36 @@ public:
      */
     void draw();
 
+    /**
+     * Expands particles into camera-facing quads.
+     *
+     * This is the per-particle work of draw(): each visible particle becomes four
+     * vertices of 9 floats (position, texture coordinates and color, the vertex format
+     * of SpriteBatch), ordered bottom-left, bottom-right, top-left and top-right, and
+     * rotated by the particle's angle about its center. It only reads and writes the
+     * memory passed in, so it can be run and timed without a graphics context.
+     *
+     * @param count The number of particles.
+     * @param visible For each particle, nonzero if it is visible. Invisible particles are skipped.
+     * @param x The x coordinate of each particle.
+     * @param y The y coordinate of each particle.
+     * @param z The z coordinate of each particle.
+     * @param size The size of each particle.
+     * @param angle The rotation angle of each particle, in radians.
+     * @param color The red, green, blue and alpha streams of the particle colors.
+     * @param frame The sprite frame of each particle.
+     * @param frameCoords The texture coordinates (u1, v1, u2, v2) of each sprite frame.
+     * @param right The camera's right vector.
+     * @param up The camera's up vector.
+     * @param dst The destination for the vertices; room for 4 vertices per visible particle is required.
+     *
+     * @return The number of quads written.
+     */
+    static unsigned int generateQuads(unsigned int count, const unsigned int* visible,
+                                      const float* x, const float* y, const float* z, const float* size, const float* angle,
+                                      const float* const color[4], const unsigned int* frame, const float* frameCoords,
+                                      const Vector3& right, const Vector3& up, float* dst);
+
     /**
      * Gets a TextureBlending enum from a corresponding string.
      */
@@ -650,6 +694,15 @@ private:
      */
     void setNode(Node* node);
 
+    // Returns the next value of the emitter's random number generator.
+    unsigned int generateRandom();
+
+    // Returns a random float between 0 and 1.
+    float generateRandom0To1();
+
+    // Returns a random float between -1 and 1.
+    float generateRandomMinus1To1();
+
     // Generates a scalar within the range defined by min and max.
     float generateScalar(float min, float max);
 
@@ -667,35 +720,73 @@ private:
     void generateColor(const Vector4& base, const Vector4& variance, Vector4* dst);
 
     /**
-     * Defines the data for a single particle in the system.
+     * Defines the attributes of the particles in the system.
+     *
+     * Particles are stored as a structure of arrays: each attribute (and each component
+     * of a vector attribute) is a separate stream of _particleCountMax values, so that
+     * update() processes the same attribute of several particles per SIMD instruction.
+     * All streams hold 32-bit values; PARTICLE_FRAME holds unsigned integers and
+     * PARTICLE_VISIBLE holds a mask that has all bits set for visible particles.
      */
-    class Particle
+    enum ParticleStream
     {
-
-    public:
-        Vector3 _position;
-        Vector3 _velocity;
-        Vector3 _acceleration;
-        Vector4 _colorStart;
-        Vector4 _colorEnd;
-        Vector4 _color;
-        float _rotationPerParticleSpeed;
-        Vector3 _rotationAxis;
-        float _rotationSpeed;
-        float _angle;
-        long _energyStart;
-        long _energy;
-        float _sizeStart;
-        float _sizeEnd;
-        float _size;
-        unsigned int _frame;
-        float _timeOnCurrentFrame;
-        bool _visible;
+        PARTICLE_POSITION_X,
+        PARTICLE_POSITION_Y,
+        PARTICLE_POSITION_Z,
+        PARTICLE_VELOCITY_X,
+        PARTICLE_VELOCITY_Y,
+        PARTICLE_VELOCITY_Z,
+        PARTICLE_ACCELERATION_X,
+        PARTICLE_ACCELERATION_Y,
+        PARTICLE_ACCELERATION_Z,
+        PARTICLE_COLOR_START_R,
+        PARTICLE_COLOR_START_G,
+        PARTICLE_COLOR_START_B,
+        PARTICLE_COLOR_START_A,
+        PARTICLE_COLOR_END_R,
+        PARTICLE_COLOR_END_G,
+        PARTICLE_COLOR_END_B,
+        PARTICLE_COLOR_END_A,
+        PARTICLE_COLOR_R,
+        PARTICLE_COLOR_G,
+        PARTICLE_COLOR_B,
+        PARTICLE_COLOR_A,
+        PARTICLE_ENERGY,
+        PARTICLE_ENERGY_START_INVERSE,
+        PARTICLE_SIZE_START,
+        PARTICLE_SIZE_END,
+        PARTICLE_SIZE,
+        PARTICLE_ANGLE,
+        PARTICLE_ROTATION_PER_PARTICLE_SPEED,
+        PARTICLE_ROTATION_SPEED,
+        PARTICLE_ROTATION_AXIS_X,
+        PARTICLE_ROTATION_AXIS_Y,
+        PARTICLE_ROTATION_AXIS_Z,
+        PARTICLE_TIME_ON_CURRENT_FRAME,
+        PARTICLE_FRAME,
+        PARTICLE_VISIBLE,
+        PARTICLE_STREAM_COUNT
     };
 
+    /**
+     * Decreases the energy of each particle and removes the particles that died.
+     */
+    void updateEnergy(float elapsedTime);
+
+    /**
+     * Rotates the velocity and acceleration of the particles that rotate around an axis.
+     */
+    void updateRotation(float elapsedSecs);
+
+    /**
+     * Advances the sprite animation frame of each particle.
+     */
+    void updateSpriteFrames(float elapsedSecs);
+
     unsigned int _particleCountMax;
     unsigned int _particleCount;
-    Particle* _particles;
+    float* _particleData;
+    float* _particleStreams[PARTICLE_STREAM_COUNT];
     unsigned int _emissionRate;
     bool _started;
     bool _ellipsoid;
@@ -742,6 +833,7 @@ private:
     bool _orbitAcceleration;
     float _timePerEmission;
     double _timeRunning;
+    unsigned int _randomState;
 };
 
 }
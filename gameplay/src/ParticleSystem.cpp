@@ -0,0 +1,110 @@
+#include "Base.h"
+#include "ParticleSystem.h"
+#include "Game.h"
+#include "ThreadPool.h"
+#include "Node.h"
+#include "Scene.h"
+
+namespace gameplay
+{
+
+ParticleSystem::ParticleSystem()
+    : _elapsedTime(0.0f)
+{
+}
+
+ParticleSystem::~ParticleSystem()
+{
+    for (unsigned int i = 0, count = _emitters.size(); i < count; ++i)
+    {
+        SAFE_RELEASE(_emitters[i]);
+    }
+}
+
+ParticleSystem* ParticleSystem::create()
+{
+    return new ParticleSystem();
+}
+
+void ParticleSystem::addEmitter(ParticleEmitter* emitter)
+{
+    GP_ASSERT(emitter);
+    GP_ASSERT(std::find(_emitters.begin(), _emitters.end(), emitter) == _emitters.end());
+
+    emitter->addRef();
+    _emitters.push_back(emitter);
+}
+
+void ParticleSystem::removeEmitter(ParticleEmitter* emitter)
+{
+    std::vector<ParticleEmitter*>::iterator itr = std::find(_emitters.begin(), _emitters.end(), emitter);
+    if (itr != _emitters.end())
+    {
+        _emitters.erase(itr);
+        SAFE_RELEASE(emitter);
+    }
+}
+
+unsigned int ParticleSystem::getEmitterCount() const
+{
+    return _emitters.size();
+}
+
+ParticleEmitter* ParticleSystem::getEmitter(unsigned int index) const
+{
+    GP_ASSERT(index < _emitters.size());
+    return _emitters[index];
+}
+
+void ParticleSystem::update(float elapsedTime)
+{
+    // Gather the emitters that have something to update. Node world matrices and camera
+    // frustums are computed lazily, so they are resolved here, on the calling thread,
+    // leaving the emitters nothing but reads of shared state.
+    _updateEmitters.clear();
+    for (unsigned int i = 0, count = _emitters.size(); i < count; ++i)
+    {
+        ParticleEmitter* emitter = _emitters[i];
+        if (!emitter->isActive())
+            continue;
+
+        Node* node = emitter->getNode();
+        Scene* scene = node ? node->getScene() : NULL;
+        Camera* camera = scene ? scene->getActiveCamera() : NULL;
+        if (camera == NULL)
+            continue;
+
+        node->getWorldMatrix();
+        camera->getFrustum();
+        _updateEmitters.push_back(emitter);
+    }
+
+    if (_updateEmitters.empty())
+        return;
+
+    _elapsedTime = elapsedTime;
+    ThreadPool* pool = Game::getInstance()->getThreadPool();
+    if (pool)
+        pool->parallelFor(_updateEmitters.size(), updateEmitters, this);
+    else
+        updateEmitters(0, _updateEmitters.size(), this);
+}
+
+void ParticleSystem::updateEmitters(unsigned int begin, unsigned int end, void* cookie)
+{
+    ParticleSystem* system = static_cast<ParticleSystem*>(cookie);
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        system->_updateEmitters[i]->update(system->_elapsedTime);
+    }
+}
+
+void ParticleSystem::draw()
+{
+    for (unsigned int i = 0, count = _emitters.size(); i < count; ++i)
+    {
+        _emitters[i]->draw();
+    }
+}
+
+}
@@ -0,0 +1,108 @@
+#ifndef PARTICLESYSTEM_H_
+#define PARTICLESYSTEM_H_
+
+#include "ParticleEmitter.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a set of particle emitters that are updated and drawn together.
+ *
+ * Emitters are independent of one another, so update() spreads them over the game's
+ * thread pool and returns once all of them have been updated; draw() then draws them
+ * in the order they were added. Since every emitter generates its particles from its
+ * own random number generator (see ParticleEmitter::setRandomSeed), the result does
+ * not depend on the number of threads.
+ *
+ * Emitters are updated only when they are attached to a node in a scene that has an
+ * active camera, as ParticleEmitter::update() requires.
+ */
+class ParticleSystem
+{
+public:
+
+    /**
+     * Creates a new, empty particle system.
+     *
+     * @return A new particle system.
+     */
+    static ParticleSystem* create();
+
+    /**
+     * Destructor. Releases the emitters in the system.
+     */
+    ~ParticleSystem();
+
+    /**
+     * Adds an emitter to the system. The system keeps a reference to the emitter.
+     *
+     * @param emitter The emitter to add.
+     */
+    void addEmitter(ParticleEmitter* emitter);
+
+    /**
+     * Removes an emitter from the system and releases the system's reference to it.
+     *
+     * @param emitter The emitter to remove.
+     */
+    void removeEmitter(ParticleEmitter* emitter);
+
+    /**
+     * Returns the number of emitters in the system.
+     *
+     * @return The number of emitters.
+     */
+    unsigned int getEmitterCount() const;
+
+    /**
+     * Returns the emitter at the specified index.
+     *
+     * @param index The index of the emitter.
+     *
+     * @return The emitter at the specified index.
+     */
+    ParticleEmitter* getEmitter(unsigned int index) const;
+
+    /**
+     * Updates all emitters in the system, in parallel where possible.
+     *
+     * @param elapsedTime The amount of time that has passed since the last call to update(), in milliseconds.
+     */
+    void update(float elapsedTime);
+
+    /**
+     * Draws all emitters in the system.
+     */
+    void draw();
+
+private:
+
+    /**
+     * Constructor.
+     */
+    ParticleSystem();
+
+    /**
+     * Hidden copy constructor.
+     */
+    ParticleSystem(const ParticleSystem& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    ParticleSystem& operator=(const ParticleSystem&);
+
+    /**
+     * Updates a range of the emitters gathered by update().
+     */
+    static void updateEmitters(unsigned int begin, unsigned int end, void* cookie);
+
+    std::vector<ParticleEmitter*> _emitters;
+    std::vector<ParticleEmitter*> _updateEmitters;
+    float _elapsedTime;
+};
+
+}
+
+#endif
@@ -11,6 +11,27 @@
 // The initial capacity of the Bullet debug drawer's vertex batch.
 #define INITIAL_CAPACITY 280
 
+// The default simulation step (in milliseconds) and maximum number of steps per update.
+#define PHYSICS_DEFAULT_FIXED_TIME_STEP (1000.0f / 60.0f)
+#define PHYSICS_DEFAULT_MAX_SUBSTEPS 10
+
+// The initial capacity of the collision status cache (a power of two).
+#define COLLISION_STATUS_INITIAL_CAPACITY 64
+
+// The number of ray or sweep tests per range when a batch is split between threads.
+#define PHYSICS_QUERY_BATCH_GRAIN 16
+
+// The initial size of the broadphase traversal stack of batched ray tests.
+#define PHYSICS_RAY_STACK_SIZE 128
+
+// Bullet's profiler is not thread-safe, and its convex sweep tests profile every call,
+// so batched sweeps only run in parallel when Bullet is built without it (BT_NO_PROFILE).
+#ifdef BT_NO_PROFILE
+#define PHYSICS_PARALLEL_PROFILED_CALLS 1
+#else
+#define PHYSICS_PARALLEL_PROFILED_CALLS 0
+#endif
+
 namespace gameplay
 {
 
@@ -23,17 +44,15 @@ PhysicsController::PhysicsController()
   : _isUpdating(false), _collisionConfiguration(NULL), _dispatcher(NULL),
     _overlappingPairCache(NULL), _solver(NULL), _world(NULL), _ghostPairCallback(NULL),
     _debugDrawer(NULL), _status(PhysicsController::Listener::DEACTIVATED), _listeners(NULL),
-    _gravity(btScalar(0.0), btScalar(-9.8), btScalar(0.0)), _collisionCallback(NULL)
+    _gravity(btScalar(0.0), btScalar(-9.8), btScalar(0.0)), _fixedTimeStep(PHYSICS_DEFAULT_FIXED_TIME_STEP),
+    _maxSubsteps(PHYSICS_DEFAULT_MAX_SUBSTEPS), _substepCount(0), _droppedSubstepCount(0), _threadCount(1), _threadPool(NULL)
 {
     // Default gravity is 9.8 along the negative Y axis.
-    _collisionCallback = new CollisionCallback(this);
-
     addScriptEvent("statusEvent", "[PhysicsController::Listener::EventType]");
 }
 
 PhysicsController::~PhysicsController()
 {
-    SAFE_DELETE(_collisionCallback);
     SAFE_DELETE(_ghostPairCallback);
     SAFE_DELETE(_debugDrawer);
     SAFE_DELETE(_listeners);
@@ -147,6 +166,42 @@ void PhysicsController::setGravity(const Vector3& gravity)
         _world->setGravity(BV(_gravity));
 }
 
+float PhysicsController::getFixedTimeStep() const
+{
+    return _fixedTimeStep;
+}
+
+void PhysicsController::setFixedTimeStep(float milliseconds)
+{
+    GP_ASSERT(milliseconds > 0.0f);
+    _fixedTimeStep = milliseconds;
+}
+
+unsigned int PhysicsController::getMaxSubsteps() const
+{
+    return _maxSubsteps;
+}
+
+void PhysicsController::setMaxSubsteps(unsigned int maxSubsteps)
+{
+    _maxSubsteps = maxSubsteps;
+}
+
+unsigned int PhysicsController::getSubstepCount() const
+{
+    return _substepCount;
+}
+
+unsigned int PhysicsController::getDroppedSubstepCount() const
+{
+    return _droppedSubstepCount;
+}
+
+unsigned int PhysicsController::getThreadCount() const
+{
+    return _threadCount;
+}
+
 void PhysicsController::drawDebug(const Matrix& viewProjection)
 {
     GP_ASSERT(_debugDrawer);
@@ -157,141 +212,315 @@ void PhysicsController::drawDebug(const Matrix& viewProjection)
     _debugDrawer->end();
 }
 
-bool PhysicsController::rayTest(const Ray& ray, float distance, PhysicsController::HitResult* result, PhysicsController::HitFilter* filter)
+/**
+ * Internal class used to implement ray tests, which keeps the closest hit accepted by the filter.
+ * @script{ignore}
+ */
+class RayTestCallback : public btCollisionWorld::ClosestRayResultCallback
 {
-    class RayTestCallback : public btCollisionWorld::ClosestRayResultCallback
+public:
+
+    RayTestCallback(const btVector3& rayFromWorld, const btVector3& rayToWorld, PhysicsController::HitFilter* filter)
+        : btCollisionWorld::ClosestRayResultCallback(rayFromWorld, rayToWorld), filter(filter)
     {
-    private:
+    }
 
-        HitFilter* filter;
-        HitResult hitResult;
+    /**
+     * Prepares the callback for another ray, so that batches reuse it.
+     */
+    void reset(const btVector3& rayFromWorld, const btVector3& rayToWorld)
+    {
+        m_rayFromWorld = rayFromWorld;
+        m_rayToWorld = rayToWorld;
+        m_closestHitFraction = 1.0f;
+        m_collisionObject = NULL;
+    }
 
-    public:
+    virtual bool needsCollision(btBroadphaseProxy* proxy0) const
+    {
+        if (!btCollisionWorld::ClosestRayResultCallback::needsCollision(proxy0))
+            return false;
 
-        RayTestCallback(const btVector3& rayFromWorld, const btVector3& rayToWorld, PhysicsController::HitFilter* filter)
-            : btCollisionWorld::ClosestRayResultCallback(rayFromWorld, rayToWorld), filter(filter)
-        {
-        }
+        btCollisionObject* co = reinterpret_cast<btCollisionObject*>(proxy0->m_clientObject);
+        PhysicsCollisionObject* object = reinterpret_cast<PhysicsCollisionObject*>(co->getUserPointer());
+        if (object == NULL)
+            return false;
 
-		virtual bool needsCollision(btBroadphaseProxy* proxy0) const
-		{
-            if (!btCollisionWorld::ClosestRayResultCallback::needsCollision(proxy0))
-                return false;
+        return filter ? !filter->filter(object) : true;
+    }
 
-            btCollisionObject* co = reinterpret_cast<btCollisionObject*>(proxy0->m_clientObject);
-            PhysicsCollisionObject* object = reinterpret_cast<PhysicsCollisionObject*>(co->getUserPointer());
-            if (object == NULL)
-                return false;
+    btScalar addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool normalInWorldSpace)
+    {
+        GP_ASSERT(rayResult.m_collisionObject);
+        PhysicsCollisionObject* object = reinterpret_cast<PhysicsCollisionObject*>(rayResult.m_collisionObject->getUserPointer());
 
-            return filter ? !filter->filter(object) : true;
-        }
+        if (object == NULL)
+            return 1.0f; // ignore
 
-        btScalar addSingleResult(btCollisionWorld::LocalRayResult& rayResult, bool normalInWorldSpace)
-        {
-            GP_ASSERT(rayResult.m_collisionObject);
-            PhysicsCollisionObject* object = reinterpret_cast<PhysicsCollisionObject*>(rayResult.m_collisionObject->getUserPointer());
+        float result = btCollisionWorld::ClosestRayResultCallback::addSingleResult(rayResult, normalInWorldSpace);
 
-            if (object == NULL)
-                return 1.0f; // ignore
+        hitResult.object = object;
+        hitResult.point.set(m_hitPointWorld.x(), m_hitPointWorld.y(), m_hitPointWorld.z());
+        hitResult.fraction = m_closestHitFraction;
+        hitResult.normal.set(m_hitNormalWorld.x(), m_hitNormalWorld.y(), m_hitNormalWorld.z());
 
-            float result = btCollisionWorld::ClosestRayResultCallback::addSingleResult(rayResult, normalInWorldSpace);
+        if (filter && !filter->hit(hitResult))
+            return 1.0f; // process next collision
 
-            hitResult.object = object;
-            hitResult.point.set(m_hitPointWorld.x(), m_hitPointWorld.y(), m_hitPointWorld.z());
-            hitResult.fraction = m_closestHitFraction;
-            hitResult.normal.set(m_hitNormalWorld.x(), m_hitNormalWorld.y(), m_hitNormalWorld.z());
+        return result; // continue normally
+    }
 
-            if (filter && !filter->hit(hitResult))
-                return 1.0f; // process next collision
+private:
 
-            return result; // continue normally
-        }
-    };
+    PhysicsController::HitFilter* filter;
+    PhysicsController::HitResult hitResult;
+};
 
-    GP_ASSERT(_world);
+/**
+ * Internal class used to implement sweep tests, which keeps the closest hit accepted by the filter.
+ * @script{ignore}
+ */
+class SweepTestCallback : public btCollisionWorld::ClosestConvexResultCallback
+{
+public:
 
-    btVector3 rayFromWorld(BV(ray.getOrigin()));
-    btVector3 rayToWorld(rayFromWorld + BV(ray.getDirection() * distance));
+    SweepTestCallback(PhysicsCollisionObject* me, PhysicsController::HitFilter* filter)
+        : btCollisionWorld::ClosestConvexResultCallback(btVector3(0.0, 0.0, 0.0), btVector3(0.0, 0.0, 0.0)), me(me), filter(filter)
+    {
+    }
 
-    RayTestCallback callback(rayFromWorld, rayToWorld, filter);
-    _world->rayTest(rayFromWorld, rayToWorld, callback);
-    if (callback.hasHit())
+    /**
+     * Prepares the callback for another swept object, so that batches reuse it.
+     */
+    void reset(PhysicsCollisionObject* object)
     {
-        if (result)
-        {
-            result->object = getCollisionObject(callback.m_collisionObject);
-            result->point.set(callback.m_hitPointWorld.x(), callback.m_hitPointWorld.y(), callback.m_hitPointWorld.z());
-            result->fraction = callback.m_closestHitFraction;
-            result->normal.set(callback.m_hitNormalWorld.x(), callback.m_hitNormalWorld.y(), callback.m_hitNormalWorld.z());
-        }
+        me = object;
+        m_closestHitFraction = 1.0f;
+        m_hitCollisionObject = NULL;
+    }
 
-        return true;
+    virtual bool needsCollision(btBroadphaseProxy* proxy0) const
+    {
+        if (!btCollisionWorld::ClosestConvexResultCallback::needsCollision(proxy0))
+            return false;
+
+        btCollisionObject* co = reinterpret_cast<btCollisionObject*>(proxy0->m_clientObject);
+        PhysicsCollisionObject* object = reinterpret_cast<PhysicsCollisionObject*>(co->getUserPointer());
+        if (object == NULL || object == me)
+            return false;
+
+        return filter ? !filter->filter(object) : true;
     }
 
-    return false;
+    btScalar addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace)
+    {
+        GP_ASSERT(convexResult.m_hitCollisionObject);
+        PhysicsCollisionObject* object = reinterpret_cast<PhysicsCollisionObject*>(convexResult.m_hitCollisionObject->getUserPointer());
+
+        if (object == NULL)
+            return 1.0f;
+
+        float result = ClosestConvexResultCallback::addSingleResult(convexResult, normalInWorldSpace);
+
+        hitResult.object = object;
+        hitResult.point.set(m_hitPointWorld.x(), m_hitPointWorld.y(), m_hitPointWorld.z());
+        hitResult.fraction = m_closestHitFraction;
+        hitResult.normal.set(m_hitNormalWorld.x(), m_hitNormalWorld.y(), m_hitNormalWorld.z());
+
+        if (filter && !filter->hit(hitResult))
+            return 1.0f;
+
+        return result;
+    }
+
+private:
+
+    PhysicsCollisionObject* me;
+    PhysicsController::HitFilter* filter;
+    PhysicsController::HitResult hitResult;
+};
+
+/**
+ * A ray or sweep test of a batch, prepared on the calling thread.
+ * @script{ignore}
+ */
+struct BatchQuery
+{
+    BT_DECLARE_ALIGNED_ALLOCATOR();
+
+    btVector3 from;
+    btVector3 to;
+    btTransform start;
+    btTransform end;
+    PhysicsCollisionObject* object;
+    const btConvexShape* shape;
+};
+
+/**
+ * The state shared by the ranges of a batched ray or sweep test.
+ * @script{ignore}
+ */
+struct BatchContext
+{
+    const btCollisionWorld* world;
+    const btDbvtBroadphase* broadphase;
+    const BatchQuery* queries;
+    PhysicsController::HitResult* results;
+    PhysicsController::HitFilter* filter;
+};
+
+// Copies the closest hit of a callback to a result, or clears the result if there was none.
+static void storeHit(const btCollisionObject* hitObject, const btVector3& point, float fraction, const btVector3& normal, PhysicsController::HitResult* result)
+{
+    if (!hitObject)
+    {
+        result->object = NULL;
+        result->point.set(0.0f, 0.0f, 0.0f);
+        result->fraction = 1.0f;
+        result->normal.set(0.0f, 0.0f, 0.0f);
+        return;
+    }
+
+    result->object = reinterpret_cast<PhysicsCollisionObject*>(hitObject->getUserPointer());
+    result->point.set(point.x(), point.y(), point.z());
+    result->fraction = fraction;
+    result->normal.set(normal.x(), normal.y(), normal.z());
 }
 
-bool PhysicsController::sweepTest(PhysicsCollisionObject* object, const Vector3& endPosition, PhysicsController::HitResult* result, PhysicsController::HitFilter* filter)
+// Returns the number of results of a batch that hit an object.
+// Returns the grain size that splits count indices into at most threadCount ranges of at
+// least minGrainSize indices, so that no more than threadCount threads of the shared pool
+// work on them at once.
+static unsigned int getGrainSize(unsigned int count, unsigned int threadCount, unsigned int minGrainSize)
 {
-    class SweepTestCallback : public btCollisionWorld::ClosestConvexResultCallback
+    GP_ASSERT(threadCount > 0);
+    unsigned int grainSize = (count + threadCount - 1) / threadCount;
+    return grainSize > minGrainSize ? grainSize : minGrainSize;
+}
+
+static unsigned int countHits(const PhysicsController::HitResult* results, unsigned int count)
+{
+    unsigned int hitCount = 0;
+    for (unsigned int i = 0; i < count; ++i)
     {
-    private:
+        if (results[i].object)
+            ++hitCount;
+    }
+    return hitCount;
+}
 
-        PhysicsCollisionObject* me;
-        PhysicsController::HitFilter* filter;
-        PhysicsController::HitResult hitResult;
+// Casts the ray of the callback through the broadphase trees, as btCollisionWorld::rayTest
+// does, but with a traversal stack that is reused between the rays of a batch.
+static void rayTestBroadphase(const btDbvtBroadphase* broadphase, RayTestCallback& callback, btAlignedObjectArray<const btDbvtNode*>& stack)
+{
+    const btVector3& from = callback.m_rayFromWorld;
+    const btVector3& to = callback.m_rayToWorld;
 
-    public:
+    btVector3 direction = to - from;
+    if (direction.fuzzyZero())
+        return;
+    direction.normalize();
+    btVector3 inverseDirection(direction[0] == 0.0f ? BT_LARGE_FLOAT : 1.0f / direction[0],
+                               direction[1] == 0.0f ? BT_LARGE_FLOAT : 1.0f / direction[1],
+                               direction[2] == 0.0f ? BT_LARGE_FLOAT : 1.0f / direction[2]);
+    unsigned int signs[3] = { inverseDirection[0] < 0.0f, inverseDirection[1] < 0.0f, inverseDirection[2] < 0.0f };
+    btScalar lambdaMax = direction.dot(to - from);
+
+    btTransform fromTransform;
+    fromTransform.setIdentity();
+    fromTransform.setOrigin(from);
+    btTransform toTransform;
+    toTransform.setIdentity();
+    toTransform.setOrigin(to);
+
+    // The broadphase keeps dynamic and static proxies in separate trees.
+    for (int i = 0; i < 2; ++i)
+    {
+        const btDbvtNode* root = broadphase->m_sets[i].m_root;
+        if (!root)
+            continue;
 
-        SweepTestCallback(PhysicsCollisionObject* me, PhysicsController::HitFilter* filter)
-            : btCollisionWorld::ClosestConvexResultCallback(btVector3(0.0, 0.0, 0.0), btVector3(0.0, 0.0, 0.0)), me(me), filter(filter)
+        stack.resize(0);
+        stack.push_back(root);
+        while (stack.size() > 0)
         {
-        }
+            const btDbvtNode* node = stack[stack.size() - 1];
+            stack.pop_back();
 
-		virtual bool needsCollision(btBroadphaseProxy* proxy0) const
-		{
-            if (!btCollisionWorld::ClosestConvexResultCallback::needsCollision(proxy0))
-                return false;
+            btVector3 bounds[2] = { node->volume.Mins(), node->volume.Maxs() };
+            btScalar tmin = 1.0f;
+            if (!btRayAabb2(from, inverseDirection, signs, bounds, tmin, 0.0f, lambdaMax))
+                continue;
 
-            btCollisionObject* co = reinterpret_cast<btCollisionObject*>(proxy0->m_clientObject);
-            PhysicsCollisionObject* object = reinterpret_cast<PhysicsCollisionObject*>(co->getUserPointer());
-            if (object == NULL || object == me)
-                return false;
+            if (node->isinternal())
+            {
+                stack.push_back(node->childs[0]);
+                stack.push_back(node->childs[1]);
+                continue;
+            }
 
-            return filter ? !filter->filter(object) : true;
+            // Nothing can be closer than a hit at the start of the ray.
+            if (callback.m_closestHitFraction == 0.0f)
+                return;
+
+            btCollisionObject* co = static_cast<btCollisionObject*>(static_cast<btBroadphaseProxy*>(node->data)->m_clientObject);
+            if (callback.needsCollision(co->getBroadphaseHandle()))
+                btCollisionWorld::rayTestSingle(fromTransform, toTransform, co, co->getCollisionShape(), co->getWorldTransform(), callback);
         }
+    }
+}
 
-        btScalar addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace)
-        {
-            GP_ASSERT(convexResult.m_hitCollisionObject);
-            PhysicsCollisionObject* object = reinterpret_cast<PhysicsCollisionObject*>(convexResult.m_hitCollisionObject->getUserPointer());
+// Runs a range of the rays of a batch, with one callback and traversal stack for the range.
+static void rayTestRange(unsigned int begin, unsigned int end, void* cookie)
+{
+    BatchContext* context = static_cast<BatchContext*>(cookie);
 
-            if (object == NULL)
-                return 1.0f;
+    btAlignedObjectArray<const btDbvtNode*> stack;
+    stack.reserve(PHYSICS_RAY_STACK_SIZE);
+    RayTestCallback callback(btVector3(0.0f, 0.0f, 0.0f), btVector3(0.0f, 0.0f, 0.0f), context->filter);
 
-            float result = ClosestConvexResultCallback::addSingleResult(convexResult, normalInWorldSpace);
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        const BatchQuery& query = context->queries[i];
+        callback.reset(query.from, query.to);
+        rayTestBroadphase(context->broadphase, callback, stack);
+        storeHit(callback.m_collisionObject, callback.m_hitPointWorld, callback.m_closestHitFraction, callback.m_hitNormalWorld, &context->results[i]);
+    }
+}
 
-            hitResult.object = object;
-            hitResult.point.set(m_hitPointWorld.x(), m_hitPointWorld.y(), m_hitPointWorld.z());
-            hitResult.fraction = m_closestHitFraction;
-            hitResult.normal.set(m_hitNormalWorld.x(), m_hitNormalWorld.y(), m_hitNormalWorld.z());
+// Runs a range of the sweeps of a batch, with one callback for the range.
+static void sweepTestRange(unsigned int begin, unsigned int end, void* cookie)
+{
+    BatchContext* context = static_cast<BatchContext*>(cookie);
 
-            if (filter && !filter->hit(hitResult))
-                return 1.0f;
+    SweepTestCallback callback(NULL, context->filter);
 
-            return result;
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        const BatchQuery& query = context->queries[i];
+        const btCollisionObject* hitObject = NULL;
+        if (query.shape)
+        {
+            callback.reset(query.object);
+            context->world->convexSweepTest(query.shape, query.start, query.end, callback, context->world->getDispatchInfo().m_allowedCcdPenetration);
+            hitObject = callback.m_hitCollisionObject;
         }
-    };
+        storeHit(hitObject, callback.m_hitPointWorld, callback.m_closestHitFraction, callback.m_hitNormalWorld, &context->results[i]);
+    }
+}
 
+// Computes the start and end transforms of a sweep test, and returns the shape to sweep,
+// or NULL if the shape of the object cannot be swept.
+static const btConvexShape* getSweepTransforms(PhysicsCollisionObject* object, const Vector3& endPosition, btTransform* start, btTransform* end)
+{
     GP_ASSERT(object && object->getCollisionShape());
     PhysicsCollisionShape* shape = object->getCollisionShape();
     PhysicsCollisionShape::Type type = shape->getType();
     if (type != PhysicsCollisionShape::SHAPE_BOX && type != PhysicsCollisionShape::SHAPE_SPHERE && type != PhysicsCollisionShape::SHAPE_CAPSULE)
-        return false; // unsupported type
+        return NULL; // unsupported type
 
     // Define the start transform.
-    btTransform start;
-    start.setIdentity();
+    start->setIdentity();
     if (object->getNode())
     {
         Vector3 translation;
@@ -300,14 +529,80 @@ bool PhysicsController::sweepTest(PhysicsCollisionObject* object, const Vector3&
         m.getTranslation(&translation);
         m.getRotation(&rotation);
 
-        start.setIdentity();
-        start.setOrigin(BV(translation));
-        start.setRotation(BQ(rotation));
+        start->setIdentity();
+        start->setOrigin(BV(translation));
+        start->setRotation(BQ(rotation));
     }
 
     // Define the end transform.
-    btTransform end(start);
-    end.setOrigin(BV(endPosition));
+    *end = *start;
+    end->setOrigin(BV(endPosition));
+
+    return static_cast<btConvexShape*>(shape->getShape());
+}
+
+bool PhysicsController::rayTest(const Ray& ray, float distance, PhysicsController::HitResult* result, PhysicsController::HitFilter* filter)
+{
+    GP_ASSERT(_world);
+
+    btVector3 rayFromWorld(BV(ray.getOrigin()));
+    btVector3 rayToWorld(rayFromWorld + BV(ray.getDirection() * distance));
+
+    RayTestCallback callback(rayFromWorld, rayToWorld, filter);
+    _world->rayTest(rayFromWorld, rayToWorld, callback);
+    if (callback.hasHit())
+    {
+        if (result)
+        {
+            result->object = getCollisionObject(callback.m_collisionObject);
+            result->point.set(callback.m_hitPointWorld.x(), callback.m_hitPointWorld.y(), callback.m_hitPointWorld.z());
+            result->fraction = callback.m_closestHitFraction;
+            result->normal.set(callback.m_hitNormalWorld.x(), callback.m_hitNormalWorld.y(), callback.m_hitNormalWorld.z());
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+unsigned int PhysicsController::rayTestBatch(const Ray* rays, unsigned int count, float distance, PhysicsController::HitResult* results, PhysicsController::HitFilter* filter)
+{
+    GP_ASSERT(_world && _overlappingPairCache);
+    GP_ASSERT(rays || count == 0);
+    GP_ASSERT(results || count == 0);
+
+    btAlignedObjectArray<BatchQuery> queries;
+    queries.resize(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        queries[i].from = BV(rays[i].getOrigin());
+        queries[i].to = queries[i].from + BV(rays[i].getDirection() * distance);
+    }
+
+    BatchContext context;
+    context.world = _world;
+    context.broadphase = static_cast<btDbvtBroadphase*>(_overlappingPairCache);
+    context.queries = count > 0 ? &queries[0] : NULL;
+    context.results = results;
+    context.filter = filter;
+
+    // Ray tests only read the world, so ranges of rays can run on the physics threads.
+    if (_threadPool)
+        _threadPool->parallelFor(count, rayTestRange, &context, getGrainSize(count, _threadCount, PHYSICS_QUERY_BATCH_GRAIN));
+    else if (count > 0)
+        rayTestRange(0, count, &context);
+
+    return countHits(results, count);
+}
+
+bool PhysicsController::sweepTest(PhysicsCollisionObject* object, const Vector3& endPosition, PhysicsController::HitResult* result, PhysicsController::HitFilter* filter)
+{
+    btTransform start;
+    btTransform end;
+    const btConvexShape* shape = getSweepTransforms(object, endPosition, &start, &end);
+    if (!shape)
+        return false; // unsupported type
 
     // Perform bullet convex sweep test.
     SweepTestCallback callback(object, filter);
@@ -319,16 +614,16 @@ bool PhysicsController::sweepTest(PhysicsCollisionObject* object, const Vector3&
     {
     case PhysicsCollisionObject::GHOST_OBJECT:
     case PhysicsCollisionObject::CHARACTER:
-        static_cast<PhysicsGhostObject*>(object)->_ghostObject->convexSweepTest(static_cast<btConvexShape*>(shape->getShape()), start, end, callback, _world->getDispatchInfo().m_allowedCcdPenetration);
+        static_cast<PhysicsGhostObject*>(object)->_ghostObject->convexSweepTest(shape, start, end, callback, _world->getDispatchInfo().m_allowedCcdPenetration);
         break;
 
     default:
-        _world->convexSweepTest(static_cast<btConvexShape*>(shape->getShape()), start, end, callback, _world->getDispatchInfo().m_allowedCcdPenetration);
+        _world->convexSweepTest(shape, start, end, callback, _world->getDispatchInfo().m_allowedCcdPenetration);
         break;
     }*/
 
     GP_ASSERT(_world);
-    _world->convexSweepTest(static_cast<btConvexShape*>(shape->getShape()), start, end, callback, _world->getDispatchInfo().m_allowedCcdPenetration);
+    _world->convexSweepTest(shape, start, end, callback, _world->getDispatchInfo().m_allowedCcdPenetration);
 
     // Check for hits and store results.
     if (callback.hasHit())
@@ -347,88 +642,200 @@ bool PhysicsController::sweepTest(PhysicsCollisionObject* object, const Vector3&
     return false;
 }
 
-btScalar PhysicsController::CollisionCallback::addSingleResult(btManifoldPoint& cp, const btCollisionObject* a, int partIdA, int indexA, 
-    const btCollisionObject* b, int partIdB, int indexB)
+unsigned int PhysicsController::sweepTestBatch(PhysicsCollisionObject* const* objects, const Vector3* endPositions, unsigned int count,
+                                               PhysicsController::HitResult* results, PhysicsController::HitFilter* filter)
 {
-    GP_ASSERT(_pc);
-
-    // Get pointers to the PhysicsCollisionObject objects.
-    PhysicsCollisionObject* objectA = _pc->getCollisionObject(a);
-    PhysicsCollisionObject* objectB = _pc->getCollisionObject(b);
-
-    // If the given collision object pair has collided in the past, then
-    // we notify the listeners only if the pair was not colliding
-    // during the previous frame. Otherwise, it's a new pair, so add a
-    // new entry to the cache with the appropriate listeners and notify them.
-    PhysicsCollisionObject::CollisionPair pair(objectA, objectB);
+    GP_ASSERT(_world);
+    GP_ASSERT((objects && endPositions && results) || count == 0);
 
-    CollisionInfo* collisionInfo;
-    if (_pc->_collisionStatus.count(pair) > 0)
+    // The start transforms come from the nodes, whose world matrices are updated lazily,
+    // so they are computed here rather than on the threads.
+    btAlignedObjectArray<BatchQuery> queries;
+    queries.resize(count);
+    for (unsigned int i = 0; i < count; ++i)
     {
-        collisionInfo = &_pc->_collisionStatus[pair];
+        queries[i].object = objects[i];
+        queries[i].shape = getSweepTransforms(objects[i], endPositions[i], &queries[i].start, &queries[i].end);
     }
+
+    BatchContext context;
+    context.world = _world;
+    context.broadphase = NULL;
+    context.queries = count > 0 ? &queries[0] : NULL;
+    context.results = results;
+    context.filter = filter;
+
+#if PHYSICS_PARALLEL_PROFILED_CALLS
+    if (_threadPool)
+        _threadPool->parallelFor(count, sweepTestRange, &context, getGrainSize(count, _threadCount, PHYSICS_QUERY_BATCH_GRAIN));
     else
+#endif
+    if (count > 0)
+        sweepTestRange(0, count, &context);
+
+    return countHits(results, count);
+}
+
+void PhysicsController::updateCollisionStatus()
+{
+    // The entries that were colliding after the last update are dirtied. Those whose pair
+    // still has contacts are cleaned while going through the manifolds, and the others
+    // stop colliding.
+    for (unsigned int i = 0, count = _collidingPairs.size(); i < count; ++i)
     {
-        // Add a new collision pair for these objects.
-        collisionInfo = &_pc->_collisionStatus[pair];
+        CollisionStatusTable::Entry* entry = _collisionStatus.find(_collidingPairs[i].objectA, _collidingPairs[i].objectB);
+        if (entry)
+            entry->info._status |= DIRTY;
+    }
 
-        // Add the appropriate listeners.
-        PhysicsCollisionObject::CollisionPair p1(pair.objectA, NULL);
-        if (_pc->_collisionStatus.count(p1) > 0)
+    // Go through the contact manifolds computed by the last simulation step.
+    _nextCollidingPairs.clear();
+    GP_ASSERT(_dispatcher);
+    for (int i = 0, count = _dispatcher->getNumManifolds(); i < count; ++i)
+    {
+        btPersistentManifold* manifold = _dispatcher->getManifoldByIndexInternal(i);
+        GP_ASSERT(manifold);
+        if (manifold->getNumContacts() == 0)
+            continue;
+
+        PhysicsCollisionObject* object0 = getCollisionObject(static_cast<const btCollisionObject*>(manifold->getBody0()));
+        PhysicsCollisionObject* object1 = getCollisionObject(static_cast<const btCollisionObject*>(manifold->getBody1()));
+        if (!object0 || !object1)
+            continue;
+
+        CollisionStatusTable::Entry* entry = _collisionStatus.find(object0, object1);
+        if (!entry)
         {
-            const CollisionInfo& ci = _pc->_collisionStatus[p1];
-            std::vector<PhysicsCollisionObject::CollisionListener*>::const_iterator iter = ci._listeners.begin();
-            for (; iter != ci._listeners.end(); iter++)
+            // Pairs that were not registered for only need an entry if one of their
+            // objects is registered for all of its collisions. That object comes first.
+            PhysicsCollisionObject* objectA = object0;
+            PhysicsCollisionObject* objectB = object1;
+            if (!_collisionStatus.find(objectA, NULL))
             {
-                GP_ASSERT(*iter);
-                collisionInfo->_listeners.push_back(*iter);
+                if (!_collisionStatus.find(objectB, NULL))
+                    continue;
+                std::swap(objectA, objectB);
             }
+
+            // Add a new collision pair with the appropriate listeners.
+            entry = &_collisionStatus.insert(objectA, objectB);
+            CollisionInfo& collisionInfo = entry->info;
+            const CollisionStatusTable::Entry* entryA = _collisionStatus.find(objectA, NULL);
+            const CollisionStatusTable::Entry* entryB = _collisionStatus.find(objectB, NULL);
+            if (entryA)
+                collisionInfo._listeners.insert(collisionInfo._listeners.end(), entryA->info._listeners.begin(), entryA->info._listeners.end());
+            if (entryB)
+                collisionInfo._listeners.insert(collisionInfo._listeners.end(), entryB->info._listeners.begin(), entryB->info._listeners.end());
         }
-        PhysicsCollisionObject::CollisionPair p2(pair.objectB, NULL);
-        if (_pc->_collisionStatus.count(p2) > 0)
+
+        // Pairs can have several manifolds (such as with compound shapes).
+        int status = entry->info._status;
+        if ((status & COLLISION) != 0 && (status & DIRTY) == 0)
+            continue;
+
+        entry->info._status = (status & ~DIRTY) | COLLISION;
+        _nextCollidingPairs.push_back(entry->pair);
+
+        // Fire the collision event if the pair was not colliding after the last update.
+        if ((status & (COLLISION | REMOVE)) == 0 && !entry->info._listeners.empty())
         {
-            const CollisionInfo& ci = _pc->_collisionStatus[p2];
-            std::vector<PhysicsCollisionObject::CollisionListener*>::const_iterator iter = ci._listeners.begin();
-            for (; iter != ci._listeners.end(); iter++)
+            // Listeners may add collision listeners, which invalidates the entry.
+            PhysicsCollisionObject::CollisionPair pair = entry->pair;
+            std::vector<PhysicsCollisionObject::CollisionListener*> listeners = entry->info._listeners;
+
+            const btManifoldPoint& cp = manifold->getContactPoint(0);
+            const btVector3& pointA = pair.objectA == object0 ? cp.getPositionWorldOnA() : cp.getPositionWorldOnB();
+            const btVector3& pointB = pair.objectA == object0 ? cp.getPositionWorldOnB() : cp.getPositionWorldOnA();
+            for (unsigned int j = 0, listenerCount = listeners.size(); j < listenerCount; ++j)
             {
-                GP_ASSERT(*iter);
-                collisionInfo->_listeners.push_back(*iter);
+                GP_ASSERT(listeners[j]);
+                listeners[j]->collisionEvent(PhysicsCollisionObject::CollisionListener::COLLIDING, pair,
+                    Vector3(pointA.x(), pointA.y(), pointA.z()), Vector3(pointB.x(), pointB.y(), pointB.z()));
             }
         }
     }
 
-    // Fire collision event.
-    if ((collisionInfo->_status & COLLISION) == 0)
+    // Pairs that are still dirty are no longer colliding.
+    for (unsigned int i = 0, count = _collidingPairs.size(); i < count; ++i)
     {
-        std::vector<PhysicsCollisionObject::CollisionListener*>::const_iterator iter = collisionInfo->_listeners.begin();
-        for (; iter != collisionInfo->_listeners.end(); iter++)
+        CollisionStatusTable::Entry* entry = _collisionStatus.find(_collidingPairs[i].objectA, _collidingPairs[i].objectB);
+        if (!entry || (entry->info._status & DIRTY) == 0)
+            continue;
+
+        entry->info._status &= ~(DIRTY | COLLISION);
+        PhysicsCollisionObject::CollisionPair pair = entry->pair;
+        std::vector<PhysicsCollisionObject::CollisionListener*> listeners = entry->info._listeners;
+        for (unsigned int j = 0, listenerCount = listeners.size(); j < listenerCount; ++j)
         {
-            GP_ASSERT(*iter);
-            if ((collisionInfo->_status & REMOVE) == 0)
-            {
-                (*iter)->collisionEvent(PhysicsCollisionObject::CollisionListener::COLLIDING, pair, Vector3(cp.getPositionWorldOnA().x(), cp.getPositionWorldOnA().y(), cp.getPositionWorldOnA().z()),
-                    Vector3(cp.getPositionWorldOnB().x(), cp.getPositionWorldOnB().y(), cp.getPositionWorldOnB().z()));
-            }
+            GP_ASSERT(listeners[j]);
+            listeners[j]->collisionEvent(PhysicsCollisionObject::CollisionListener::NOT_COLLIDING, pair);
         }
     }
 
-    // Update the collision status cache (we remove the dirty bit
-    // set in the controller's update so that this particular collision pair's
-    // status is not reset to 'no collision' when the controller's update completes).
-    collisionInfo->_status &= ~DIRTY;
-    collisionInfo->_status |= COLLISION;
-    return 0.0f;
+    _collidingPairs.swap(_nextCollidingPairs);
 }
 
 void PhysicsController::initialize()
 {
-    _collisionConfiguration = new btDefaultCollisionConfiguration();
-    _dispatcher = new btCollisionDispatcher(_collisionConfiguration);
+    // Read the stepping and threading settings from the game config.
+    Properties* config = Game::getInstance()->getConfig();
+    Properties* physics = config ? config->getNamespace("physics", true) : NULL;
+    if (physics)
+    {
+        if (physics->exists("fixedTimeStep"))
+        {
+            float fixedTimeStep = physics->getFloat("fixedTimeStep");
+            if (fixedTimeStep > 0.0f)
+                _fixedTimeStep = fixedTimeStep;
+            else
+                GP_WARN("Invalid physics fixedTimeStep %f; using %f.", fixedTimeStep, _fixedTimeStep);
+        }
+        if (physics->exists("maxSubsteps"))
+        {
+            int maxSubsteps = physics->getInt("maxSubsteps");
+            if (maxSubsteps >= 0)
+                _maxSubsteps = maxSubsteps;
+            else
+                GP_WARN("Invalid physics maxSubsteps %d; using %u.", maxSubsteps, _maxSubsteps);
+        }
+        if (physics->exists("threads"))
+        {
+            int threads = physics->getInt("threads");
+            if (threads >= 1)
+                _threadCount = threads;
+            else
+                GP_WARN("Invalid physics threads %d; using %u.", threads, _threadCount);
+        }
+    }
+
+    // Physics shares the engine's worker threads (the threads property caps how many of
+    // them it uses), and the calling thread makes up the last thread.
+    if (_threadCount > 1)
+    {
+        ThreadPool* threadPool = Game::getInstance()->getThreadPool();
+        unsigned int available = threadPool ? threadPool->getThreadCount() + 1 : 1;
+        if (_threadCount > available)
+            _threadCount = available;
+        if (_threadCount > 1)
+            _threadPool = threadPool;
+    }
+
     _overlappingPairCache = new btDbvtBroadphase();
     _solver = new btSequentialImpulseConstraintSolver();
 
     // Create the world.
-    _world = new btDiscreteDynamicsWorld(_dispatcher, _overlappingPairCache, _solver, _collisionConfiguration);
+    if (_threadPool)
+    {
+        _collisionConfiguration = new ParallelCollisionConfiguration();
+        _dispatcher = new ParallelDispatcher(_collisionConfiguration, _threadPool, _threadCount);
+        _world = new btDiscreteDynamicsWorld(_dispatcher, _overlappingPairCache, _solver, _collisionConfiguration);
+    }
+    else
+    {
+        _collisionConfiguration = new btDefaultCollisionConfiguration();
+        _dispatcher = new btCollisionDispatcher(_collisionConfiguration);
+        _world = new btDiscreteDynamicsWorld(_dispatcher, _overlappingPairCache, _solver, _collisionConfiguration);
+    }
     _world->setGravity(BV(_gravity));
 
     // Register ghost pair callback so bullet detects collisions with ghost objects (used for character collisions).
@@ -451,6 +858,8 @@ void PhysicsController::finalize()
     SAFE_DELETE(_overlappingPairCache);
     SAFE_DELETE(_dispatcher);
     SAFE_DELETE(_collisionConfiguration);
+    _threadPool = NULL;
+    _threadCount = 1;
 }
 
 void PhysicsController::pause()
@@ -468,12 +877,15 @@ void PhysicsController::update(float elapsedTime)
     GP_ASSERT(_world);
     _isUpdating = true;
 
-    // Update the physics simulation, with a maximum
-    // of 10 simulation steps being performed in a given frame.
+    // Update the physics simulation in fixed steps, with at most _maxSubsteps
+    // steps being performed in a given frame.
     //
-    // Note that stepSimulation takes elapsed time in seconds
+    // Note that stepSimulation takes times in seconds
     // so we divide by 1000 to convert from milliseconds.
-    _world->stepSimulation(elapsedTime * 0.001f, 10);
+    // It returns the number of steps due, before they are capped.
+    int steps = _world->stepSimulation(elapsedTime * 0.001f, (int)_maxSubsteps, _fixedTimeStep * 0.001f);
+    _substepCount = (_maxSubsteps > 0 && steps > (int)_maxSubsteps) ? _maxSubsteps : (unsigned int)steps;
+    _droppedSubstepCount = (unsigned int)steps - _substepCount;
 
     // If we have status listeners, then check if our status has changed.
     if (_listeners || _callbacks["statusEvent"])
@@ -525,63 +937,20 @@ void PhysicsController::update(float elapsedTime)
         }
     }
 
-    // All statuses are set with the DIRTY bit before collision processing occurs.
-    // During collision processing, if a collision occurs, the status is 
-    // set to COLLISION and the DIRTY bit is cleared. Then, after collision processing 
-    // is finished, if a given status is still dirty, the COLLISION bit is cleared.
+    // Collision events are read from the contact manifolds that Bullet computed during the
+    // step, so their cost depends on the number of contacts rather than on the number of
+    // registered listeners. During processing, the entries of pairs that have contacts are
+    // set to COLLISION; those that were colliding and have no contacts left are reset.
     //
     // If an entry was marked for removal in the last frame, remove it now.
-
-    // Dirty the collision status cache entries.
-    std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo>::iterator iter = _collisionStatus.begin();
-    for (; iter != _collisionStatus.end();)
+    _collisionStatus.removeMarked();
+    if (_collisionStatus.size() > 0)
     {
-        if ((iter->second._status & REMOVE) != 0)
-        {
-            std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo>::iterator eraseIter = iter;
-            iter++;
-            _collisionStatus.erase(eraseIter);
-        }
-        else
-        {
-            iter->second._status |= DIRTY;
-            iter++;
-        }
+        updateCollisionStatus();
     }
-
-    // Go through the collision status cache and perform all registered collision tests.
-    iter = _collisionStatus.begin();
-    for (; iter != _collisionStatus.end(); iter++)
+    else
     {
-        // If this collision pair was one that was registered for listening, then perform the collision test.
-        // (In the case where we register for all collisions with a rigid body, there will be a lot
-        // of collision pairs in the status cache that we did not explicitly register for.)
-        if ((iter->second._status & REGISTERED) != 0 && (iter->second._status & REMOVE) == 0)
-        {
-            if (iter->first.objectB)
-                _world->contactPairTest(iter->first.objectA->getCollisionObject(), iter->first.objectB->getCollisionObject(), *_collisionCallback);
-            else
-                _world->contactTest(iter->first.objectA->getCollisionObject(), *_collisionCallback);
-        }
-    }
-
-    // Update all the collision status cache entries.
-    iter = _collisionStatus.begin();
-    for (; iter != _collisionStatus.end(); iter++)
-    {
-        if ((iter->second._status & DIRTY) != 0)
-        {
-            if ((iter->second._status & COLLISION) != 0 && iter->first.objectB)
-            {
-                unsigned int size = iter->second._listeners.size();
-                for (unsigned int i = 0; i < size; i++)
-                {
-                    iter->second._listeners[i]->collisionEvent(PhysicsCollisionObject::CollisionListener::NOT_COLLIDING, iter->first);
-                }
-            }
-
-            iter->second._status &= ~COLLISION;
-        }
+        _collidingPairs.clear();
     }
 
     _isUpdating = false;
@@ -593,10 +962,9 @@ void PhysicsController::addCollisionListener(PhysicsCollisionObject::CollisionLi
     
     // One of the collision objects in the pair must be non-null.
     GP_ASSERT(objectA || objectB);
-    PhysicsCollisionObject::CollisionPair pair(objectA, objectB);
 
     // Add the listener and ensure the status includes that this collision pair is registered.
-    CollisionInfo& info = _collisionStatus[pair];
+    CollisionInfo& info = _collisionStatus.insert(objectA, objectB).info;
     info._listeners.push_back(listener);
     info._status |= PhysicsController::REGISTERED;
 }
@@ -605,13 +973,9 @@ void PhysicsController::removeCollisionListener(PhysicsCollisionObject::Collisio
 {
     // One of the collision objects in the pair must be non-null.
     GP_ASSERT(objectA || objectB);
-    PhysicsCollisionObject::CollisionPair pair(objectA, objectB);
 
     // Mark the collision pair for these objects for removal.
-    if (_collisionStatus.count(pair) > 0)
-    {
-        _collisionStatus[pair]._status |= REMOVE;
-    }
+    _collisionStatus.markForRemoval(objectA, objectB);
 }
 
 void PhysicsController::addCollisionObject(PhysicsCollisionObject* object)
@@ -673,12 +1037,7 @@ void PhysicsController::removeCollisionObject(PhysicsCollisionObject* object, bo
     // Find all references to the object in the collision status cache and mark them for removal.
     if (removeListeners)
     {
-        std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo>::iterator iter = _collisionStatus.begin();
-        for (; iter != _collisionStatus.end(); iter++)
-        {
-            if (iter->first.objectA == object || iter->first.objectB == object)
-                iter->second._status |= REMOVE;
-        }
+        _collisionStatus.markForRemoval(object);
     }
 }
 
@@ -1175,21 +1534,18 @@ PhysicsCollisionShape* PhysicsController::createMesh(Mesh* mesh, const Vector3&
     PhysicsCollisionShape::MeshData* shapeMeshData = new PhysicsCollisionShape::MeshData();
     shapeMeshData->vertexData = NULL;
 
-    // Copy the scaled vertex position data to the rigid body's local buffer.
+    // Copy the vertex position data to the rigid body's local buffer and scale it in place.
     Matrix m;
     Matrix::createScale(scale, &m);
     unsigned int vertexCount = data->vertexCount;
     shapeMeshData->vertexData = new float[vertexCount * 3];
-    Vector3 v;
     int vertexStride = data->vertexFormat.getVertexSize();
     for (unsigned int i = 0; i < data->vertexCount; i++)
     {
-        v.set(*((float*)&data->vertexData[i * vertexStride + 0 * sizeof(float)]),
-              *((float*)&data->vertexData[i * vertexStride + 1 * sizeof(float)]),
-              *((float*)&data->vertexData[i * vertexStride + 2 * sizeof(float)]));
-        v *= m;
-        memcpy(&(shapeMeshData->vertexData[i * 3]), &v, sizeof(float) * 3);
+        memcpy(&(shapeMeshData->vertexData[i * 3]), &data->vertexData[i * vertexStride], sizeof(float) * 3);
     }
+    Vector3* positions = (Vector3*)shapeMeshData->vertexData;
+    m.transformVectors(positions, positions, vertexCount);
 
     btTriangleIndexVertexArray* meshInterface = bullet_new<btTriangleIndexVertexArray>();
 
@@ -1547,6 +1903,351 @@ int PhysicsController::DebugDrawer::getDebugMode() const
     return _mode;
 }
 
+PhysicsController::ParallelCollisionConfiguration::ParallelCollisionConfiguration()
+    : btDefaultCollisionConfiguration(constructionInfo()), _convexConvexCreateFunc(NULL)
+{
+    GP_ASSERT(m_convexConvexCreateFunc);
+    _convexConvexCreateFunc = new ConvexConvexCreateFunc(static_cast<btConvexConvexAlgorithm::CreateFunc*>(m_convexConvexCreateFunc));
+}
+
+PhysicsController::ParallelCollisionConfiguration::~ParallelCollisionConfiguration()
+{
+    SAFE_DELETE(_convexConvexCreateFunc);
+}
+
+btDefaultCollisionConstructionInfo PhysicsController::ParallelCollisionConfiguration::constructionInfo()
+{
+    // Size the collision algorithm pool for the larger convex algorithm.
+    btDefaultCollisionConstructionInfo info;
+    info.m_customCollisionAlgorithmMaxElementSize = sizeof(ConvexConvexAlgorithm);
+    return info;
+}
+
+btCollisionAlgorithmCreateFunc* PhysicsController::ParallelCollisionConfiguration::getCollisionAlgorithmCreateFunc(int proxyType0, int proxyType1)
+{
+    btCollisionAlgorithmCreateFunc* func = btDefaultCollisionConfiguration::getCollisionAlgorithmCreateFunc(proxyType0, proxyType1);
+    return func == m_convexConvexCreateFunc ? _convexConvexCreateFunc : func;
+}
+
+PhysicsController::ParallelCollisionConfiguration::ConvexConvexAlgorithm::ConvexConvexAlgorithm(btPersistentManifold* manifold,
+    const btCollisionAlgorithmConstructionInfo& ci, btCollisionObject* body0, btCollisionObject* body1,
+    btConvexPenetrationDepthSolver* pdSolver, int numPerturbationIterations, int minimumPointsPerturbationThreshold)
+    : btConvexConvexAlgorithm(manifold, ci, body0, body1, &_simplexSolver, pdSolver, numPerturbationIterations, minimumPointsPerturbationThreshold)
+{
+    // The base class only keeps the address of the simplex solver, which is constructed after it.
+}
+
+PhysicsController::ParallelCollisionConfiguration::ConvexConvexCreateFunc::ConvexConvexCreateFunc(const btConvexConvexAlgorithm::CreateFunc* defaultFunc)
+    : _pdSolver(defaultFunc->m_pdSolver), _numPerturbationIterations(defaultFunc->m_numPerturbationIterations),
+    _minimumPointsPerturbationThreshold(defaultFunc->m_minimumPointsPerturbationThreshold)
+{
+}
+
+btCollisionAlgorithm* PhysicsController::ParallelCollisionConfiguration::ConvexConvexCreateFunc::CreateCollisionAlgorithm(
+    btCollisionAlgorithmConstructionInfo& ci, btCollisionObject* body0, btCollisionObject* body1)
+{
+    void* mem = ci.m_dispatcher1->allocateCollisionAlgorithm(sizeof(ConvexConvexAlgorithm));
+    return new(mem) ConvexConvexAlgorithm(ci.m_manifold, ci, body0, body1, _pdSolver, _numPerturbationIterations, _minimumPointsPerturbationThreshold);
+}
+
+PhysicsController::ParallelDispatcher::ParallelDispatcher(btCollisionConfiguration* collisionConfiguration, ThreadPool* threadPool, unsigned int threadCount)
+    : btCollisionDispatcher(collisionConfiguration), _threadPool(threadPool), _threadCount(threadCount), _dispatchInfo(NULL), _parallel(false)
+{
+    GP_ASSERT(_threadPool);
+    GP_ASSERT(_threadCount > 0);
+
+    // Recursive, since creating the algorithm of a compound pair creates those of its children.
+#ifdef WIN32
+    InitializeCriticalSection(&_mutex);
+#else
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+#endif
+}
+
+PhysicsController::ParallelDispatcher::~ParallelDispatcher()
+{
+#ifdef WIN32
+    DeleteCriticalSection(&_mutex);
+#else
+    pthread_mutex_destroy(&_mutex);
+#endif
+}
+
+btCollisionAlgorithm* PhysicsController::ParallelDispatcher::findAlgorithm(btCollisionObject* body0, btCollisionObject* body1, btPersistentManifold* sharedManifold)
+{
+    lock();
+    btCollisionAlgorithm* algorithm = btCollisionDispatcher::findAlgorithm(body0, body1, sharedManifold);
+    unlock();
+    return algorithm;
+}
+
+btPersistentManifold* PhysicsController::ParallelDispatcher::getNewManifold(void* body0, void* body1)
+{
+    lock();
+    btPersistentManifold* manifold = btCollisionDispatcher::getNewManifold(body0, body1);
+    unlock();
+    return manifold;
+}
+
+void PhysicsController::ParallelDispatcher::releaseManifold(btPersistentManifold* manifold)
+{
+    lock();
+    btCollisionDispatcher::releaseManifold(manifold);
+    unlock();
+}
+
+void* PhysicsController::ParallelDispatcher::allocateCollisionAlgorithm(int size)
+{
+    lock();
+    void* ptr = btCollisionDispatcher::allocateCollisionAlgorithm(size);
+    unlock();
+    return ptr;
+}
+
+void PhysicsController::ParallelDispatcher::freeCollisionAlgorithm(void* ptr)
+{
+    lock();
+    btCollisionDispatcher::freeCollisionAlgorithm(ptr);
+    unlock();
+}
+
+void PhysicsController::ParallelDispatcher::dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& dispatchInfo, btDispatcher* dispatcher)
+{
+    GP_ASSERT(pairCache);
+
+    int pairCount = pairCache->getNumOverlappingPairs();
+    if (pairCount == 0)
+        return;
+
+    // Create the algorithms of new pairs up front, as the near callback would.
+    // Pairs with a concave (mesh, heightfield) or compound body are kept on this thread,
+    // since their algorithms temporarily swap the shape and transform of that body, which
+    // is usually shared by many pairs.
+    _parallelPairs.clear();
+    _serialPairs.clear();
+    btBroadphasePair* pairs = pairCache->getOverlappingPairArrayPtr();
+    for (int i = 0; i < pairCount; ++i)
+    {
+        btBroadphasePair& pair = pairs[i];
+        btCollisionObject* body0 = static_cast<btCollisionObject*>(pair.m_pProxy0->m_clientObject);
+        btCollisionObject* body1 = static_cast<btCollisionObject*>(pair.m_pProxy1->m_clientObject);
+        if (!pair.m_algorithm && needsCollision(body0, body1))
+            pair.m_algorithm = findAlgorithm(body0, body1);
+
+        if (isSharedShape(body0->getCollisionShape()) || isSharedShape(body1->getCollisionShape()))
+            _serialPairs.push_back(&pair);
+        else
+            _parallelPairs.push_back(&pair);
+    }
+
+    btNearCallback nearCallback = getNearCallback();
+    for (unsigned int i = 0, count = _serialPairs.size(); i < count; ++i)
+    {
+        nearCallback(*_serialPairs[i], *this, dispatchInfo);
+    }
+
+    // The other pairs only touch their own algorithm and manifolds. Allocations are
+    // only locked while they run.
+    _dispatchInfo = &dispatchInfo;
+    _parallel = true;
+    _threadPool->parallelFor(_parallelPairs.size(), dispatchPairs, this, getGrainSize(_parallelPairs.size(), _threadCount, 16));
+    _parallel = false;
+    _dispatchInfo = NULL;
+
+    // Manifolds were allocated in whatever order the threads got to them.
+    if (m_manifoldsPtr.size() > 1)
+    {
+        btPersistentManifold** manifolds = &m_manifoldsPtr[0];
+        std::stable_sort(manifolds, manifolds + m_manifoldsPtr.size(), compareManifolds);
+        for (int i = 0; i < m_manifoldsPtr.size(); ++i)
+        {
+            m_manifoldsPtr[i]->m_index1a = i;
+        }
+    }
+}
+
+void PhysicsController::ParallelDispatcher::dispatchPairs(unsigned int begin, unsigned int end, void* cookie)
+{
+    ParallelDispatcher* dispatcher = static_cast<ParallelDispatcher*>(cookie);
+    btNearCallback nearCallback = dispatcher->getNearCallback();
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        nearCallback(*dispatcher->_parallelPairs[i], *dispatcher, *dispatcher->_dispatchInfo);
+    }
+}
+
+bool PhysicsController::ParallelDispatcher::isSharedShape(const btCollisionShape* shape)
+{
+    GP_ASSERT(shape);
+    return shape->isConcave() || shape->isCompound();
+}
+
+bool PhysicsController::ParallelDispatcher::compareManifolds(const btPersistentManifold* m1, const btPersistentManifold* m2)
+{
+    const btCollisionObject* a1 = static_cast<const btCollisionObject*>(m1->getBody0());
+    const btCollisionObject* b1 = static_cast<const btCollisionObject*>(m1->getBody1());
+    const btCollisionObject* a2 = static_cast<const btCollisionObject*>(m2->getBody0());
+    const btCollisionObject* b2 = static_cast<const btCollisionObject*>(m2->getBody1());
+    int idA1 = a1->getBroadphaseHandle() ? a1->getBroadphaseHandle()->m_uniqueId : -1;
+    int idA2 = a2->getBroadphaseHandle() ? a2->getBroadphaseHandle()->m_uniqueId : -1;
+    if (idA1 != idA2)
+        return idA1 < idA2;
+    int idB1 = b1->getBroadphaseHandle() ? b1->getBroadphaseHandle()->m_uniqueId : -1;
+    int idB2 = b2->getBroadphaseHandle() ? b2->getBroadphaseHandle()->m_uniqueId : -1;
+    return idB1 < idB2;
+}
+
+void PhysicsController::ParallelDispatcher::lock()
+{
+    if (!_parallel)
+        return;
+#ifdef WIN32
+    EnterCriticalSection(&_mutex);
+#else
+    pthread_mutex_lock(&_mutex);
+#endif
+}
+
+void PhysicsController::ParallelDispatcher::unlock()
+{
+    if (!_parallel)
+        return;
+#ifdef WIN32
+    LeaveCriticalSection(&_mutex);
+#else
+    pthread_mutex_unlock(&_mutex);
+#endif
+}
+
+PhysicsController::CollisionStatusTable::CollisionStatusTable()
+    : _entries(COLLISION_STATUS_INITIAL_CAPACITY), _size(0), _markedCount(0)
+{
+}
+
+PhysicsController::CollisionStatusTable::Entry* PhysicsController::CollisionStatusTable::find(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB)
+{
+    Entry& entry = _entries[findSlot(objectA, objectB)];
+    return entry.used ? &entry : NULL;
+}
+
+PhysicsController::CollisionStatusTable::Entry& PhysicsController::CollisionStatusTable::insert(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB)
+{
+    unsigned int slot = findSlot(objectA, objectB);
+    if (_entries[slot].used)
+        return _entries[slot];
+
+    // Keep the load factor under one half, so that probe sequences stay short.
+    if ((_size + 1) * 2 > _entries.size())
+    {
+        rehash(_entries.size() * 2, false);
+        slot = findSlot(objectA, objectB);
+    }
+
+    Entry& entry = _entries[slot];
+    entry.pair = PhysicsCollisionObject::CollisionPair(objectA, objectB);
+    entry.used = true;
+    ++_size;
+    return entry;
+}
+
+void PhysicsController::CollisionStatusTable::markForRemoval(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB)
+{
+    Entry* entry = find(objectA, objectB);
+    if (entry && (entry->info._status & REMOVE) == 0)
+    {
+        entry->info._status |= REMOVE;
+        ++_markedCount;
+    }
+}
+
+void PhysicsController::CollisionStatusTable::markForRemoval(PhysicsCollisionObject* object)
+{
+    for (unsigned int i = 0, count = _entries.size(); i < count; ++i)
+    {
+        Entry& entry = _entries[i];
+        if (entry.used && (entry.pair.objectA == object || entry.pair.objectB == object) && (entry.info._status & REMOVE) == 0)
+        {
+            entry.info._status |= REMOVE;
+            ++_markedCount;
+        }
+    }
+}
+
+void PhysicsController::CollisionStatusTable::removeMarked()
+{
+    if (_markedCount > 0)
+    {
+        // Rebuilding the table is simpler than shifting the probe sequences of the removed entries.
+        rehash(_entries.size(), true);
+    }
+}
+
+unsigned int PhysicsController::CollisionStatusTable::size() const
+{
+    return _size;
+}
+
+unsigned int PhysicsController::CollisionStatusTable::hash(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB)
+{
+    // Order independent, since pairs are unordered.
+    size_t a = (size_t)objectA;
+    size_t b = (size_t)objectB;
+    if (a > b)
+        std::swap(a, b);
+
+    unsigned long long h = (unsigned long long)a * 0x9E3779B97F4A7C15ull;
+    h ^= (unsigned long long)b + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    h *= 0xC2B2AE3D27D4EB4Full;
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+unsigned int PhysicsController::CollisionStatusTable::findSlot(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB) const
+{
+    // Linear probing. The capacity is a power of two and the table is never full,
+    // so this ends on either the entry of the pair or an unused slot.
+    unsigned int mask = _entries.size() - 1;
+    unsigned int slot = hash(objectA, objectB) & mask;
+    while (true)
+    {
+        const Entry& entry = _entries[slot];
+        if (!entry.used)
+            return slot;
+        if ((entry.pair.objectA == objectA && entry.pair.objectB == objectB) ||
+            (entry.pair.objectA == objectB && entry.pair.objectB == objectA))
+            return slot;
+        slot = (slot + 1) & mask;
+    }
+}
+
+void PhysicsController::CollisionStatusTable::rehash(unsigned int capacity, bool removeMarked)
+{
+    GP_ASSERT(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+    std::vector<Entry> entries(capacity);
+    _entries.swap(entries);
+    _size = 0;
+    if (removeMarked)
+        _markedCount = 0;
+
+    for (unsigned int i = 0, count = entries.size(); i < count; ++i)
+    {
+        Entry& entry = entries[i];
+        if (!entry.used || (removeMarked && (entry.info._status & REMOVE) != 0))
+            continue;
+
+        Entry& slot = _entries[findSlot(entry.pair.objectA, entry.pair.objectB)];
+        slot.pair = entry.pair;
+        slot.info._listeners.swap(entry.info._listeners);
+        slot.info._status = entry.info._status;
+        slot.used = true;
+        ++_size;
+    }
+}
+
 PhysicsController::Listener::~Listener()
 {
     GP_ASSERT(Game::getInstance()->getPhysicsController());
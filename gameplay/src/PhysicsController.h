@@ -10,6 +10,7 @@
 #include "PhysicsCollisionObject.h"
 #include "MeshBatch.h"
 #include "ScriptTarget.h"
+#include "ThreadPool.h"
 
 namespace gameplay
 {
@@ -285,6 +286,85 @@ public:
      */
     void setGravity(const Vector3& gravity);
 
+    /**
+     * Gets the duration of a simulation step.
+     *
+     * @return The fixed time step, in milliseconds.
+     */
+    float getFixedTimeStep() const;
+
+    /**
+     * Sets the duration of a simulation step.
+     *
+     * Each update advances the simulation by as many fixed steps as fit in the elapsed
+     * time, carrying the remainder over to the next update, so the simulation does not
+     * depend on the frame rate. Node transforms are set from Bullet's interpolated
+     * motion states, which predict the remainder, so they move smoothly between steps.
+     *
+     * The default is 1000/60 milliseconds, and can be set by the fixedTimeStep property
+     * of the physics namespace in game.config.
+     *
+     * @param milliseconds The fixed time step, in milliseconds.
+     */
+    void setFixedTimeStep(float milliseconds);
+
+    /**
+     * Gets the maximum number of simulation steps performed in an update.
+     *
+     * @return The maximum number of steps.
+     */
+    unsigned int getMaxSubsteps() const;
+
+    /**
+     * Sets the maximum number of simulation steps performed in an update.
+     *
+     * When an update would need more steps, the extra time is dropped (and the simulation
+     * runs slower than real time), so that a slow frame cannot make the next frames ever
+     * slower. Zero steps the simulation once per update by the elapsed time instead,
+     * which is neither deterministic nor interpolated.
+     *
+     * The default is 10, and can be set by the maxSubsteps property of the physics
+     * namespace in game.config.
+     *
+     * @param maxSubsteps The maximum number of steps.
+     */
+    void setMaxSubsteps(unsigned int maxSubsteps);
+
+    /**
+     * Gets the number of simulation steps performed by the last update.
+     *
+     * @return The number of steps.
+     */
+    unsigned int getSubstepCount() const;
+
+    /**
+     * Gets the number of simulation steps that the last update dropped because they
+     * exceeded the maximum number of steps.
+     *
+     * A non-zero count on consecutive frames means the simulation cannot keep up with
+     * real time at the current time step.
+     *
+     * @return The number of dropped steps.
+     */
+    unsigned int getDroppedSubstepCount() const;
+
+    /**
+     * Gets the number of threads that run the collision detection of the simulation.
+     *
+     * Physics runs on the calling thread only by default. Setting the threads property
+     * of the physics namespace in game.config to more than 1 enables the multithreaded
+     * mode, in which only the contacts of colliding pairs of convex bodies are computed
+     * in parallel. Physics then uses up to that many threads of the engine's shared pool
+     * (see Game::getThreadPool()), including the calling thread, so the count is also
+     * limited by the size of that pool. Constraints are still solved on the calling thread, as are contacts
+     * with mesh, heightfield and compound bodies, so scenes dominated by those gain little.
+     * The results do not depend on the number of threads, but they differ slightly
+     * from those of the single-threaded mode.
+     *
+     * @return The number of threads, including the calling thread.
+     */
+    unsigned int getThreadCount() const;
+
     /**
      * Draws debugging information (rigid body outlines, etc.) using the given view projection matrix.
      * 
@@ -307,6 +387,26 @@ public:
      */
     bool rayTest(const Ray& ray, float distance, PhysicsController::HitResult* result = NULL, PhysicsController::HitFilter* filter = NULL);
 
+    /**
+     * Performs a batch of ray tests on the physics world.
+     *
+     * This is equivalent to calling rayTest() for each ray, but the broadphase traversal
+     * storage and result callback are shared by the rays of the batch, and when physics
+     * runs on several threads (see getThreadCount()) the rays are split between them.
+     * In that case the filter may be called from several threads at once.
+     *
+     * @param rays The rays to test intersection with.
+     * @param count The number of rays.
+     * @param distance How far along each ray to test for intersections.
+     * @param results The array of count hit results to store the result of each ray in.
+     *      The object of the result of a ray that hit nothing is NULL.
+     * @param filter Optional filter pointer used to control which objects are tested.
+     *
+     * @return The number of rays that collided with a physics object.
+     */
+    unsigned int rayTestBatch(const Ray* rays, unsigned int count, float distance, PhysicsController::HitResult* results,
+                              PhysicsController::HitFilter* filter = NULL);
+
     /**
      * Performs a sweep test of the given collision object on the physics world.
      *
@@ -325,36 +425,120 @@ public:
      */
     bool sweepTest(PhysicsCollisionObject* object, const Vector3& endPosition, PhysicsController::HitResult* result = NULL, PhysicsController::HitFilter* filter = NULL);
 
+    /**
+     * Performs a batch of sweep tests on the physics world.
+     *
+     * This is equivalent to calling sweepTest() for each object, but the result callback
+     * is shared by the sweeps of the batch. When physics runs on several threads (see
+     * getThreadCount()) and Bullet is built without its profiler (BT_NO_PROFILE), the
+     * sweeps are split between them, and the filter may be called from several threads at once.
+     *
+     * @param objects The collision objects to test.
+     * @param endPositions The end positions of the sweep tests, in world space.
+     * @param count The number of objects.
+     * @param results The array of count hit results to store the result of each sweep in.
+     *      The object of the result of a sweep that hit nothing (or of an object whose
+     *      shape cannot be swept) is NULL.
+     * @param filter Optional filter pointer used to control which objects are tested.
+     *
+     * @return The number of objects that intersect other physics objects.
+     */
+    unsigned int sweepTestBatch(PhysicsCollisionObject* const* objects, const Vector3* endPositions, unsigned int count,
+                                PhysicsController::HitResult* results, PhysicsController::HitFilter* filter = NULL);
+
 private:
 
+    // Internal constants for the collision status cache.
+    static const int DIRTY;
+    static const int COLLISION;
+    static const int REGISTERED;
+    static const int REMOVE;
+
     /**
-     * Internal class used to integrate with Bullet collision callbacks.
+     * Collision configuration of the multithreaded mode, whose convex collision
+     * algorithms each own the simplex solver that the default ones share.
      */
-    class CollisionCallback : public btCollisionWorld::ContactResultCallback
+    class ParallelCollisionConfiguration : public btDefaultCollisionConfiguration
     {
     public:
-        /**
-         * Constructor.
-         * 
-         * @param pc The physics controller that owns the callback.
-         */
-        CollisionCallback(PhysicsController* pc) : _pc(pc) {}
 
-    protected:
-        /**
-            * Internal function used for Bullet integration (do not use or override).
-            */
-        btScalar addSingleResult(btManifoldPoint& cp, const btCollisionObject* a, int partIdA, int indexA, const btCollisionObject* b, int partIdB, int indexB);    
+        ParallelCollisionConfiguration();
+        ~ParallelCollisionConfiguration();
+
+        btCollisionAlgorithmCreateFunc* getCollisionAlgorithmCreateFunc(int proxyType0, int proxyType1);
 
     private:
-        PhysicsController* _pc;
+
+        class ConvexConvexAlgorithm : public btConvexConvexAlgorithm
+        {
+        public:
+            ConvexConvexAlgorithm(btPersistentManifold* manifold, const btCollisionAlgorithmConstructionInfo& ci, btCollisionObject* body0, btCollisionObject* body1,
+                                  btConvexPenetrationDepthSolver* pdSolver, int numPerturbationIterations, int minimumPointsPerturbationThreshold);
+        private:
+            btVoronoiSimplexSolver _simplexSolver;
+        };
+
+        struct ConvexConvexCreateFunc : public btCollisionAlgorithmCreateFunc
+        {
+            ConvexConvexCreateFunc(const btConvexConvexAlgorithm::CreateFunc* defaultFunc);
+            btCollisionAlgorithm* CreateCollisionAlgorithm(btCollisionAlgorithmConstructionInfo& ci, btCollisionObject* body0, btCollisionObject* body1);
+
+            btConvexPenetrationDepthSolver* _pdSolver;
+            int _numPerturbationIterations;
+            int _minimumPointsPerturbationThreshold;
+        };
+
+        static btDefaultCollisionConstructionInfo constructionInfo();
+
+        ConvexConvexCreateFunc* _convexConvexCreateFunc;
     };
 
-    // Internal constants for the collision status cache.
-    static const int DIRTY;
-    static const int COLLISION;
-    static const int REGISTERED;
-    static const int REMOVE;
+    /**
+     * Collision dispatcher of the multithreaded mode, which computes the contacts of
+     * the overlapping pairs of convex bodies in parallel.
+     *
+     * Pairs that involve a concave (mesh, heightfield) or compound body are processed on
+     * the calling thread, because Bullet temporarily swaps the shape and transform of
+     * such a body while colliding it. While the other pairs run, collision algorithms
+     * are created and manifolds are allocated under a lock. Manifolds are sorted by the
+     * bodies they connect after each dispatch, so that the solver sees them in the same
+     * order whichever thread created them.
+     */
+    class ParallelDispatcher : public btCollisionDispatcher
+    {
+    public:
+
+        ParallelDispatcher(btCollisionConfiguration* collisionConfiguration, ThreadPool* threadPool, unsigned int threadCount);
+        ~ParallelDispatcher();
+
+        btCollisionAlgorithm* findAlgorithm(btCollisionObject* body0, btCollisionObject* body1, btPersistentManifold* sharedManifold = 0);
+        btPersistentManifold* getNewManifold(void* body0, void* body1);
+        void releaseManifold(btPersistentManifold* manifold);
+        void* allocateCollisionAlgorithm(int size);
+        void freeCollisionAlgorithm(void* ptr);
+        void dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& dispatchInfo, btDispatcher* dispatcher);
+
+    private:
+
+        static void dispatchPairs(unsigned int begin, unsigned int end, void* cookie);
+        static bool isSharedShape(const btCollisionShape* shape);
+        static bool compareManifolds(const btPersistentManifold* m1, const btPersistentManifold* m2);
+
+        void lock();
+        void unlock();
+
+        ThreadPool* _threadPool;
+        unsigned int _threadCount;
+        std::vector<btBroadphasePair*> _parallelPairs;
+        std::vector<btBroadphasePair*> _serialPairs;
+        const btDispatcherInfo* _dispatchInfo;
+        bool _parallel;
+#ifdef WIN32
+        CRITICAL_SECTION _mutex;
+#else
+        pthread_mutex_t _mutex;
+#endif
+    };
 
     // Represents the collision listeners and status for a given collision pair (used by the collision status cache).
     struct CollisionInfo
@@ -365,6 +549,76 @@ private:
         int _status;
     };
 
+    /**
+     * The collision status cache: an open addressing hash table of collision infos,
+     * keyed by unordered pairs of collision objects.
+     *
+     * Entries are only marked for removal while the controller updates, and are
+     * removed by removeMarked() at the start of the next update.
+     */
+    class CollisionStatusTable
+    {
+    public:
+
+        /**
+         * An entry of the table.
+         */
+        struct Entry
+        {
+            Entry() : pair(NULL, NULL), used(false) { }
+
+            PhysicsCollisionObject::CollisionPair pair;
+            CollisionInfo info;
+            bool used;
+        };
+
+        /**
+         * Constructor.
+         */
+        CollisionStatusTable();
+
+        /**
+         * Returns the entry of the given pair (in either order), or NULL if there is none.
+         */
+        Entry* find(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB);
+
+        /**
+         * Returns the entry of the given pair, adding it if there is none.
+         * Adding an entry invalidates the pointers to other entries.
+         */
+        Entry& insert(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB);
+
+        /**
+         * Marks the entry of the given pair for removal, if there is one.
+         */
+        void markForRemoval(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB);
+
+        /**
+         * Marks all entries that refer to the given object for removal.
+         */
+        void markForRemoval(PhysicsCollisionObject* object);
+
+        /**
+         * Removes the entries that were marked for removal.
+         */
+        void removeMarked();
+
+        /**
+         * Returns the number of entries in the table.
+         */
+        unsigned int size() const;
+
+    private:
+
+        static unsigned int hash(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB);
+        unsigned int findSlot(PhysicsCollisionObject* objectA, PhysicsCollisionObject* objectB) const;
+        void rehash(unsigned int capacity, bool removeMarked);
+
+        std::vector<Entry> _entries;
+        unsigned int _size;
+        unsigned int _markedCount;
+    };
+
     /**
      * Constructor.
      */
@@ -415,6 +669,9 @@ private:
     // Gets the corresponding GamePlay object for the given Bullet object.
     PhysicsCollisionObject* getCollisionObject(const btCollisionObject* collisionObject) const;
 
+    // Updates the collision status cache from the contact manifolds of the last step and fires the collision events.
+    void updateCollisionStatus();
+
     // Creates a collision shape for the given node and gameplay shape definition.
     // Populates 'centerOfMassOffset' with the correct calculated center of mass offset.
     PhysicsCollisionShape* createShape(Node* node, const PhysicsCollisionShape::Definition& shape, Vector3* centerOfMassOffset);
@@ -548,8 +805,15 @@ private:
     Listener::EventType _status;
     std::vector<Listener*>* _listeners;
     Vector3 _gravity;
-    std::map<PhysicsCollisionObject::CollisionPair, CollisionInfo> _collisionStatus;
-    CollisionCallback* _collisionCallback;
+    float _fixedTimeStep;
+    unsigned int _maxSubsteps;
+    unsigned int _substepCount;
+    unsigned int _droppedSubstepCount;
+    unsigned int _threadCount;
+    ThreadPool* _threadPool;
+    CollisionStatusTable _collisionStatus;
+    std::vector<PhysicsCollisionObject::CollisionPair> _collidingPairs;
+    std::vector<PhysicsCollisionObject::CollisionPair> _nextCollidingPairs;
 };
 
 }
@@ -0,0 +1,196 @@
+#include "Base.h"
+#include "RenderQueue.h"
+#include "Node.h"
+
+// Sort key layout (most significant bits first):
+//   opaque:      layer(1) | effect(12) | texture(12) | depth(24)
+//   transparent: layer(1) | inverted depth(24) | effect(12) | texture(12)
+#define SORT_KEY_LAYER_SHIFT 63
+#define SORT_KEY_ID_BITS 12
+#define SORT_KEY_ID_MASK ((1ull << SORT_KEY_ID_BITS) - 1)
+#define SORT_KEY_DEPTH_BITS 24
+#define SORT_KEY_DEPTH_MAX ((1u << SORT_KEY_DEPTH_BITS) - 1)
+
+namespace gameplay
+{
+
+RenderQueue::RenderQueue(unsigned int initialCapacity)
+{
+    _items.reserve(initialCapacity);
+    memset(&_statistics, 0, sizeof(_statistics));
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+RenderQueue* RenderQueue::create(unsigned int initialCapacity)
+{
+    return new RenderQueue(initialCapacity);
+}
+
+unsigned long long RenderQueue::makeSortKey(Layer layer, unsigned int effectId, unsigned int textureId, float depth)
+{
+    // Quantize the depth (the negated comparison also maps NaN to zero).
+    unsigned long long quantizedDepth = 0;
+    if (!(depth <= 0.0f))
+    {
+        quantizedDepth = depth >= 1.0f ? SORT_KEY_DEPTH_MAX : (unsigned long long)(depth * SORT_KEY_DEPTH_MAX);
+    }
+
+    unsigned long long effect = effectId & SORT_KEY_ID_MASK;
+    unsigned long long texture = textureId & SORT_KEY_ID_MASK;
+
+    if (layer == LAYER_TRANSPARENT)
+    {
+        // Back to front, so that blending composites correctly.
+        return (1ull << SORT_KEY_LAYER_SHIFT) |
+               ((SORT_KEY_DEPTH_MAX - quantizedDepth) << (SORT_KEY_LAYER_SHIFT - SORT_KEY_DEPTH_BITS)) |
+               (effect << (SORT_KEY_LAYER_SHIFT - SORT_KEY_DEPTH_BITS - SORT_KEY_ID_BITS)) |
+               (texture << (SORT_KEY_LAYER_SHIFT - SORT_KEY_DEPTH_BITS - 2 * SORT_KEY_ID_BITS));
+    }
+
+    // Grouped by state first, then front to back to reduce overdraw.
+    return (effect << (SORT_KEY_LAYER_SHIFT - SORT_KEY_ID_BITS)) |
+           (texture << (SORT_KEY_LAYER_SHIFT - 2 * SORT_KEY_ID_BITS)) |
+           (quantizedDepth << (SORT_KEY_LAYER_SHIFT - 2 * SORT_KEY_ID_BITS - SORT_KEY_DEPTH_BITS));
+}
+
+void RenderQueue::add(Model* model, Camera* camera)
+{
+    GP_ASSERT(model);
+
+    Mesh* mesh = model->getMesh();
+    GP_ASSERT(mesh);
+
+    // Skins deformed on the CPU are brought up to date before any of their items are drawn.
+    MeshSkin* skin = model->getSkin();
+    if (skin && skin->isCpuSkinning())
+    {
+        skin->updateSkinnedVertices();
+    }
+
+    Node* node = model->getNode();
+    Layer layer = (node && node->isTransparent()) ? LAYER_TRANSPARENT : LAYER_OPAQUE;
+
+    float depth = 0.0f;
+    if (camera && node)
+    {
+        // View space looks down -z, so the depth of the bounds center is its negated z.
+        const Vector3& center = node->getBoundingSphere().center;
+        const Matrix& view = camera->getViewMatrix();
+        float z = view.m[2] * center.x + view.m[6] * center.y + view.m[10] * center.z + view.m[14];
+        depth = -z / camera->getFarPlane();
+    }
+
+    unsigned int partCount = mesh->getPartCount();
+    if (partCount == 0)
+    {
+        Material* material = model->getMaterial();
+        if (material)
+        {
+            addItems(model, NULL, material, layer, depth);
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < partCount; ++i)
+        {
+            Material* material = model->getMaterial(i);
+            if (material)
+            {
+                addItems(model, mesh->getPart(i), material, layer, depth);
+            }
+        }
+    }
+}
+
+void RenderQueue::addItems(Model* model, MeshPart* part, Material* material, Layer layer, float depth)
+{
+    Technique* technique = material->getTechnique();
+    GP_ASSERT(technique);
+
+    for (unsigned int i = 0, passCount = technique->getPassCount(); i < passCount; ++i)
+    {
+        Pass* pass = technique->getPassByIndex(i);
+        GP_ASSERT(pass);
+        GP_ASSERT(pass->getEffect());
+
+        Texture* texture = pass->getFirstTexture();
+
+        Item item;
+        item.key = makeSortKey(layer, pass->getEffect()->_program, texture ? (unsigned int)texture->getHandle() : 0, depth);
+        item.model = model;
+        item.part = part;
+        item.pass = pass;
+        _items.push_back(item);
+    }
+}
+
+void RenderQueue::clear()
+{
+    _items.clear();
+}
+
+unsigned int RenderQueue::getItemCount() const
+{
+    return _items.size();
+}
+
+bool RenderQueue::compareItems(const Item& i1, const Item& i2)
+{
+    return i1.key < i2.key;
+}
+
+void RenderQueue::draw(bool wireframe)
+{
+    memset(&_statistics, 0, sizeof(_statistics));
+
+    std::stable_sort(_items.begin(), _items.end(), compareItems);
+
+    Pass* boundPass = NULL;
+    for (unsigned int i = 0, count = _items.size(); i < count; ++i)
+    {
+        const Item& item = _items[i];
+
+        // Passes own their parameter bindings and vertex attribute binding, so consecutive
+        // items drawn with the same pass (such as the parts of one model) only differ by
+        // their index buffer.
+        if (item.pass != boundPass)
+        {
+            if (boundPass)
+            {
+                boundPass->unbind();
+            }
+
+            if (item.pass->getEffect() == Effect::getCurrentEffect())
+                ++_statistics.effectBindsSkipped;
+            else
+                ++_statistics.effectBinds;
+
+            item.pass->bind();
+            boundPass = item.pass;
+            ++_statistics.passBinds;
+        }
+        else
+        {
+            ++_statistics.effectBindsSkipped;
+            ++_statistics.passBindsSkipped;
+        }
+
+        item.model->drawPart(item.part, wireframe);
+        ++_statistics.drawCalls;
+    }
+
+    if (boundPass)
+    {
+        boundPass->unbind();
+    }
+}
+
+const RenderQueue::Statistics& RenderQueue::getStatistics() const
+{
+    return _statistics;
+}
+
+}
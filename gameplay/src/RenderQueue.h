@@ -0,0 +1,179 @@
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#include "Model.h"
+#include "Camera.h"
+
+namespace gameplay
+{
+
+/**
+ * Defines a queue of draw items that are sorted by render state before they are submitted.
+ *
+ * Models are added to the queue while the scene is being culled (for example, from
+ * the results of Scene::queryFrustum). Each mesh part and technique pass of a model
+ * becomes one draw item with a 64-bit sort key. When the queue is drawn the items
+ * are sorted so that opaque items are grouped by effect and texture (nearest first),
+ * followed by transparent items drawn back to front. Consecutive items that share an
+ * effect or a pass skip the redundant program and render state binds.
+ */
+class RenderQueue
+{
+public:
+
+    /**
+     * Defines the layers that draw items are sorted into.
+     */
+    enum Layer
+    {
+        LAYER_OPAQUE = 0,
+        LAYER_TRANSPARENT = 1
+    };
+
+    /**
+     * Defines the counters gathered while drawing the queue.
+     */
+    struct Statistics
+    {
+        /**
+         * The number of draw calls issued.
+         */
+        unsigned int drawCalls;
+
+        /**
+         * The number of effects bound.
+         */
+        unsigned int effectBinds;
+
+        /**
+         * The number of effect binds skipped because the effect was already bound.
+         */
+        unsigned int effectBindsSkipped;
+
+        /**
+         * The number of passes bound (render state and parameters).
+         */
+        unsigned int passBinds;
+
+        /**
+         * The number of pass binds skipped because the pass was already bound.
+         */
+        unsigned int passBindsSkipped;
+    };
+
+    /**
+     * Creates a new render queue.
+     *
+     * @param initialCapacity The initial capacity of the queue, in draw items.
+     *
+     * @return A new render queue.
+     */
+    static RenderQueue* create(unsigned int initialCapacity = 256);
+
+    /**
+     * Destructor.
+     */
+    ~RenderQueue();
+
+    /**
+     * Builds a sort key for a draw item.
+     *
+     * Opaque keys order items by effect, then texture, then depth front to back.
+     * Transparent keys are always greater than opaque keys and order items by depth
+     * back to front, then effect and texture. Only the low bits of the effect and
+     * texture identifiers are used.
+     *
+     * @param layer The layer of the draw item.
+     * @param effectId The identifier of the effect (program) used to draw the item.
+     * @param textureId The identifier of the main texture used to draw the item.
+     * @param depth The view depth of the item, normalized to [0, 1] (clamped).
+     *
+     * @return The sort key.
+     */
+    static unsigned long long makeSortKey(Layer layer, unsigned int effectId, unsigned int textureId, float depth);
+
+    /**
+     * Adds draw items for each mesh part and technique pass of the specified model.
+     *
+     * The model's node determines the layer (see Node::isTransparent) and, when a
+     * camera is given, the depth of its items.
+     *
+     * @param model The model to add.
+     * @param camera The camera used to compute depth, or NULL to ignore depth.
+     */
+    void add(Model* model, Camera* camera = NULL);
+
+    /**
+     * Removes all draw items from the queue.
+     */
+    void clear();
+
+    /**
+     * Returns the number of draw items in the queue.
+     *
+     * @return The number of draw items.
+     */
+    unsigned int getItemCount() const;
+
+    /**
+     * Sorts the draw items and draws them.
+     *
+     * The items are kept in the queue, so the queue must be cleared before it is
+     * filled for the next frame.
+     *
+     * @param wireframe If true, draw the items in wireframe mode.
+     */
+    void draw(bool wireframe = false);
+
+    /**
+     * Returns the counters gathered by the last call to draw().
+     *
+     * @return The draw statistics.
+     */
+    const Statistics& getStatistics() const;
+
+private:
+
+    /**
+     * A single draw call: a mesh part of a model drawn with one pass.
+     */
+    struct Item
+    {
+        unsigned long long key;
+        Model* model;
+        MeshPart* part;
+        Pass* pass;
+    };
+
+    /**
+     * Constructor.
+     */
+    RenderQueue(unsigned int initialCapacity);
+
+    /**
+     * Hidden copy constructor.
+     */
+    RenderQueue(const RenderQueue& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    RenderQueue& operator=(const RenderQueue&);
+
+    /**
+     * Adds draw items for each pass of the given material.
+     */
+    void addItems(Model* model, MeshPart* part, Material* material, Layer layer, float depth);
+
+    /**
+     * Orders draw items by sort key, keeping the insertion order of equal keys.
+     */
+    static bool compareItems(const Item& i1, const Item& i2);
+
+    std::vector<Item> _items;
+    Statistics _statistics;
+};
+
+}
+
+#endif
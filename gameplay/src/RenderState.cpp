@@ -12,6 +12,9 @@
 #define RS_DEPTH_TEST 8
 #define RS_DEPTH_WRITE 16
 
+// Depth of a RenderState hierarchy (Material, Technique, Pass) that bind() handles without allocating
+#define RS_MAX_HIERARCHY_DEPTH 3
+
 namespace gameplay
 {
 
@@ -50,23 +53,63 @@ MaterialParameter* RenderState::getParameter(const char* name) const
 {
     GP_ASSERT(name);
 
-    // Search for an existing parameter with this name.
-    MaterialParameter* param;
+    // Names not declared by any loaded effect have no identifier (and are not
+    // interned), so parameters for them are matched by name.
+    MaterialParameter* param = NULL;
+    unsigned int id;
+    if (Effect::findUniformId(name, &id))
+    {
+        param = findParameter(id);
+    }
+    else
+    {
+        for (unsigned int i = 0, count = _parameters.size(); i < count; ++i)
+        {
+            GP_ASSERT(_parameters[i]);
+            if (_parameters[i]->_name == name)
+            {
+                param = _parameters[i];
+                break;
+            }
+        }
+    }
+    if (param == NULL)
+    {
+        // Create a new parameter and store it in our list.
+        param = new MaterialParameter(name);
+        _parameters.push_back(param);
+    }
+
+    return param;
+}
+
+MaterialParameter* RenderState::getParameterById(unsigned int id) const
+{
+    MaterialParameter* param = findParameter(id);
+    if (param == NULL)
+    {
+        // Interned identifiers always map back to a name.
+        param = new MaterialParameter(Effect::getUniformName(id));
+        _parameters.push_back(param);
+    }
+
+    return param;
+}
+
+MaterialParameter* RenderState::findParameter(unsigned int id) const
+{
+    // Search for an existing parameter with this name identifier.
     for (unsigned int i = 0, count = _parameters.size(); i < count; ++i)
     {
-        param = _parameters[i];
+        MaterialParameter* param = _parameters[i];
         GP_ASSERT(param);
-        if (strcmp(param->getName(), name) == 0)
+        if (param->getId() == id)
         {
             return param;
         }
     }
 
-    // Create a new parameter and store it in our list.
-    param = new MaterialParameter(name);
-    _parameters.push_back(param);
-
-    return param;
+    return NULL;
 }
 
 void RenderState::setParameterAutoBinding(const char* name, AutoBinding autoBinding)
@@ -275,26 +318,39 @@ void RenderState::bind(Pass* pass)
 {
     GP_ASSERT(pass);
 
-    // Get the combined modified state bits for our RenderState hierarchy.
-    long stateOverrideBits = _state ? _state->_bits : 0;
-    RenderState* rs = _parent;
-    while (rs)
+    // Collect our RenderState hierarchy and its combined modified state bits in a single walk.
+    // Levels beyond the usual Material, Technique, Pass depth spill into a vector.
+    RenderState* hierarchy[RS_MAX_HIERARCHY_DEPTH];
+    std::vector<RenderState*> deepHierarchy;
+    unsigned int depth = 0;
+    long stateOverrideBits = 0;
+    for (RenderState* rs = this; rs != NULL; rs = rs->_parent)
     {
+        if (depth < RS_MAX_HIERARCHY_DEPTH)
+        {
+            hierarchy[depth] = rs;
+        }
+        else
+        {
+            deepHierarchy.push_back(rs);
+        }
+        ++depth;
+
         if (rs->_state)
         {
             stateOverrideBits |= rs->_state->_bits;
         }
-        rs = rs->_parent;
     }
 
     // Restore renderer state to its default, except for explicitly specified states
     StateBlock::restore(stateOverrideBits);
 
     // Apply parameter bindings and renderer state for the entire hierarchy, top-down.
-    rs = NULL;
     Effect* effect = pass->getEffect();
-    while ((rs = getTopmost(rs)))
+    while (depth > 0)
     {
+        --depth;
+        RenderState* rs = depth < RS_MAX_HIERARCHY_DEPTH ? hierarchy[depth] : deepHierarchy[depth - RS_MAX_HIERARCHY_DEPTH];
         for (unsigned int i = 0, count = rs->_parameters.size(); i < count; ++i)
         {
             GP_ASSERT(rs->_parameters[i]);
@@ -308,23 +364,19 @@ void RenderState::bind(Pass* pass)
     }
 }
 
-RenderState* RenderState::getTopmost(RenderState* below)
+Texture* RenderState::getFirstTexture() const
 {
-    RenderState* rs = this;
-    if (rs == below)
+    for (const RenderState* rs = this; rs != NULL; rs = rs->_parent)
     {
-        // Nothing below ourself.
-        return NULL;
-    }
-
-    while (rs)
-    {
-        if (rs->_parent == below || rs->_parent == NULL)
+        for (unsigned int i = 0, count = rs->_parameters.size(); i < count; ++i)
         {
-            // Stop traversing up here.
-            return rs;
+            const MaterialParameter* param = rs->_parameters[i];
+            GP_ASSERT(param);
+            if (param->_type == MaterialParameter::SAMPLER && param->_value.samplerValue)
+            {
+                return param->_value.samplerValue->getTexture();
+            }
         }
-        rs = rs->_parent;
     }
 
     return NULL;
@@ -10,6 +10,7 @@ class MaterialParameter;
 class Node;
 class NodeCloneContext;
 class Pass;
+class Texture;
 
 /**
  * Defines the render state of the graphics device.
@@ -21,6 +22,7 @@ class RenderState : public Ref
     friend class Technique;
     friend class Pass;
     friend class Model;
+    friend class RenderQueue;
 
 public:
 
@@ -237,6 +239,18 @@ public:
      */
     MaterialParameter* getParameter(const char* name) const;
 
+    /**
+     * Returns a MaterialParameter for the specified name identifier.
+     *
+     * This is equivalent to getParameter(const char*), but avoids string
+     * comparisons in code that runs every frame.
+     *
+     * @param id The identifier of the parameter (uniform) name, as returned by Effect::getUniformId.
+     *
+     * @return A MaterialParameter for the specified name identifier.
+     */
+    MaterialParameter* getParameterById(unsigned int id) const;
+
     /**
      * Sets a material parameter auto-binding.
      *
@@ -331,9 +345,15 @@ protected:
     void bind(Pass* pass);
 
     /**
-     * Returns the topmost RenderState in the hierarchy below the given RenderState.
+     * Returns the texture of the first sampler parameter found in this RenderState
+     * or its parents, or NULL if there is none.
+     */
+    Texture* getFirstTexture() const;
+
+    /**
+     * Returns the existing parameter with the specified name identifier, or NULL.
      */
-    RenderState* getTopmost(RenderState* below);
+    MaterialParameter* findParameter(unsigned int id) const;
 
     /**
      * Copies the data from this RenderState into the given RenderState.
@@ -8,7 +8,8 @@
 namespace gameplay
 {
 
-Scene::Scene() : _activeCamera(NULL), _firstNode(NULL), _lastNode(NULL), _nodeCount(0), _bindAudioListenerToCamera(true), _debugBatch(NULL)
+Scene::Scene() : _activeCamera(NULL), _firstNode(NULL), _lastNode(NULL), _nodeCount(0), _bindAudioListenerToCamera(true), _debugBatch(NULL),
+    _transformHierarchyDirty(true)
 {
 }
 
@@ -165,6 +166,10 @@ void Scene::addNode(Node* node)
 
     ++_nodeCount;
 
+    addToSpatialIndex(node);
+
+    _transformHierarchyDirty = true;
+
     // If we don't have an active camera set, then check for one and set it.
     if (_activeCamera == NULL)
     {
@@ -198,6 +203,8 @@ void Scene::removeNode(Node* node)
     SAFE_RELEASE(node);
 
     --_nodeCount;
+
+    _transformHierarchyDirty = true;
 }
 
 void Scene::removeAllNodes()
@@ -278,6 +285,179 @@ void Scene::setAmbientColor(float red, float green, float blue)
     _ambientColor.set(red, green, blue);
 }
 
+void Scene::updateTransforms()
+{
+    if (_transformHierarchyDirty)
+    {
+        _transformNodes.clear();
+        _transformParents.clear();
+        for (Node* node = getFirstNode(); node != NULL; node = node->getNextSibling())
+        {
+            flattenTransformHierarchy(node, -1);
+        }
+        _transformHierarchyDirty = false;
+    }
+
+    // Parents always precede their children in the array, so every parent
+    // world matrix is already resolved by the time its children are reached.
+    for (unsigned int i = 0, count = _transformNodes.size(); i < count; ++i)
+    {
+        int parentIndex = _transformParents[i];
+        _transformNodes[i]->updateWorldMatrix(parentIndex >= 0 ? &_transformNodes[parentIndex]->_world : NULL);
+    }
+
+    if (_activeCamera)
+    {
+        for (unsigned int i = 0, count = _transformNodes.size(); i < count; ++i)
+        {
+            if (_transformNodes[i]->_model)
+            {
+                _transformNodes[i]->updateViewMatrices();
+            }
+        }
+    }
+
+    updateSpatialIndex();
+}
+
+void Scene::flattenTransformHierarchy(Node* node, int parentIndex)
+{
+    GP_ASSERT(node);
+
+    int index = (int)_transformNodes.size();
+    _transformNodes.push_back(node);
+    _transformParents.push_back(parentIndex);
+
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        flattenTransformHierarchy(child, index);
+    }
+}
+
+void Scene::addToSpatialIndex(Node* node)
+{
+    GP_ASSERT(node);
+
+    updateSpatialProxy(node);
+
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        addToSpatialIndex(child);
+    }
+}
+
+void Scene::removeFromSpatialIndex(Node* node)
+{
+    GP_ASSERT(node);
+
+    if (node->_spatialProxy != BoundingVolumeTree::NULL_PROXY)
+    {
+        // Any queued update for the proxy is skipped once it is destroyed.
+        _spatialIndex.destroyProxy(node->_spatialProxy);
+        node->_spatialProxy = BoundingVolumeTree::NULL_PROXY;
+        node->_spatialProxyDirty = false;
+    }
+
+    for (Node* child = node->getFirstChild(); child != NULL; child = child->getNextSibling())
+    {
+        removeFromSpatialIndex(child);
+    }
+}
+
+void Scene::updateSpatialProxy(Node* node)
+{
+    GP_ASSERT(node);
+
+    if (node->_model && node->_spatialProxy == BoundingVolumeTree::NULL_PROXY)
+    {
+        BoundingBox box;
+        box.set(node->getBoundingSphere());
+        node->_spatialProxy = _spatialIndex.createProxy(box, node);
+        node->_spatialProxyDirty = false;
+    }
+    else if (!node->_model && node->_spatialProxy != BoundingVolumeTree::NULL_PROXY)
+    {
+        _spatialIndex.destroyProxy(node->_spatialProxy);
+        node->_spatialProxy = BoundingVolumeTree::NULL_PROXY;
+        node->_spatialProxyDirty = false;
+    }
+}
+
+void Scene::updateSpatialIndex()
+{
+    BoundingBox box;
+    for (unsigned int i = 0, count = _spatialDirtyProxies.size(); i < count; ++i)
+    {
+        // Skip proxies that were destroyed after being queued. If the proxy has since been
+        // reused, its new node is only refreshed if it was queued itself.
+        int proxy = _spatialDirtyProxies[i];
+        if (!_spatialIndex.isProxy(proxy))
+            continue;
+
+        Node* node = static_cast<Node*>(_spatialIndex.getUserData(proxy));
+        if (!node->_spatialProxyDirty)
+            continue;
+
+        node->_spatialProxyDirty = false;
+        box.set(node->getBoundingSphere());
+        _spatialIndex.moveProxy(proxy, box);
+    }
+    _spatialDirtyProxies.clear();
+}
+
+static bool intersects(const Frustum& frustum, const BoundingSphere& sphere)
+{
+    return frustum.intersects(sphere);
+}
+
+static bool intersects(const Ray& ray, const BoundingSphere& sphere)
+{
+    return ray.intersects(sphere) != Ray::INTERSECTS_NONE;
+}
+
+static bool intersects(const BoundingSphere& volume, const BoundingSphere& sphere)
+{
+    return volume.intersects(sphere);
+}
+
+template <class T>
+unsigned int Scene::collectSpatialQuery(const T& volume, std::vector<Node*>& nodes)
+{
+    updateSpatialIndex();
+
+    _spatialQueryProxies.clear();
+    _spatialIndex.query(volume, _spatialQueryProxies);
+
+    // The tree tests the enlarged boxes of the proxies, so finish with the node bounds.
+    unsigned int count = 0;
+    for (unsigned int i = 0, proxyCount = _spatialQueryProxies.size(); i < proxyCount; ++i)
+    {
+        Node* node = static_cast<Node*>(_spatialIndex.getUserData(_spatialQueryProxies[i]));
+        if (intersects(volume, node->getBoundingSphere()))
+        {
+            nodes.push_back(node);
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+unsigned int Scene::queryFrustum(const Frustum& frustum, std::vector<Node*>& nodes)
+{
+    return collectSpatialQuery(frustum, nodes);
+}
+
+unsigned int Scene::queryRay(const Ray& ray, std::vector<Node*>& nodes)
+{
+    return collectSpatialQuery(ray, nodes);
+}
+
+unsigned int Scene::querySphere(const BoundingSphere& sphere, std::vector<Node*>& nodes)
+{
+    return collectSpatialQuery(sphere, nodes);
+}
+
 static Material* createDebugMaterial()
 {
     // Vertex shader for drawing colored lines.
@@ -13,6 +13,8 @@ namespace gameplay
  */
 class Scene : public Ref
 {
+    friend class Node;
+
 public:
 
     /**
@@ -160,6 +162,57 @@ public:
      */
     void setAmbientColor(float red, float green, float blue);
 
+    /**
+     * Resolves the world matrices of all nodes in the scene in a single pass.
+     *
+     * The scene keeps its node hierarchy flattened into a depth-first array
+     * of nodes and parent indices, so this is one sequential sweep that only
+     * recomputes the nodes whose transforms changed since their world matrix
+     * was last resolved. Call this once per frame after updating transforms
+     * and before drawing; Node::getWorldMatrix() then returns the cached
+     * result without walking the hierarchy.
+     *
+     * The world view, world view projection, inverse transpose world and
+     * inverse transpose world view matrices of nodes with a model are also
+     * resolved for the active camera, so reading them afterwards (for example
+     * while building render lists on several threads) does not modify the nodes.
+     */
+    void updateTransforms();
+
+    /**
+     * Finds all nodes with a model whose bounding sphere intersects the specified frustum.
+     *
+     * Nodes are looked up through the scene's spatial index, so the cost of the
+     * query depends on the number of nodes near the frustum rather than the
+     * number of nodes in the scene.
+     *
+     * @param frustum The frustum to test against (for example, the active camera's frustum).
+     * @param nodes A list of nodes to be populated with the matches.
+     *
+     * @return The number of matches found.
+     */
+    unsigned int queryFrustum(const Frustum& frustum, std::vector<Node*>& nodes);
+
+    /**
+     * Finds all nodes with a model whose bounding sphere intersects the specified ray.
+     *
+     * @param ray The ray to test against.
+     * @param nodes A list of nodes to be populated with the matches.
+     *
+     * @return The number of matches found.
+     */
+    unsigned int queryRay(const Ray& ray, std::vector<Node*>& nodes);
+
+    /**
+     * Finds all nodes with a model whose bounding sphere intersects the specified sphere.
+     *
+     * @param sphere The sphere to test against.
+     * @param nodes A list of nodes to be populated with the matches.
+     *
+     * @return The number of matches found.
+     */
+    unsigned int querySphere(const BoundingSphere& sphere, std::vector<Node*>& nodes);
+
     /**
      * Visits each node in the scene and calls the specified method pointer.
      *
@@ -254,6 +307,40 @@ private:
      */
     inline bool visitNode(Node* node, const char* visitMethod);
 
+    /**
+     * Appends the given node and all of its children, depth first, to the
+     * flattened transform hierarchy.
+     */
+    void flattenTransformHierarchy(Node* node, int parentIndex);
+
+    /**
+     * Adds the given node and all of its descendants to the spatial index.
+     */
+    void addToSpatialIndex(Node* node);
+
+    /**
+     * Removes the given node and all of its descendants from the spatial index.
+     */
+    void removeFromSpatialIndex(Node* node);
+
+    /**
+     * Adds or removes the spatial index proxy of the given node, depending on
+     * whether it has a model.
+     */
+    void updateSpatialProxy(Node* node);
+
+    /**
+     * Refreshes the spatial index proxies of the nodes that have moved.
+     */
+    void updateSpatialIndex();
+
+    /**
+     * Appends to the list the nodes of the queried proxies whose bounding sphere
+     * passes the exact test, and returns the number appended.
+     */
+    template <class T>
+    unsigned int collectSpatialQuery(const T& volume, std::vector<Node*>& nodes);
+
     std::string _id;
     Camera* _activeCamera;
     Node* _firstNode;
@@ -262,6 +349,12 @@ private:
     Vector3 _ambientColor;
     bool _bindAudioListenerToCamera;
     MeshBatch* _debugBatch;
+    std::vector<Node*> _transformNodes;
+    std::vector<int> _transformParents;
+    bool _transformHierarchyDirty;
+    BoundingVolumeTree _spatialIndex;
+    std::vector<int> _spatialDirtyProxies;
+    std::vector<int> _spatialQueryProxies;
 };
 
 template <class T>
@@ -361,6 +361,41 @@ void SpriteBatch::draw(SpriteBatch::SpriteVertex* vertices, unsigned int vertexC
     _batch->add(vertices, vertexCount, indices, indexCount);
 }
 
+SpriteBatch::SpriteVertex* SpriteBatch::appendQuads(unsigned int quadCount)
+{
+    GP_ASSERT(_batch);
+
+    if (quadCount == 0)
+        return NULL;
+
+    // Every quad but the very first in the batch is joined to the strip by two degenerate indices.
+    unsigned int firstVertex = _batch->_vertexCount;
+    unsigned int indexCount = quadCount * 6 - (firstVertex == 0 ? 2 : 0);
+
+    void* vertices = NULL;
+    unsigned short* indices = NULL;
+    if (!_batch->appendVertices(quadCount * 4, indexCount, &vertices, &indices))
+        return NULL;
+
+    unsigned short v = (unsigned short)firstVertex;
+    for (unsigned int i = 0; i < quadCount; ++i, v += 4)
+    {
+        if (i > 0 || firstVertex > 0)
+        {
+            indices[0] = *(indices - 1);
+            indices[1] = v;
+            indices += 2;
+        }
+        indices[0] = v;
+        indices[1] = v + 1;
+        indices[2] = v + 2;
+        indices[3] = v + 3;
+        indices += 4;
+    }
+
+    return static_cast<SpriteVertex*>(vertices);
+}
+
 void SpriteBatch::draw(float x, float y, float z, float width, float height, float u1, float v1, float u2, float v2, const Vector4& color, bool positionIsCenter)
 {
     // Treat the given position as the center if the user specified it as such.
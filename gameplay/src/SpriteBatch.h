@@ -26,6 +26,7 @@ class SpriteBatch
 {
     friend class Bundle;
     friend class Font;
+    friend class ParticleEmitter;
 
 public:
 
@@ -364,6 +365,18 @@ private:
      */
     void draw(SpriteBatch::SpriteVertex* vertices, unsigned int vertexCount, unsigned short* indices, unsigned int indexCount);
 
+    /**
+     * Appends quads to the batch and returns their vertices, for the caller to fill in.
+     *
+     * The indices are written here. The four vertices of each quad are, in order, the
+     * bottom-left, bottom-right, top-left and top-right corners (a triangle strip).
+     *
+     * @param quadCount The number of quads to append.
+     *
+     * @return The first vertex of the appended quads, or NULL if the batch could not grow.
+     */
+    SpriteBatch::SpriteVertex* appendQuads(unsigned int quadCount);
+
     /**
      * Clip position and size to fit within clip region.
      *
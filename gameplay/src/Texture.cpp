@@ -72,28 +72,12 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
     GP_ASSERT(path);
 
     // Search texture cache first.
-    for (unsigned int i = 0, count = __textureCache.size(); i < count; ++i)
+    Texture* texture = findCached(path, generateMipmaps);
+    if (texture)
     {
-        Texture* t = __textureCache[i];
-        GP_ASSERT(t);
-        if (t->_path == path)
-        {
-            // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the 
-            // texture to generate its mipmap chain if it hasn't already done so.
-            if (generateMipmaps)
-            {
-                t->generateMipmaps();
-            }
-
-            // Found a match.
-            t->addRef();
-
-            return t;
-        }
+        return texture;
     }
 
-    Texture* texture = NULL;
-
     // Filter loading based on file extension.
     const char* ext = strrchr(FileSystem::resolvePath(path), '.');
     if (ext)
@@ -108,15 +92,14 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
                     texture = create(image, generateMipmaps);
                 SAFE_RELEASE(image);
             }
-            else if (tolower(ext[1]) == 'p' && tolower(ext[2]) == 'v' && tolower(ext[3]) == 'r')
-            {
-                // PowerVR Compressed Texture RGBA.
-                texture = createCompressedPVRTC(path);
-            }
-            else if (tolower(ext[1]) == 'd' && tolower(ext[2]) == 'd' && tolower(ext[3]) == 's')
+            else if ((tolower(ext[1]) == 'p' && tolower(ext[2]) == 'v' && tolower(ext[3]) == 'r') ||
+                     (tolower(ext[1]) == 'd' && tolower(ext[2]) == 'd' && tolower(ext[3]) == 's'))
             {
-                // DDS file format (DXT/S3TC) compressed textures
-                texture = createCompressedDDS(path);
+                // PowerVR (PVRTC) or DDS (DXT/S3TC, ATC) compressed texture.
+                CompressedData* data = readCompressed(path);
+                if (data)
+                    texture = createCompressed(data);
+                SAFE_DELETE(data);
             }
             break;
         }
@@ -124,19 +107,69 @@ Texture* Texture::create(const char* path, bool generateMipmaps)
 
     if (texture)
     {
-        texture->_path = path;
-        texture->_cached = true;
+        texture->addToCache(path);
+        return texture;
+    }
 
-        // Add to texture cache.
-        __textureCache.push_back(texture);
+    GP_ERROR("Failed to load texture from file '%s'.", path);
+    return NULL;
+}
 
+Texture* Texture::create(const char* path, Image* image, bool generateMipmaps)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(image);
+
+    // The file may have been loaded by another request since it was decoded.
+    Texture* texture = findCached(path, generateMipmaps);
+    if (texture)
+    {
         return texture;
     }
 
-    GP_ERROR("Failed to load texture from file '%s'.", path);
+    texture = create(image, generateMipmaps);
+    if (texture)
+    {
+        texture->addToCache(path);
+    }
+    return texture;
+}
+
+Texture* Texture::findCached(const char* path, bool generateMipmaps)
+{
+    for (unsigned int i = 0, count = __textureCache.size(); i < count; ++i)
+    {
+        Texture* t = __textureCache[i];
+        GP_ASSERT(t);
+        if (t->_path == path)
+        {
+            // If 'generateMipmaps' is true, call Texture::generateMipamps() to force the 
+            // texture to generate its mipmap chain if it hasn't already done so.
+            if (generateMipmaps)
+            {
+                t->generateMipmaps();
+            }
+
+            // Found a match.
+            t->addRef();
+
+            return t;
+        }
+    }
     return NULL;
 }
 
+void Texture::addToCache(const char* path)
+{
+    GP_ASSERT(!_cached);
+
+    _path = path;
+    _cached = true;
+
+    // Add to texture cache.
+    __textureCache.push_back(this);
+}
+
 Texture* Texture::create(Image* image, bool generateMipmaps)
 {
     GP_ASSERT(image);
@@ -202,7 +235,7 @@ static unsigned int computePVRTCDataSize(int width, int height, int bpp)
     return widthBlocks * heightBlocks * ((blockSize  * bpp) >> 3);
 }
 
-Texture* Texture::createCompressedPVRTC(const char* path)
+Texture::CompressedData* Texture::readCompressedPVRTC(const char* path)
 {
     FILE* file = FileSystem::openFile(path, "rb");
     if (file == NULL)
@@ -268,42 +301,25 @@ Texture* Texture::createCompressedPVRTC(const char* path)
     if (fclose(file) != 0)
     {
         GP_ERROR("Failed to close PVR file '%s'.", path);
+        SAFE_DELETE_ARRAY(data);
         return NULL;
     }
 
     int bpp = (format == GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG || format == GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG) ? 2 : 4;
 
-    // Generate our texture.
-    GLuint textureId;
-    GL_ASSERT( glGenTextures(1, &textureId) );
-    GL_ASSERT( glBindTexture(GL_TEXTURE_2D, textureId) );
-    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipMapCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR) );
-
-    Texture* texture = new Texture();
-    texture->_handle = textureId;
-    texture->_width = width;
-    texture->_height = height;
-    texture->_mipmapped = mipMapCount > 1;
-    texture->_compressed = true;
-
-    // Load the data for each level.
-    GLubyte* ptr = data;
+    CompressedData* compressedData = new CompressedData();
+    compressedData->format = format;
+    compressedData->width = width;
+    compressedData->height = height;
+    compressedData->data = data;
     for (unsigned int level = 0; level < mipMapCount; ++level)
     {
-        unsigned int dataSize = computePVRTCDataSize(width, height, bpp);
-
-        // Upload data to GL.
-        GL_ASSERT( glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, dataSize, ptr) );
-
+        compressedData->levelSizes.push_back(computePVRTCDataSize(width, height, bpp));
         width = std::max(width >> 1, 1);
         height = std::max(height >> 1, 1);
-        ptr += dataSize;
     }
 
-    // Free data.
-    SAFE_DELETE_ARRAY(data);
-
-    return texture;
+    return compressedData;
 }
 
 GLubyte* Texture::readCompressedPVRTC(const char* path, FILE* file, GLsizei* width, GLsizei* height, GLenum* format, unsigned int* mipMapCount)
@@ -496,7 +512,7 @@ GLubyte* Texture::readCompressedPVRTCLegacy(const char* path, FILE* file, GLsize
     return data;
 }
 
-Texture* Texture::createCompressedDDS(const char* path)
+Texture::CompressedData* Texture::readCompressedDDS(const char* path)
 {
     GP_ASSERT(path);
 
@@ -531,16 +547,6 @@ Texture* Texture::createCompressedDDS(const char* path)
         unsigned int     dwReserved2;
     };
 
-    struct dds_mip_level
-    {
-        GLubyte* data;
-        GLsizei width;
-        GLsizei height;
-        GLsizei size;
-    };
-
-    Texture* texture = NULL;
-
     // Read DDS file.
     FILE* fp = FileSystem::openFile(path, "rb");
     if (fp == NULL)
@@ -579,45 +585,36 @@ Texture* Texture::createCompressedDDS(const char* path)
         header.dwMipMapCount = 1;
     }
 
-    // Allocate mip level structures.
-    dds_mip_level* mipLevels = new dds_mip_level[header.dwMipMapCount];
-    memset(mipLevels, 0, sizeof(dds_mip_level) * header.dwMipMapCount);
-
-    GLenum format, internalFormat;
-    bool compressed = false;
-    GLsizei width = header.dwWidth;
-    GLsizei height = header.dwHeight;
+    GLenum format;
     int bytesPerBlock;
 
     if (header.ddspf.dwFlags & 0x4/*DDPF_FOURCC*/)
     {
-        compressed = true;
-
         // Compressed.
         switch (header.ddspf.dwFourCC)
         {
         case ('D'|('X'<<8)|('T'<<16)|('1'<<24)):
-            format = internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
             bytesPerBlock = 8;
             break;
         case ('D'|('X'<<8)|('T'<<16)|('3'<<24)):
-            format = internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+            format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
             bytesPerBlock = 16;
             break;
         case ('D'|('X'<<8)|('T'<<16)|('5'<<24)):
-            format = internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
             bytesPerBlock = 16;
             break;
         case ('A'|('T'<<8)|('C'<<16)|(' '<<24)):
-            format = internalFormat = ATC_RGB_AMD;
+            format = ATC_RGB_AMD;
             bytesPerBlock = 8;
             break;
         case ('A'|('T'<<8)|('C'<<16)|('A'<<24)):
-            format = internalFormat = ATC_RGBA_EXPLICIT_ALPHA_AMD;
+            format = ATC_RGBA_EXPLICIT_ALPHA_AMD;
             bytesPerBlock = 16;
             break;
         case ('A'|('T'<<8)|('C'<<16)|('I'<<24)):
-            format = internalFormat = ATC_RGBA_INTERPOLATED_ALPHA_AMD;
+            format = ATC_RGBA_INTERPOLATED_ALPHA_AMD;
             bytesPerBlock = 16;
             break;
         default:
@@ -626,36 +623,8 @@ Texture* Texture::createCompressedDDS(const char* path)
             {
                 GP_ERROR("Failed to close file '%s'.", path);
             }
-            SAFE_DELETE_ARRAY(mipLevels);
             return NULL;
         }
-
-        for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
-        {
-            mipLevels[i].width = width;
-            mipLevels[i].height = height;
-            mipLevels[i].size =  std::max(1, (width+3) >> 2) * std::max(1, (height+3) >> 2) * bytesPerBlock;
-            mipLevels[i].data = new GLubyte[mipLevels[i].size];
-
-            if (fread(mipLevels[i].data, 1, mipLevels[i].size, fp) != (unsigned int)mipLevels[i].size)
-            {
-                GP_ERROR("Failed to load dds compressed texture bytes for texture: %s", path);
-                
-                // Cleanup mip data.
-                for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
-                    SAFE_DELETE_ARRAY(mipLevels[i].data);
-                SAFE_DELETE_ARRAY(mipLevels);
-
-                if (fclose(fp) != 0)
-                {
-                    GP_ERROR("Failed to close file '%s'.", path);
-                }
-                return texture;
-            }
-
-            width  = std::max(1, width >> 1);
-            height = std::max(1, height >> 1);
-        }
     }
     else if (header.ddspf.dwFlags == 0x40/*DDPF_RGB*/)
     {
@@ -666,7 +635,6 @@ Texture* Texture::createCompressedDDS(const char* path)
         {
             GP_ERROR("Failed to close file '%s'.", path);
         }
-        SAFE_DELETE_ARRAY(mipLevels);
         return NULL;
     }
     else if (header.ddspf.dwFlags == 0x41/*DDPF_RGB|DDPF_ALPHAPIXELS*/)
@@ -678,7 +646,6 @@ Texture* Texture::createCompressedDDS(const char* path)
         {
             GP_ERROR("Failed to close file '%s'.", path);
         }
-        SAFE_DELETE_ARRAY(mipLevels);
         return NULL;
     }
     else
@@ -689,53 +656,139 @@ Texture* Texture::createCompressedDDS(const char* path)
         {
             GP_ERROR("Failed to close file '%s'.", path);
         }
-        SAFE_DELETE_ARRAY(mipLevels);
         return NULL;
     }
-    
+
+    CompressedData* compressedData = new CompressedData();
+    compressedData->format = format;
+    compressedData->width = header.dwWidth;
+    compressedData->height = header.dwHeight;
+
+    // The mip levels follow each other in the file, so they are read in one go.
+    GLsizei width = header.dwWidth;
+    GLsizei height = header.dwHeight;
+    unsigned int dataSize = 0;
+    for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
+    {
+        GLsizei size = std::max(1, (width+3) >> 2) * std::max(1, (height+3) >> 2) * bytesPerBlock;
+        compressedData->levelSizes.push_back(size);
+        dataSize += size;
+
+        width  = std::max(1, width >> 1);
+        height = std::max(1, height >> 1);
+    }
+
+    compressedData->data = new GLubyte[dataSize];
+    if (fread(compressedData->data, 1, dataSize, fp) != dataSize)
+    {
+        GP_ERROR("Failed to load dds compressed texture bytes for texture: %s", path);
+        SAFE_DELETE(compressedData);
+        if (fclose(fp) != 0)
+        {
+            GP_ERROR("Failed to close file '%s'.", path);
+        }
+        return NULL;
+    }
+
     // Close file.
     if (fclose(fp) != 0)
     {
         GP_ERROR("Failed to close file '%s'.", path);
     }
 
+    return compressedData;
+}
+
+Texture::CompressedData* Texture::readCompressed(const char* path)
+{
+    GP_ASSERT(path);
+
+    const char* ext = strrchr(FileSystem::resolvePath(path), '.');
+    if (ext && strlen(ext) == 4)
+    {
+        if (tolower(ext[1]) == 'p' && tolower(ext[2]) == 'v' && tolower(ext[3]) == 'r')
+        {
+            // PowerVR Compressed Texture RGBA.
+            return readCompressedPVRTC(path);
+        }
+        else if (tolower(ext[1]) == 'd' && tolower(ext[2]) == 'd' && tolower(ext[3]) == 's')
+        {
+            // DDS file format (DXT/S3TC) compressed textures
+            return readCompressedDDS(path);
+        }
+    }
+
+    GP_ERROR("Failed to load texture from file '%s': not a compressed texture file.", path);
+    return NULL;
+}
+
+Texture* Texture::createCompressed(const CompressedData* data)
+{
+    GP_ASSERT(data);
+    GP_ASSERT(data->data);
+
+    unsigned int levelCount = data->levelSizes.size();
+
     // Generate GL texture.
     GLuint textureId;
     GL_ASSERT( glGenTextures(1, &textureId) );
     GL_ASSERT( glBindTexture(GL_TEXTURE_2D, textureId) );
-    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, header.dwMipMapCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR ) );
+    GL_ASSERT( glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR) );
 
     // Create gameplay texture.
-    texture = new Texture();
+    Texture* texture = new Texture();
     texture->_handle = textureId;
-    texture->_width = header.dwWidth;
-    texture->_height = header.dwHeight;
-    texture->_compressed = compressed;
-    texture->_mipmapped = header.dwMipMapCount > 1;
+    texture->_width = data->width;
+    texture->_height = data->height;
+    texture->_compressed = true;
+    texture->_mipmapped = levelCount > 1;
 
-    // Load texture data.
-    for (unsigned int i = 0; i < header.dwMipMapCount; ++i)
+    // Load the data for each level.
+    GLsizei width = data->width;
+    GLsizei height = data->height;
+    const GLubyte* ptr = data->data;
+    for (unsigned int level = 0; level < levelCount; ++level)
     {
-        if (compressed)
-        {
-            GL_ASSERT( glCompressedTexImage2D(GL_TEXTURE_2D, i, format, mipLevels[i].width, mipLevels[i].height, 0, mipLevels[i].size, mipLevels[i].data) );
-        }
-        else
-        {
-            GL_ASSERT( glTexImage2D(GL_TEXTURE_2D, i, internalFormat, mipLevels[i].width, mipLevels[i].height, 0, format, GL_UNSIGNED_INT, mipLevels[i].data) );
-        }
-        
-        // Clean up the texture data.
-        SAFE_DELETE_ARRAY(mipLevels[i].data);
+        GL_ASSERT( glCompressedTexImage2D(GL_TEXTURE_2D, level, data->format, width, height, 0, data->levelSizes[level], ptr) );
+
+        width = std::max(width >> 1, 1);
+        height = std::max(height >> 1, 1);
+        ptr += data->levelSizes[level];
     }
-    
 
-    // Clean up mip levels structure.
-    SAFE_DELETE_ARRAY(mipLevels);
+    return texture;
+}
+
+Texture* Texture::create(const char* path, const CompressedData* data, bool generateMipmaps)
+{
+    GP_ASSERT(path);
+    GP_ASSERT(data);
+
+    // The file may have been loaded by another request since it was read.
+    Texture* texture = findCached(path, generateMipmaps);
+    if (texture)
+    {
+        return texture;
+    }
 
+    texture = createCompressed(data);
+    if (texture)
+    {
+        texture->addToCache(path);
+    }
     return texture;
 }
 
+Texture::CompressedData::CompressedData()
+    : format(0), width(0), height(0), data(NULL)
+{
+}
+
+Texture::CompressedData::~CompressedData()
+{
+    SAFE_DELETE_ARRAY(data);
+}
+
 Texture::Format Texture::getFormat() const
 {
     return _format;
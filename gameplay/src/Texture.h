@@ -14,6 +14,7 @@ class Image;
 class Texture : public Ref
 {
     friend class Sampler;
+    friend class AssetLoader;
 
 public:
 
@@ -225,6 +226,21 @@ public:
 
 private:
 
+    /**
+     * The mip levels of a compressed texture, read from its file but not uploaded yet.
+     */
+    struct CompressedData
+    {
+        CompressedData();
+        ~CompressedData();
+
+        GLenum format;
+        GLsizei width;
+        GLsizei height;
+        std::vector<GLsizei> levelSizes;  // The size of each mip level, in bytes.
+        GLubyte* data;                    // The mip levels, one after the other.
+    };
+
     /**
      * Constructor.
      */
@@ -245,9 +261,55 @@ private:
      */
     Texture& operator=(const Texture&);
 
-    static Texture* createCompressedPVRTC(const char* path);
+    /**
+     * Creates a texture for a file from its already decoded image, or returns the
+     * cached texture for the file.
+     *
+     * @param path The path of the image file.
+     * @param image The decoded image.
+     * @param generateMipmaps true to auto-generate a full mipmap chain, false otherwise.
+     *
+     * @return The texture for the file.
+     */
+    static Texture* create(const char* path, Image* image, bool generateMipmaps);
+
+    /**
+     * Returns the cached texture for the file, with a reference added, or NULL if there is none.
+     */
+    static Texture* findCached(const char* path, bool generateMipmaps);
+
+    /**
+     * Adds this texture to the texture cache under the given path.
+     */
+    void addToCache(const char* path);
+
+    /**
+     * Creates a texture for a file from its already read compressed data, or returns the
+     * cached texture for the file.
+     *
+     * @param path The path of the compressed texture file.
+     * @param data The compressed data read from the file.
+     * @param generateMipmaps true to auto-generate a full mipmap chain, false otherwise.
+     *
+     * @return The texture for the file.
+     */
+    static Texture* create(const char* path, const CompressedData* data, bool generateMipmaps);
+
+    /**
+     * Reads a PVR or DDS compressed texture file. This does not touch OpenGL, so it may run on any thread.
+     *
+     * @return The compressed data, which the caller must delete, or NULL if the file could not be read.
+     */
+    static CompressedData* readCompressed(const char* path);
+
+    /**
+     * Uploads compressed data to a new texture.
+     */
+    static Texture* createCompressed(const CompressedData* data);
+
+    static CompressedData* readCompressedPVRTC(const char* path);
 
-    static Texture* createCompressedDDS(const char* path);
+    static CompressedData* readCompressedDDS(const char* path);
 
     static GLubyte* readCompressedPVRTC(const char* path, FILE* file, GLsizei* width, GLsizei* height, GLenum* format, unsigned int* mipMapCount);
 
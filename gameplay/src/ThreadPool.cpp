@@ -0,0 +1,341 @@
+#include "Base.h"
+#include "ThreadPool.h"
+
+#ifdef WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+// Upper bound on the number of worker threads created by default.
+#define THREAD_POOL_MAX_DEFAULT_THREADS 7
+
+namespace gameplay
+{
+
+ThreadPool::ThreadPool()
+    : _threads(NULL), _threadCount(0), _job(NULL), _cookie(NULL), _count(0), _next(0), _completed(0), _grainSize(1), _exiting(false)
+{
+#ifdef WIN32
+    InitializeCriticalSection(&_mutex);
+    InitializeConditionVariable(&_workCondition);
+    InitializeConditionVariable(&_doneCondition);
+#else
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_workCondition, NULL);
+    pthread_cond_init(&_doneCondition, NULL);
+#endif
+}
+
+ThreadPool::~ThreadPool()
+{
+    lock();
+    _exiting = true;
+    signalWork();
+    unlock();
+
+    for (unsigned int i = 0; i < _threadCount; ++i)
+    {
+#ifdef WIN32
+        WaitForSingleObject(_threads[i], INFINITE);
+        CloseHandle(_threads[i]);
+#else
+        pthread_join(_threads[i], NULL);
+#endif
+    }
+    SAFE_DELETE_ARRAY(_threads);
+
+#ifdef WIN32
+    DeleteCriticalSection(&_mutex);
+#else
+    pthread_cond_destroy(&_doneCondition);
+    pthread_cond_destroy(&_workCondition);
+    pthread_mutex_destroy(&_mutex);
+#endif
+}
+
+ThreadPool* ThreadPool::create(unsigned int threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::min(getHardwareThreadCount() - 1, (unsigned int)THREAD_POOL_MAX_DEFAULT_THREADS);
+    }
+
+    ThreadPool* pool = new ThreadPool();
+    if (threadCount > 0)
+    {
+#ifdef WIN32
+        pool->_threads = new HANDLE[threadCount];
+#else
+        pool->_threads = new pthread_t[threadCount];
+#endif
+        for (unsigned int i = 0; i < threadCount; ++i)
+        {
+#ifdef WIN32
+            HANDLE thread = (HANDLE)_beginthreadex(NULL, 0, workerMain, pool, 0, NULL);
+            if (thread == 0)
+#else
+            if (pthread_create(&pool->_threads[pool->_threadCount], NULL, workerMain, pool) != 0)
+#endif
+            {
+                GP_WARN("Failed to create thread pool worker thread (created %u of %u).", pool->_threadCount, threadCount);
+                break;
+            }
+#ifdef WIN32
+            pool->_threads[pool->_threadCount] = thread;
+#endif
+            ++pool->_threadCount;
+        }
+    }
+
+    return pool;
+}
+
+unsigned int ThreadPool::getHardwareThreadCount()
+{
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    long count = (long)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count > 1 ? (unsigned int)count : 1;
+}
+
+unsigned int ThreadPool::getThreadCount() const
+{
+    return _threadCount;
+}
+
+void ThreadPool::parallelFor(unsigned int count, Job job, void* cookie, unsigned int grainSize)
+{
+    GP_ASSERT(job);
+
+    if (grainSize == 0)
+        grainSize = 1;
+
+    // Not worth waking the workers for a single range.
+    if (_threadCount == 0 || count <= grainSize)
+    {
+        if (count > 0)
+            job(0, count, cookie);
+        return;
+    }
+
+    lock();
+    GP_ASSERT(_job == NULL);
+    _job = job;
+    _cookie = cookie;
+    _count = count;
+    _next = 0;
+    _completed = 0;
+    _grainSize = grainSize;
+    signalWork();
+
+    // The calling thread takes ranges too, then waits for those still running on workers.
+    runRanges();
+    while (_completed < _count)
+    {
+        waitForCompletion();
+    }
+
+    _job = NULL;
+    _cookie = NULL;
+    _count = 0;
+    _next = 0;
+    unlock();
+}
+
+void ThreadPool::runRanges()
+{
+    while (_next < _count)
+    {
+        unsigned int begin = _next;
+        unsigned int end = std::min(begin + _grainSize, _count);
+        _next = end;
+
+        Job job = _job;
+        void* cookie = _cookie;
+        unlock();
+        job(begin, end, cookie);
+        lock();
+
+        _completed += end - begin;
+        if (_completed == _count)
+            signalCompletion();
+    }
+}
+
+void ThreadPool::run(Task task, void* cookie)
+{
+    GP_ASSERT(task);
+
+    if (_threadCount == 0)
+    {
+        task(cookie);
+        return;
+    }
+
+    TaskEntry entry;
+    entry.task = task;
+    entry.cookie = cookie;
+
+    lock();
+    _tasks.push_back(entry);
+    signalWork();
+    unlock();
+}
+
+bool ThreadPool::hasTask(void* cookie)
+{
+    lock();
+    bool found = findTask(cookie);
+    unlock();
+    return found;
+}
+
+void ThreadPool::wait(void* cookie)
+{
+    lock();
+    while (findTask(cookie))
+    {
+        waitForCompletion();
+    }
+    unlock();
+}
+
+bool ThreadPool::cancel(void* cookie)
+{
+    bool cancelled = false;
+    lock();
+    std::list<TaskEntry>::iterator itr = _tasks.begin();
+    while (itr != _tasks.end())
+    {
+        if (itr->cookie == cookie)
+        {
+            itr = _tasks.erase(itr);
+            cancelled = true;
+        }
+        else
+        {
+            ++itr;
+        }
+    }
+    unlock();
+    return cancelled;
+}
+
+void ThreadPool::runTask()
+{
+    GP_ASSERT(!_tasks.empty());
+
+    TaskEntry entry = _tasks.front();
+    _tasks.pop_front();
+    _runningTasks.push_back(entry.cookie);
+
+    unlock();
+    entry.task(entry.cookie);
+    lock();
+
+    _runningTasks.erase(std::find(_runningTasks.begin(), _runningTasks.end(), entry.cookie));
+    signalCompletion();
+}
+
+bool ThreadPool::findTask(void* cookie) const
+{
+    if (std::find(_runningTasks.begin(), _runningTasks.end(), cookie) != _runningTasks.end())
+        return true;
+
+    for (std::list<TaskEntry>::const_iterator itr = _tasks.begin(); itr != _tasks.end(); ++itr)
+    {
+        if (itr->cookie == cookie)
+            return true;
+    }
+    return false;
+}
+
+#ifdef WIN32
+unsigned int __stdcall ThreadPool::workerMain(void* pool)
+#else
+void* ThreadPool::workerMain(void* pool)
+#endif
+{
+    ThreadPool* p = static_cast<ThreadPool*>(pool);
+
+    p->lock();
+    while (true)
+    {
+        while (!p->_exiting && p->_next >= p->_count && p->_tasks.empty())
+        {
+            p->waitForWork();
+        }
+        if (p->_exiting)
+            break;
+
+        // Ranges of a parallelFor() come first, as the calling thread is waiting for them.
+        if (p->_next < p->_count)
+            p->runRanges();
+        else
+            p->runTask();
+    }
+    p->unlock();
+
+    return 0;
+}
+
+void ThreadPool::lock()
+{
+#ifdef WIN32
+    EnterCriticalSection(&_mutex);
+#else
+    pthread_mutex_lock(&_mutex);
+#endif
+}
+
+void ThreadPool::unlock()
+{
+#ifdef WIN32
+    LeaveCriticalSection(&_mutex);
+#else
+    pthread_mutex_unlock(&_mutex);
+#endif
+}
+
+void ThreadPool::waitForWork()
+{
+#ifdef WIN32
+    SleepConditionVariableCS(&_workCondition, &_mutex, INFINITE);
+#else
+    pthread_cond_wait(&_workCondition, &_mutex);
+#endif
+}
+
+void ThreadPool::waitForCompletion()
+{
+#ifdef WIN32
+    SleepConditionVariableCS(&_doneCondition, &_mutex, INFINITE);
+#else
+    pthread_cond_wait(&_doneCondition, &_mutex);
+#endif
+}
+
+void ThreadPool::signalWork()
+{
+#ifdef WIN32
+    WakeAllConditionVariable(&_workCondition);
+#else
+    pthread_cond_broadcast(&_workCondition);
+#endif
+}
+
+void ThreadPool::signalCompletion()
+{
+#ifdef WIN32
+    WakeAllConditionVariable(&_doneCondition);
+#else
+    pthread_cond_broadcast(&_doneCondition);
+#endif
+}
+
+}
@@ -0,0 +1,218 @@
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace gameplay
+{
+
+/**
+ * Defines a fixed set of worker threads that split index ranges between them.
+ *
+ * The pool is used by engine systems to spread independent per-frame work (such as
+ * sampling animation channels) over the available cores. Work is submitted with
+ * parallelFor(), which blocks until every index has been processed; the calling
+ * thread processes ranges too, so a pool with no worker threads simply runs the
+ * work inline.
+ *
+ * parallelFor() must not be called concurrently from several threads, nor from
+ * within a job running on the pool.
+ *
+ * The pool also runs background tasks, queued with run(), such as the file I/O and
+ * decoding of the AssetLoader. Workers only start a task when no range of a
+ * parallelFor() is left to take. A worker that is busy with a task does not help
+ * with a parallelFor() until the task returns, so tasks should not be tiny, and they
+ * must not call parallelFor() themselves. Tasks are queued, waited for and cancelled
+ * from the main thread.
+ */
+class ThreadPool
+{
+public:
+
+    /**
+     * The function type executed for each range of indices.
+     *
+     * @param begin The first index of the range.
+     * @param end One past the last index of the range.
+     * @param cookie The user data passed to parallelFor().
+     */
+    typedef void (*Job)(unsigned int begin, unsigned int end, void* cookie);
+
+    /**
+     * The function type of a background task.
+     *
+     * @param cookie The user data passed to run().
+     */
+    typedef void (*Task)(void* cookie);
+
+    /**
+     * Creates a new thread pool.
+     *
+     * @param threadCount The number of worker threads to start. If zero, one less
+     *      than the number of hardware threads is used (the caller makes up the last one).
+     *
+     * @return A new thread pool.
+     */
+    static ThreadPool* create(unsigned int threadCount = 0);
+
+    /**
+     * Destructor. Stops and joins the worker threads. Tasks that have not started are discarded.
+     */
+    ~ThreadPool();
+
+    /**
+     * Returns the number of hardware threads available to the process.
+     *
+     * @return The number of hardware threads (at least 1).
+     */
+    static unsigned int getHardwareThreadCount();
+
+    /**
+     * Returns the number of worker threads in the pool, not counting the calling thread.
+     *
+     * @return The number of worker threads.
+     */
+    unsigned int getThreadCount() const;
+
+    /**
+     * Runs the job over the indices [0, count), split into ranges of at most grainSize
+     * indices, and returns once all ranges have completed.
+     *
+     * Ranges may run in any order and on any thread, so the job must only write to
+     * data owned by the indices of its range.
+     *
+     * @param count The number of indices to process.
+     * @param job The function to run for each range.
+     * @param cookie The user data passed to the job.
+     * @param grainSize The maximum number of indices per range.
+     */
+    void parallelFor(unsigned int count, Job job, void* cookie, unsigned int grainSize = 1);
+
+    /**
+     * Queues a task to run in the background on a worker thread and returns without waiting.
+     *
+     * Tasks start in the order they are queued. If the pool has no worker threads, the
+     * task runs on the calling thread before this returns.
+     *
+     * @param task The function to run.
+     * @param cookie The user data passed to the task, which also identifies the task
+     *      for hasTask(), wait() and cancel().
+     */
+    void run(Task task, void* cookie);
+
+    /**
+     * Determines whether a task with the given cookie is queued or running.
+     *
+     * Once this returns false, everything the task wrote is visible to the caller.
+     *
+     * @param cookie The cookie passed to run().
+     *
+     * @return true if a task with the cookie has not finished yet.
+     */
+    bool hasTask(void* cookie);
+
+    /**
+     * Blocks until no task with the given cookie is queued or running.
+     *
+     * @param cookie The cookie passed to run().
+     */
+    void wait(void* cookie);
+
+    /**
+     * Removes the queued tasks with the given cookie that have not started yet.
+     *
+     * Tasks that are already running are not affected.
+     *
+     * @param cookie The cookie passed to run().
+     *
+     * @return true if any task was removed.
+     */
+    bool cancel(void* cookie);
+
+private:
+
+    /**
+     * A background task queued with run().
+     */
+    struct TaskEntry
+    {
+        Task task;
+        void* cookie;
+    };
+
+    /**
+     * Constructor.
+     */
+    ThreadPool();
+
+    /**
+     * Hidden copy constructor.
+     */
+    ThreadPool(const ThreadPool& copy);
+
+    /**
+     * Hidden copy assignment operator.
+     */
+    ThreadPool& operator=(const ThreadPool&);
+
+    /**
+     * Runs ranges of the current job until none remain. Must be called with the lock held.
+     */
+    void runRanges();
+
+    /**
+     * Runs the task at the front of the queue. Must be called with the lock held.
+     */
+    void runTask();
+
+    /**
+     * Determines whether a task with the given cookie is queued or running. Must be called with the lock held.
+     */
+    bool findTask(void* cookie) const;
+
+    /**
+     * The entry point of the worker threads.
+     */
+#ifdef WIN32
+    static unsigned int __stdcall workerMain(void* pool);
+#else
+    static void* workerMain(void* pool);
+#endif
+
+    void lock();
+    void unlock();
+    void waitForWork();
+    void waitForCompletion();
+    void signalWork();
+    void signalCompletion();
+
+#ifdef WIN32
+    CRITICAL_SECTION _mutex;
+    CONDITION_VARIABLE _workCondition;
+    CONDITION_VARIABLE _doneCondition;
+    HANDLE* _threads;
+#else
+    pthread_mutex_t _mutex;
+    pthread_cond_t _workCondition;
+    pthread_cond_t _doneCondition;
+    pthread_t* _threads;
+#endif
+    unsigned int _threadCount;
+    Job _job;
+    void* _cookie;
+    unsigned int _count;
+    unsigned int _next;
+    unsigned int _completed;
+    unsigned int _grainSize;
+    std::list<TaskEntry> _tasks;
+    std::vector<void*> _runningTasks;
+    bool _exiting;
+};
+
+}
+
+#endif
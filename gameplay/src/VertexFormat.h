@@ -36,13 +36,26 @@ public:
         TEXCOORD7 = 15
     };
 
+    /**
+     * Defines the types of the values of vertex elements.
+     */
+    enum Type
+    {
+        FLOAT = GL_FLOAT,
+        BYTE = GL_BYTE,
+        UNSIGNED_BYTE = GL_UNSIGNED_BYTE,
+        SHORT = GL_SHORT,
+        UNSIGNED_SHORT = GL_UNSIGNED_SHORT
+    };
+
     /**
      * Defines a single element within a vertex format.
      *
-     * All vertex elements are assumed to be of type float, but can
-     * have a varying number of float values (1-4), which is represented
-     * by the size attribute. Additionally, vertex elements are assumed
-     * to be tightly packed.
+     * Vertex elements have a varying number of values (1-4), which is
+     * represented by the size attribute, of type float by default.
+     * Elements of smaller (quantized) types are padded to a multiple of
+     * four bytes, so that all elements stay aligned. Vertex elements are
+     * otherwise assumed to be tightly packed.
      */
     class Element
     {
@@ -57,6 +70,17 @@ public:
          */
         unsigned int size;
 
+        /**
+         * The type of the values in the vertex element.
+         */
+        Type type;
+
+        /**
+         * Whether integer values are normalized to [0, 1] (unsigned types) or
+         * [-1, 1] (signed types) when read by shaders.
+         */
+        bool normalized;
+
         /**
          * Constructor.
          */
@@ -66,9 +90,18 @@ public:
          * Constructor.
          *
          * @param usage The vertex element usage semantic.
-         * @param size The number of float values in the vertex element.
+         * @param size The number of values in the vertex element.
+         * @param type The type of the values in the vertex element.
+         * @param normalized Whether integer values are normalized when read by shaders.
+         */
+        Element(Usage usage, unsigned int size, Type type = FLOAT, bool normalized = false);
+
+        /**
+         * Returns the size of the vertex element in bytes, including padding.
+         *
+         * @return The size of the vertex element in bytes.
          */
-        Element(Usage usage, unsigned int size);
+        unsigned int getByteSize() const;
 
         /**
          * Compares two vertex elements for equality.
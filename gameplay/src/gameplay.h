@@ -7,6 +7,7 @@
 #include "Mouse.h"
 #include "FileSystem.h"
 #include "Bundle.h"
+#include "AssetLoader.h"
 #include "Gamepad.h"
 
 // Math
@@ -22,6 +23,7 @@
 #include "Frustum.h"
 #include "BoundingSphere.h"
 #include "BoundingBox.h"
+#include "BoundingVolumeTree.h"
 #include "Curve.h"
 
 // Graphics
@@ -34,6 +36,7 @@
 #include "VertexFormat.h"
 #include "VertexAttributeBinding.h"
 #include "Model.h"
+#include "RenderQueue.h"
 #include "Camera.h"
 #include "Light.h"
 #include "Scene.h"
@@ -41,7 +44,9 @@
 #include "Joint.h"
 #include "Font.h"
 #include "SpriteBatch.h"
+#include "InstanceBatch.h"
 #include "ParticleEmitter.h"
+#include "ParticleSystem.h"
 #include "FrameBuffer.h"
 #include "RenderTarget.h"
 #include "DepthStencilTarget.h"